@@ -0,0 +1,123 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Thread safe buffer of colliding states, recorded while filtering and published to rviz afterwards
+*/
+
+#ifndef MOVEIT_GRASPS__COLLISION_STATE_BUFFER_
+#define MOVEIT_GRASPS__COLLISION_STATE_BUFFER_
+
+// Rviz
+#include <moveit_visual_tools/moveit_visual_tools.h>
+
+// MoveIt
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_state/robot_state.h>
+
+// C++
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace moveit_grasps
+{
+/**
+ * \brief Collects the states rejected by the collision checks of the IK threads. Recording only copies the state, so
+ *        the threads never wait for rviz and filtering keeps all of its threads while debugging
+ */
+class CollisionStateBuffer
+{
+public:
+  /**
+   * \brief Constructor
+   * \param max_states - number of states to keep, later collisions are only counted
+   */
+  CollisionStateBuffer(std::size_t max_states = 100);
+
+  /**
+   * \brief Store a colliding state. Thread safe
+   * \param planning_scene - scene the state collided in, kept alive until the state was published
+   * \param robot_state - the colliding state
+   * \param group_name - group that was checked
+   */
+  void record(const planning_scene::PlanningScene* planning_scene, const moveit::core::RobotState& robot_state,
+              const std::string& group_name);
+
+  /**
+   * \brief Show the stored states and their contact points one after another, then clear the buffer
+   * \param visual_tools - used to publish the states
+   * \param verbose_speed - time in seconds each state is shown
+   * \return number of published states
+   */
+  std::size_t publish(const moveit_visual_tools::MoveItVisualToolsPtr& visual_tools, double verbose_speed);
+
+  /**
+   * \brief Remove all stored states
+   */
+  void clear();
+
+  /**
+   * \brief Number of stored states
+   */
+  std::size_t size() const;
+
+  /**
+   * \brief Number of recorded collisions since the last clear, including the ones that did not fit
+   */
+  std::size_t getNumCollisions() const;
+
+  void setMaxStates(std::size_t max_states);
+
+  std::size_t getMaxStates() const;
+
+private:
+  struct Entry
+  {
+    planning_scene::PlanningSceneConstPtr planning_scene_;
+    moveit::core::RobotState robot_state_;
+    std::string group_name_;
+  };
+
+  std::vector<Entry> entries_;
+  std::size_t max_states_;
+  std::size_t num_collisions_ = 0;
+  mutable std::mutex mutex_;
+};
+
+typedef std::shared_ptr<CollisionStateBuffer> CollisionStateBufferPtr;
+
+}  // namespace moveit_grasps
+
+#endif
@@ -0,0 +1,130 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Streams the grasps of known objects from a precomputed grasp database instead of generating them
+*/
+
+#ifndef MOVEIT_GRASPS__DATABASE_GRASP_GENERATOR_H_
+#define MOVEIT_GRASPS__DATABASE_GRASP_GENERATOR_H_
+
+// moveit_grasps
+#include <moveit_grasps/grasp_database.h>
+#include <moveit_grasps/grasp_generator.h>
+
+namespace moveit_grasps
+{
+/**
+ * \brief Grasp generator for objects whose grasps were generated offline and stored with GraspDatabaseBuilder.
+ *        The grasps of the object are transformed to the cuboid pose and passed on by descending score, without
+ *        generating, scoring or checking the finger width again. The scores are the ones computed offline, so they do
+ *        not take the ideal grasp pose into account for the current object pose
+ */
+class DatabaseGraspGenerator : public GraspGenerator
+{
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * \brief Constructor
+   * \param grasp_database - loaded database, may be shared by several generators
+   */
+  DatabaseGraspGenerator(rclcpp::Node::SharedPtr node, const moveit_visual_tools::MoveItVisualToolsPtr& visual_tools,
+                         const GraspDatabaseConstPtr& grasp_database, bool verbose = false);
+
+  /**
+   * \brief Get the grasps of the object from the database, see streamGrasps()
+   */
+  bool generateGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width, double height,
+                      const GraspDataPtr& grasp_data, std::vector<GraspCandidatePtr>& grasp_candidates) override;
+
+  /**
+   * \brief Pass the grasps of the object in the database to a callback in chunks. The object is the one set with
+   *        setObjectName(), or else the object closest to the dimensions
+   * \return false if the object is not in the database or was stored for a different end effector
+   */
+  bool streamGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width, double height,
+                    const GraspDataPtr& grasp_data, const GraspCandidatesCallback& callback,
+                    std::size_t chunk_size = 100) override;
+
+  /**
+   * \brief Set the name of the object the next grasps are requested for, e.g. its SKU. Empty to find the object by
+   *        its dimensions
+   */
+  void setObjectName(const std::string& object_name)
+  {
+    object_name_ = object_name;
+  }
+
+  const std::string& getObjectName() const
+  {
+    return object_name_;
+  }
+
+  /**
+   * \brief Set the max difference of each dimension in meters when the object is found by its dimensions
+   */
+  void setDimensionTolerance(double dimension_tolerance)
+  {
+    dimension_tolerance_ = dimension_tolerance;
+  }
+
+  double getDimensionTolerance() const
+  {
+    return dimension_tolerance_;
+  }
+
+  const GraspDatabaseConstPtr& getGraspDatabase() const
+  {
+    return grasp_database_;
+  }
+
+protected:
+  /**
+   * \brief Find the database entry of the requested object for an end effector
+   * \return the entry or nullptr
+   */
+  const GraspDatabaseEntry* findObject(double depth, double width, double height,
+                                       const GraspDataPtr& grasp_data) const;
+
+  GraspDatabaseConstPtr grasp_database_;
+  std::string object_name_;
+  double dimension_tolerance_ = 0.005;
+};  // end of class
+
+typedef std::shared_ptr<DatabaseGraspGenerator> DatabaseGraspGeneratorPtr;
+typedef std::shared_ptr<const DatabaseGraspGenerator> DatabaseGraspGeneratorConstPtr;
+
+}  // namespace moveit_grasps
+
+#endif
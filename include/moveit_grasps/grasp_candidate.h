@@ -59,18 +59,47 @@ enum GraspTrajectorySegments
   RETREAT = 2
 };
 
+/**
+ * \brief Cartesian paths of a grasp stored as the arm joint positions of their waypoints. All other joints come from
+ *        one reference state that can be shared between candidates, so a waypoint costs only the arm variables
+ *        instead of a full RobotState with its transform caches
+ */
+struct CompactGraspTrajectories
+{
+  // The state the paths were planned from
+  moveit::core::RobotStateConstPtr reference_state_;
+  // The group of the stored positions
+  const moveit::core::JointModelGroup* arm_jmg_ = nullptr;
+  // One matrix per segment with the arm variables of a waypoint in every column
+  std::vector<Eigen::MatrixXd> segment_positions_;
+
+  bool empty() const
+  {
+    return segment_positions_.empty();
+  }
+
+  void clear()
+  {
+    reference_state_.reset();
+    segment_positions_.clear();
+  }
+};
+
 struct GraspFilterCode
 {
   enum
   {
     NOT_FILTERED = 0,
-    GRASP_FILTERED_BY_IK,             // Ik solution at grasp failed
-    GRASP_FILTERED_BY_CUTTING_PLANE,  // grasp pose is in an unreachable part of the environment (eg: behind a wall)
-    GRASP_FILTERED_BY_ORIENTATION,    // grasp pose is not desireable
-    GRASP_FILTERED_BY_IK_CLOSED,      // ik solution was fine with grasp opened, but failed with grasp closed
-    PREGRASP_FILTERED_BY_IK,          // Ik solution before approach failed
-    GRASP_INVALID,                    // An error occured while processing the grasp
-    LAST                              // Used to track last value in the base class when inheriting
+    GRASP_FILTERED_BY_IK,              // Ik solution at grasp failed
+    GRASP_FILTERED_BY_REACHABILITY,    // grasp pose is outside of the arm's reachability map, IK was not attempted
+    GRASP_FILTERED_BY_CUTTING_PLANE,   // grasp pose is in an unreachable part of the environment (eg: behind a wall)
+    GRASP_FILTERED_BY_ORIENTATION,     // grasp pose is not desireable
+    GRASP_FILTERED_BY_IK_CLOSED,       // ik solution was fine with grasp opened, but failed with grasp closed
+    PREGRASP_FILTERED_BY_IK,           // Ik solution before approach failed
+    GRASP_FILTERED_BY_EARLY_EXIT,      // not processed because enough valid grasps were already found
+    GRASP_INVALID,                     // An error occured while processing the grasp
+    GRASP_FILTERED_BY_OPEN_COLLISION,  // end effector in collision at the grasp with the pre grasp opening
+    LAST                               // Used to track last value in the base class when inheriting
   };
 };
 
@@ -97,6 +126,21 @@ public:
 
   virtual bool isValid();
 
+  /**
+   * \brief Move segmented_cartesian_traj_ into compact_cartesian_traj_, keeping only the arm positions of every
+   *        waypoint
+   * \param reference_state - state for all joints but the arm when the trajectories are expanded again
+   */
+  void compactCartesianTrajectories(const moveit::core::RobotStateConstPtr& reference_state);
+
+  /**
+   * \brief Rebuild segmented_cartesian_traj_ from compact_cartesian_traj_. The end effector is at the pre grasp
+   *        posture during the approach and at the grasp posture afterwards. The grasp object is not attached to the
+   *        lift and retreat states
+   * \return true if segmented_cartesian_traj_ is set
+   */
+  bool expandCartesianTrajectories();
+
   moveit_msgs::msg::Grasp grasp_;
 
   /*# Contents of moveit_msgs::Grasp for reference
@@ -171,6 +215,9 @@ public:
 
   // Store pregrasp, grasp, lifted, and retreat trajectories
   GraspTrajectories segmented_cartesian_traj_;
+
+  // The same trajectories with only the arm positions, if the planner was set to compact them
+  CompactGraspTrajectories compact_cartesian_traj_;
 };  // class
 
 typedef std::shared_ptr<GraspCandidate> GraspCandidatePtr;
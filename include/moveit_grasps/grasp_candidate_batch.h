@@ -0,0 +1,241 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+/* Desc:   Compact, structure of arrays storage for large numbers of generated grasp candidates
+*/
+
+#ifndef MOVEIT_GRASPS__GRASP_CANDIDATE_BATCH_
+#define MOVEIT_GRASPS__GRASP_CANDIDATE_BATCH_
+
+// ROS
+#include <rclcpp/rclcpp.hpp>
+#include <trajectory_msgs/msg/joint_trajectory.hpp>
+
+// Grasping
+#include <moveit_grasps/grasp_candidate.h>
+
+// C++
+#include <cstdint>
+#include <vector>
+
+namespace moveit_grasps
+{
+/**
+ * \brief Stores the grasps generated for one object and end effector in contiguous arrays. Only the grasp pose,
+ *        score, filter code and ik solutions are stored per grasp. The pre grasp postures are stored once in a table
+ *        and referenced by index, the grasp posture and the approach / retreat settings come from the grasp data.
+ *        Full moveit_msgs::msg::Grasp messages and GraspCandidates are only built on demand
+ */
+class GraspCandidateBatch
+{
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * \brief Constructor
+   * \param grasp_data - end effector shared by all grasps of the batch
+   * \param cuboid_pose - pose of the object to grasp
+   */
+  GraspCandidateBatch(const GraspDataPtr& grasp_data, const Eigen::Isometry3d& cuboid_pose);
+
+  /**
+   * \brief Remove all grasps and pre grasp postures
+   */
+  void clear();
+
+  void reserve(std::size_t num_grasps);
+
+  /**
+   * \brief Resize the batch, new grasps are unfiltered and must be filled with setGrasp()
+   */
+  void resize(std::size_t num_grasps);
+
+  std::size_t size() const
+  {
+    return grasp_poses_.size();
+  }
+
+  bool empty() const
+  {
+    return grasp_poses_.empty();
+  }
+
+  /**
+   * \brief Add a pre grasp posture to the posture table
+   * \param percent_open - finger opening the posture was created for, see TwoFingerGraspData::setGraspWidth()
+   * \return the index to pass to addGrasp()
+   */
+  std::size_t addPreGraspPosture(const trajectory_msgs::msg::JointTrajectory& pre_grasp_posture,
+                                 double percent_open = 1.0);
+
+  /**
+   * \brief Add a grasp
+   * \param grasp_pose_eef_mount - pose of the eef mount in the base link frame of the grasp data
+   * \param score - grasp quality, higher is better
+   * \param pre_grasp_posture_id - index returned by addPreGraspPosture()
+   * \param id - numeric part of the grasp name
+   */
+  void addGrasp(const Eigen::Isometry3d& grasp_pose_eef_mount, double score, std::size_t pre_grasp_posture_id,
+                std::size_t id);
+
+  /**
+   * \brief Overwrite the grasp at an index, e.g. for filling slots created by resize() from several threads
+   */
+  void setGrasp(std::size_t index, const Eigen::Isometry3d& grasp_pose_eef_mount, double score,
+                std::size_t pre_grasp_posture_id, std::size_t id);
+
+  /**
+   * \brief Append all grasps of another batch for the same grasp data and object
+   */
+  void append(const GraspCandidateBatch& other);
+
+  /**
+   * \brief Reorder all grasps by descending score
+   */
+  void sortByScore();
+
+  /**
+   * \brief Set the ik solution of a grasp, all solutions must have the same size
+   */
+  void setGraspIKSolution(std::size_t index, const std::vector<double>& solution);
+  bool getGraspIKSolution(std::size_t index, std::vector<double>& solution) const;
+  void setPreGraspIKSolution(std::size_t index, const std::vector<double>& solution);
+  bool getPreGraspIKSolution(std::size_t index, std::vector<double>& solution) const;
+
+  /**
+   * \brief Build the full grasp message of one grasp
+   * \param stamp - used for all headers of the message
+   */
+  moveit_msgs::msg::Grasp getGraspMsg(std::size_t index, const rclcpp::Time& stamp) const;
+
+  /**
+   * \brief Build a grasp candidate with the grasp message, filter code and ik solutions of one grasp
+   */
+  GraspCandidatePtr getGraspCandidate(std::size_t index, const rclcpp::Time& stamp) const;
+
+  /**
+   * \brief Append grasp candidates for the grasps of the batch
+   * \param only_valid - skip grasps that have been filtered
+   */
+  void getGraspCandidates(std::vector<GraspCandidatePtr>& grasp_candidates, const rclcpp::Time& stamp,
+                          bool only_valid = false) const;
+
+  const GraspDataPtr& getGraspData() const
+  {
+    return grasp_data_;
+  }
+
+  const Eigen::Isometry3d& getCuboidPose() const
+  {
+    return cuboid_pose_;
+  }
+
+  const EigenSTL::vector_Isometry3d& getGraspPoses() const
+  {
+    return grasp_poses_;
+  }
+
+  const std::vector<double>& getScores() const
+  {
+    return scores_;
+  }
+
+  std::vector<double>& getScores()
+  {
+    return scores_;
+  }
+
+  const std::vector<std::uint16_t>& getPreGraspPostureIds() const
+  {
+    return pre_grasp_posture_ids_;
+  }
+
+  const trajectory_msgs::msg::JointTrajectory& getPreGraspPosture(std::size_t index) const
+  {
+    return pre_grasp_postures_[pre_grasp_posture_ids_[index]];
+  }
+
+  /**
+   * \brief Get the finger opening of the pre grasp posture of a grasp
+   */
+  double getPreGraspPercentOpen(std::size_t index) const
+  {
+    return pre_grasp_percent_opens_[pre_grasp_posture_ids_[index]];
+  }
+
+  std::size_t getId(std::size_t index) const
+  {
+    return ids_[index];
+  }
+
+  int getFilterCode(std::size_t index) const
+  {
+    return filter_codes_[index];
+  }
+
+  void setFilterCode(std::size_t index, int filter_code)
+  {
+    filter_codes_[index] = filter_code;
+  }
+
+protected:
+  void setIKSolution(std::vector<double>& solutions, std::size_t index, const std::vector<double>& solution);
+  bool getIKSolution(const std::vector<double>& solutions, std::size_t index, std::vector<double>& solution) const;
+
+  GraspDataPtr grasp_data_;
+  Eigen::Isometry3d cuboid_pose_;
+
+  // Per grasp data
+  EigenSTL::vector_Isometry3d grasp_poses_;
+  std::vector<double> scores_;
+  std::vector<int> filter_codes_;
+  std::vector<std::uint16_t> pre_grasp_posture_ids_;
+  std::vector<std::size_t> ids_;
+
+  // IK solutions stored row by row with ik_solution_size_ values per grasp, empty until the first one is set
+  std::size_t ik_solution_size_ = 0;
+  std::vector<double> grasp_ik_solutions_;
+  std::vector<double> pregrasp_ik_solutions_;
+
+  // Shared by all grasps
+  std::vector<trajectory_msgs::msg::JointTrajectory> pre_grasp_postures_;
+  std::vector<double> pre_grasp_percent_opens_;
+};  // class
+
+typedef std::shared_ptr<GraspCandidateBatch> GraspCandidateBatchPtr;
+
+}  // namespace moveit_grasps
+
+#endif
@@ -101,6 +101,12 @@ struct GraspData
    */
   bool setRobotState(moveit::core::RobotStatePtr& robot_state, const trajectory_msgs::msg::JointTrajectory& posture);
 
+  /**
+   * \brief Compute pre_grasp_offset_ and post_grasp_retreat_offset_ from tcp_to_eef_mount_ and the approach and
+   *        retreat distances. Called by loadGraspData(), call it again after changing any of them
+   */
+  void computeApproachOffsets();
+
   /**
    * \brief Debug data to console
    */
@@ -110,6 +116,11 @@ struct GraspData
   std::string tcp_name_;
   Eigen::Isometry3d tcp_to_eef_mount_;  // Convert generic grasp pose to the parent arm's eef_mount frame of reference
 
+  // Transforms from an eef mount grasp pose to its pre grasp and retreat pose, matching the approach and retreat of
+  // the generated grasps. pre_grasp_pose = grasp_pose * pre_grasp_offset_
+  Eigen::Isometry3d pre_grasp_offset_;
+  Eigen::Isometry3d post_grasp_retreat_offset_;
+
   trajectory_msgs::msg::JointTrajectory pre_grasp_posture_;  // when the end effector is in "open" position
   trajectory_msgs::msg::JointTrajectory grasp_posture_;      // when the end effector is in "close" position
   std::string base_link_;                                    // name of global frame with z pointing up
@@ -0,0 +1,232 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Memory mapped database of grasps precomputed offline for a catalog of known objects
+*/
+
+#ifndef MOVEIT_GRASPS__GRASP_DATABASE_
+#define MOVEIT_GRASPS__GRASP_DATABASE_
+
+// ROS
+#include <rclcpp/rclcpp.hpp>
+
+// Grasping
+#include <moveit_grasps/grasp_candidate_batch.h>
+
+// C++
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace moveit_grasps
+{
+// Fixed sizes of the file layout
+static const std::size_t GRASP_DATABASE_MAX_NAME_LENGTH = 64;
+static const std::size_t GRASP_DATABASE_MAX_POSTURES = 16;
+static const std::size_t GRASP_DATABASE_MAX_POSTURE_JOINTS = 8;
+
+/**
+ * \brief One grasp as stored in the file, 72 bytes
+ */
+struct GraspDatabaseRecord
+{
+  // Pose of the eef mount in the frame of the object
+  double position_[3];
+  double orientation_[4];  // x, y, z, w
+  double score_;
+  // All openings of a grasp pose share its pose id, see GraspCandidateBatch::getId()
+  std::uint32_t pose_id_;
+  // Index into the postures of the object
+  std::uint16_t posture_index_;
+  std::uint16_t reserved_;
+};
+
+/**
+ * \brief One object of the catalog as stored in the file, followed by its grasps in the record table
+ */
+struct GraspDatabaseEntry
+{
+  char name_[GRASP_DATABASE_MAX_NAME_LENGTH];  // null terminated
+  double depth_;
+  double width_;
+  double height_;
+  std::uint64_t first_record_;
+  std::uint64_t num_records_;
+  std::uint32_t num_pose_ids_;
+  std::uint16_t num_postures_;
+  std::uint16_t num_posture_joints_;
+  // Pre grasp postures, the joint names are those of GraspData::pre_grasp_posture_
+  double posture_percent_opens_[GRASP_DATABASE_MAX_POSTURES];
+  double posture_positions_[GRASP_DATABASE_MAX_POSTURES][GRASP_DATABASE_MAX_POSTURE_JOINTS];
+};
+
+/**
+ * \brief Start of the file, followed by the entries sorted by name and the records
+ */
+struct GraspDatabaseHeader
+{
+  char magic_[4];
+  std::uint32_t version_;
+  std::uint64_t num_entries_;
+  std::uint64_t num_records_;
+  char end_effector_[GRASP_DATABASE_MAX_NAME_LENGTH];  // null terminated
+};
+
+// The file is mapped as is, so the layout must not depend on the compiler
+static_assert(sizeof(GraspDatabaseRecord) == 72, "Unexpected size of GraspDatabaseRecord");
+static_assert(sizeof(GraspDatabaseEntry) % 8 == 0, "GraspDatabaseEntry must keep the records aligned");
+static_assert(sizeof(GraspDatabaseHeader) % 8 == 0, "GraspDatabaseHeader must keep the entries aligned");
+static_assert(std::is_trivially_copyable<GraspDatabaseEntry>::value, "GraspDatabaseEntry must be trivially copyable");
+
+/**
+ * \brief Collects the grasps generated offline for a catalog of objects and writes them to a database file.
+ *        The file is written in the byte order of the machine and can only be read on machines with the same one
+ */
+class GraspDatabaseBuilder
+{
+public:
+  /**
+   * \brief Constructor
+   * \param end_effector_name - the end effector group the grasps are generated for
+   */
+  explicit GraspDatabaseBuilder(const std::string& end_effector_name);
+
+  /**
+   * \brief Add the grasps of an object, e.g. from TwoFingerGraspGenerator::generateGrasps() with a GraspCandidateBatch.
+   *        Only unfiltered grasps are stored, relative to the cuboid pose of the batch and by descending score
+   * \param name - unique name of the object, e.g. its SKU
+   * \return true on success
+   */
+  bool addObject(const std::string& name, double depth, double width, double height,
+                 const GraspCandidateBatch& grasp_candidate_batch);
+
+  /**
+   * \brief Write all added objects to a file
+   * \return true on success
+   */
+  bool saveToFile(const std::string& filename) const;
+
+  std::size_t getNumObjects() const
+  {
+    return entries_.size();
+  }
+
+private:
+  rclcpp::Logger LOGGER;
+
+  std::string end_effector_name_;
+  std::vector<GraspDatabaseEntry> entries_;
+  // The records of each entry, in the order of entries_
+  std::vector<std::vector<GraspDatabaseRecord> > records_;
+};
+
+/**
+ * \brief Read only view of a database file written by GraspDatabaseBuilder. The file is mapped into memory and used
+ *        in place, so loading takes constant time and the pages are shared by all processes using the same file
+ */
+class GraspDatabase
+{
+public:
+  GraspDatabase();
+  ~GraspDatabase();
+
+  GraspDatabase(const GraspDatabase&) = delete;
+  GraspDatabase& operator=(const GraspDatabase&) = delete;
+
+  /**
+   * \brief Map a database file, replacing any previously loaded one
+   * \return true on success
+   */
+  bool loadFromFile(const std::string& filename);
+
+  /**
+   * \brief Unmap the file
+   */
+  void close();
+
+  bool isLoaded() const
+  {
+    return header_ != nullptr;
+  }
+
+  /**
+   * \brief Find an object by name
+   * \return the entry or nullptr if the object is not in the database
+   */
+  const GraspDatabaseEntry* findObject(const std::string& name) const;
+
+  /**
+   * \brief Find the object closest to a size, for callers that only know the dimensions of the cuboid
+   * \param tolerance - max difference of each dimension in meters
+   * \return the entry or nullptr if no object is within the tolerance
+   */
+  const GraspDatabaseEntry* findObject(double depth, double width, double height, double tolerance) const;
+
+  /**
+   * \brief Get the first grasp of an entry, its grasps are entry->num_records_ consecutive records
+   */
+  const GraspDatabaseRecord* getRecords(const GraspDatabaseEntry* entry) const
+  {
+    return records_ + entry->first_record_;
+  }
+
+  std::size_t getNumObjects() const
+  {
+    return header_ ? header_->num_entries_ : 0;
+  }
+
+  std::string getEndEffectorName() const
+  {
+    return header_ ? std::string(header_->end_effector_) : std::string();
+  }
+
+private:
+  rclcpp::Logger LOGGER;
+
+  // The mapping and the tables inside of it
+  void* data_ = nullptr;
+  std::size_t size_ = 0;
+  const GraspDatabaseHeader* header_ = nullptr;
+  const GraspDatabaseEntry* entries_ = nullptr;
+  const GraspDatabaseRecord* records_ = nullptr;
+};
+
+typedef std::shared_ptr<GraspDatabase> GraspDatabasePtr;
+typedef std::shared_ptr<const GraspDatabase> GraspDatabaseConstPtr;
+
+}  // namespace moveit_grasps
+
+#endif
@@ -46,8 +46,14 @@
 #include <geometry_msgs/msg/pose_stamped.h>
 
 // Grasping
+#include <moveit_grasps/collision_state_buffer.h>
 #include <moveit_grasps/grasp_generator.h>
 #include <moveit_grasps/grasp_candidate.h>
+#include <moveit_grasps/grasp_candidate_batch.h>
+#include <moveit_grasps/grasp_stats.h>
+#include <moveit_grasps/ik_seed_cache.h>
+#include <moveit_grasps/ik_worker_pool.h>
+#include <moveit_grasps/reachability_map.h>
 
 // Rviz
 #include <moveit_visual_tools/moveit_visual_tools.h>
@@ -102,6 +108,20 @@ struct DesiredGraspOrientation
 };
 typedef std::shared_ptr<DesiredGraspOrientation> DesiredGraspOrientationPtr;
 
+/**
+ * \brief Collision check handed to the IK solver. The callback is built once per thread and reads the scene and end
+ *        effector from here, so only those are updated for each candidate and the solver always gets the same callback
+ */
+struct StateValidityChecker
+{
+  // Scene of the candidate being solved
+  const planning_scene::PlanningScene* planning_scene_ = nullptr;
+  // End effector that is checked against the world first, null unless staged collision checking is enabled
+  const moveit::core::JointModelGroup* ee_jmg_ = nullptr;
+  // References this checker, empty until the first candidate of the thread
+  moveit::core::GroupStateValidityCallbackFn callback_;
+};
+
 /**
  * \brief Struct for passing parameters to threads, for cleaner code
  */
@@ -111,13 +131,14 @@ struct IkThreadStruct
                  const planning_scene::PlanningScenePtr& planning_scene, Eigen::Isometry3d& link_transform,
                  std::size_t grasp_id, kinematics::KinematicsBaseConstPtr kin_solver,
                  const moveit::core::RobotStatePtr& robot_state, double timeout, bool filter_pregrasp,
-                 bool visual_debug, std::size_t thread_id, const std::string& grasp_target_object_id)
+                 bool visual_debug, std::size_t thread_id, const std::string& grasp_target_object_id,
+                 bool clone_planning_scene = true)
     : grasp_candidates_(grasp_candidates)
-    , planning_scene_(planning_scene::PlanningScene::clone(planning_scene))
+    , planning_scene_(clone_planning_scene ? planning_scene::PlanningScene::clone(planning_scene) : planning_scene)
     , link_transform_(link_transform)
     , grasp_id(grasp_id)
     , kin_solver_(kin_solver)
-    , robot_state_(std::make_shared<moveit::core::RobotState>(*robot_state))
+    , robot_state_(robot_state)
     , timeout_(timeout)
     , filter_pregrasp_(filter_pregrasp)
     , visual_debug_(visual_debug)
@@ -127,10 +148,12 @@ struct IkThreadStruct
   }
 
   std::vector<GraspCandidatePtr>& grasp_candidates_;
+  // Either a private clone or a scene shared read-only by all threads, see GraspFilter::setSharePlanningScene()
   planning_scene::PlanningScenePtr planning_scene_;
   Eigen::Isometry3d link_transform_;
   std::size_t grasp_id;
   kinematics::KinematicsBaseConstPtr kin_solver_;
+  // Owned by the IkWorkerPool worker running this thread, not copied
   moveit::core::RobotStatePtr robot_state_;
   double timeout_;
   bool filter_pregrasp_;
@@ -141,12 +164,43 @@ struct IkThreadStruct
   // to the planning scene. If it hasn't then GraspFilter will not modify the planning scene allowed collision matrix
   std::string grasp_target_object_id_;
 
+  // Optional map of the arm's workspace in the ik frame, null if none is loaded
+  ReachabilityMapConstPtr reachability_map_;
+
+  // Solutions of previously solved candidates, null unless seeding from the nearest solution
+  IkSeedCachePtr ik_seed_cache_;
+
+  // The cutting planes and orientations were already applied to all candidates by filterGraspsByGeometry()
+  bool geometry_prefiltered_ = false;
+
+  // Collision check of the IK solver, reused for every candidate of this thread
+  StateValidityChecker state_validity_checker_;
+
   // Used within processing function
-  geometry_msgs::msg::PoseStamped ik_pose_;  // Set from grasp candidate
+  Eigen::Isometry3d ik_pose_;  // Set from grasp candidate
   std::vector<double> ik_seed_state_;
+  // All solutions of the last pose, see GraspFilter::setMultiSolutionIK()
+  std::vector<std::vector<double> > ik_solutions_;
+
+  // Only written by this thread, merged into the stats of the filter once all threads are done
+  GraspStats stats_;
 };
 typedef std::shared_ptr<IkThreadStruct> IkThreadStructPtr;
 
+/**
+ * \brief The grasp candidates of one object, for filtering the grasps of several objects at once
+ */
+struct ObjectGraspCandidates
+{
+  // The name of the object in the planning scene, may be empty if the object is not in the scene
+  std::string object_id_;
+  std::vector<GraspCandidatePtr> grasp_candidates_;
+
+  // Set by the filter
+  std::size_t num_valid_grasps_ = 0;
+  double best_grasp_quality_ = 0;
+};
+
 class GraspFilter
 {
 public:
@@ -171,6 +225,55 @@ public:
                             const planning_scene::PlanningScenePtr& planning_scene,
                             const moveit::core::JointModelGroup* arm_jmg, const moveit::core::RobotStatePtr& seed_state,
                             bool filter_pregrasp = false, const std::string& target_object_id = "");
+
+  /**
+   * \brief Return the kinematically feasible grasps of a batch, e.g. from TwoFingerGraspGenerator::generateGrasps().
+   * GraspCandidates are built for one chunk of chunk_size grasps at a time, in the order of the batch, and only the
+   * valid ones are kept. The filter code and ik solutions of every filtered grasp are written back to the batch.
+   * With setMaxValidGrasps() the remaining chunks are skipped, and marked GRASP_FILTERED_BY_EARLY_EXIT, once enough
+   * valid grasps were found
+   * \param grasp_candidate_batch - all possible grasps that this will test, best score first
+   * \param valid_grasp_candidates - output, the valid grasps are appended in the order of the batch
+   * \param chunk_size - number of GraspCandidates that are built and filtered at once
+   * \return true if a valid grasp was found
+   */
+  bool filterGrasps(GraspCandidateBatch& grasp_candidate_batch,
+                    const planning_scene_monitor::PlanningSceneMonitorPtr& planning_scene_monitor,
+                    const moveit::core::JointModelGroup* arm_jmg, const moveit::core::RobotStatePtr& seed_state,
+                    bool filter_pregrasp, const std::string& target_object_id,
+                    std::vector<GraspCandidatePtr>& valid_grasp_candidates, std::size_t chunk_size = 1000);
+
+  bool filterGrasps(GraspCandidateBatch& grasp_candidate_batch, const planning_scene::PlanningScenePtr& planning_scene,
+                    const moveit::core::JointModelGroup* arm_jmg, const moveit::core::RobotStatePtr& seed_state,
+                    bool filter_pregrasp, const std::string& target_object_id,
+                    std::vector<GraspCandidatePtr>& valid_grasp_candidates, std::size_t chunk_size = 1000);
+
+  /**
+   * \brief Return the kinematically feasible grasps of several objects, filtered in one pass. The scene is prepared
+   * once and the candidates of all objects are spread across the ik workers
+   * \param object_grasp_candidates - the candidates of every object. these are returned modified and ranked, see
+   * rankObjectGraspCandidates()
+   * \param arm_jmg - the arm to solve the IK problem on
+   * \param seed_state - A robot state to be used for IK. Ideally this will be close to the desired goal configuration.
+   * \param filter_pregrasp - Whether to also check ik feasibility for the pregrasp position
+   * \return true if any object has a valid grasp
+   */
+  virtual bool filterGrasps(std::vector<ObjectGraspCandidates>& object_grasp_candidates,
+                            const planning_scene_monitor::PlanningSceneMonitorPtr& planning_scene_monitor,
+                            const moveit::core::JointModelGroup* arm_jmg, const moveit::core::RobotStatePtr& seed_state,
+                            bool filter_pregrasp = false);
+
+  virtual bool filterGrasps(std::vector<ObjectGraspCandidates>& object_grasp_candidates,
+                            const planning_scene::PlanningScenePtr& planning_scene,
+                            const moveit::core::JointModelGroup* arm_jmg, const moveit::core::RobotStatePtr& seed_state,
+                            bool filter_pregrasp = false);
+
+  /**
+   * \brief Count the valid grasps of every object and sort the objects, those with valid grasps first and then by
+   * their best grasp quality
+   */
+  static void rankObjectGraspCandidates(std::vector<ObjectGraspCandidates>& object_grasp_candidates);
+
   /**
    * \brief Return grasps that are kinematically feasible
    * \param grasp_candidates - all possible grasps that this will test. this vector is returned modified
@@ -215,9 +318,45 @@ public:
 
   /**
    * \brief Of an array of grasps, sort the valid ones from best score to worse score
+   * \param max_results - only keep this many of the best grasps, sorting only those. 0 to keep all valid grasps
    * \return false if no grasps remain
    */
-  bool removeInvalidAndFilter(std::vector<GraspCandidatePtr>& grasp_candidates) const;
+  bool removeInvalidAndFilter(std::vector<GraspCandidatePtr>& grasp_candidates, std::size_t max_results = 0) const;
+
+  /**
+   * \brief Check previously validated grasps, e.g. from a GraspResultCache, against a planning scene with a single
+   *        collision check of their open grasp state instead of solving IK again. The candidates themselves are not
+   *        modified, the ones in collision are removed from the vector
+   * \param grasp_candidates - grasps with an IK solution. this vector is returned modified
+   * \param target_object_id - The name of the target grasp object in the planning scene if it exists
+   * \return number of grasps remaining
+   */
+  std::size_t verifyGraspCandidates(std::vector<GraspCandidatePtr>& grasp_candidates,
+                                    const planning_scene::PlanningScenePtr& planning_scene,
+                                    const std::string& target_object_id = "");
+
+  /**
+   * \brief Update the result of a previous filterGrasps() call after the planning scene changed, e.g. an obstacle moved
+   *        or the octomap was refreshed. The kept IK solutions of the valid grasps are only collision checked
+   *        against the new scene, and the grasps that now collide are filtered again including IK. The IK solutions
+   *        are only reusable while the robot base and the target object did not move, otherwise call filterGrasps().
+   *        Grasps that were already filtered stay filtered
+   * \param grasp_candidates - the grasps of the previous filterGrasps() call. this vector is returned modified
+   * \param arm_jmg - the arm to solve the IK problem on
+   * \param seed_state - A robot state to be used for IK of the grasps that are filtered again
+   * \param filter_pregrasp - Whether to also check the pregrasp, as in the previous filterGrasps() call
+   * \param target_object_id - The name of the target grasp object in the planning scene if it exists
+   * \return true if any valid grasp remains
+   */
+  bool revalidateGrasps(std::vector<GraspCandidatePtr>& grasp_candidates,
+                        const planning_scene_monitor::PlanningSceneMonitorPtr& planning_scene_monitor,
+                        const moveit::core::JointModelGroup* arm_jmg, const moveit::core::RobotStatePtr& seed_state,
+                        bool filter_pregrasp = false, const std::string& target_object_id = "");
+
+  bool revalidateGrasps(std::vector<GraspCandidatePtr>& grasp_candidates,
+                        const planning_scene::PlanningScenePtr& planning_scene,
+                        const moveit::core::JointModelGroup* arm_jmg, const moveit::core::RobotStatePtr& seed_state,
+                        bool filter_pregrasp = false, const std::string& target_object_id = "");
 
   /**
    * \brief Add a cutting plane filter for a shelf bin
@@ -230,7 +369,158 @@ public:
   void setACMFingerEntry(const std::string& object_name, bool allowed, const std::vector<std::string>& ee_link_names,
                          const planning_scene::PlanningScenePtr& planning_scene);
 
+  /**
+   * \brief Share one read-only planning scene between all IK threads instead of cloning it for every thread.
+   *        The ACM finger entries are then applied to a lightweight diff of the input scene.
+   *        Subclasses that modify the scene of an IkThreadStruct must leave this disabled.
+   */
+  void setSharePlanningScene(bool share_planning_scene)
+  {
+    share_planning_scene_ = share_planning_scene;
+  }
+
+  bool getSharePlanningScene() const
+  {
+    return share_planning_scene_;
+  }
+
+  /**
+   * \brief Stop filtering once this many grasps passed all checks. Candidates are then processed from highest to
+   *        lowest grasp_quality and the ones that were not reached are marked GRASP_FILTERED_BY_EARLY_EXIT.
+   *        Grasps already being processed when the limit is hit still finish, so slightly more may be returned.
+   * \param max_valid_grasps - number of valid grasps to find, 0 to filter all candidates
+   */
+  void setMaxValidGrasps(std::size_t max_valid_grasps)
+  {
+    max_valid_grasps_ = max_valid_grasps;
+  }
+
+  std::size_t getMaxValidGrasps() const
+  {
+    return max_valid_grasps_;
+  }
+
+  /**
+   * \brief Check the end effector links against the world before the whole arm, and only the end effector links once
+   *        the fingers are closed. Unlike the default check of the arm group, this also rejects states where the end
+   *        effector collides while the arm does not, and checks every valid candidate with its pre grasp opening
+   */
+  void setStagedCollisionChecking(bool staged_collision_checking)
+  {
+    staged_collision_checking_ = staged_collision_checking;
+  }
+
+  bool getStagedCollisionChecking() const
+  {
+    return staged_collision_checking_;
+  }
+
+  /**
+   * \brief Ask the IK solver for all solutions of a pose at once and keep the valid one closest to the seed, instead
+   *        of the first valid solution setFromIK() finds. Only for solvers that implement getPositionIK() for all
+   *        solutions, e.g. IKFast. A solution close to the seed makes the pre grasp IK and the cartesian approach
+   *        more likely to succeed
+   */
+  void setMultiSolutionIK(bool multi_solution_ik)
+  {
+    multi_solution_ik_ = multi_solution_ik;
+  }
+
+  bool getMultiSolutionIK() const
+  {
+    return multi_solution_ik_;
+  }
+
+  /**
+   * \brief Record the colliding states of collision_verbose and visualized filtering instead of publishing them from
+   *        the IK threads. The states are published after filtering, so debugging no longer limits filtering to a
+   *        single thread
+   * \param max_states - number of colliding states to keep per filterGrasps() call
+   */
+  void setDeferredCollisionVisualization(bool deferred_collision_visualization, std::size_t max_states = 100)
+  {
+    deferred_collision_visualization_ = deferred_collision_visualization;
+    collision_state_buffer_->setMaxStates(max_states);
+  }
+
+  bool getDeferredCollisionVisualization() const
+  {
+    return deferred_collision_visualization_;
+  }
+
+  /**
+   * \brief Reject grasps outside of an offline computed workspace before running IK. The map is used for the arm
+   *        named in the map, and only as long as its frame matches the base frame of that arm's IK solver
+   */
+  void setReachabilityMap(const ReachabilityMapConstPtr& reachability_map);
+
+  /**
+   * \brief Load a reachability map from disk, see ReachabilityMap::saveToFile()
+   * \return true on success
+   */
+  bool loadReachabilityMap(const std::string& filename);
+
+  /**
+   * \brief Remove the reachability map of an arm
+   */
+  void clearReachabilityMap(const std::string& arm_name);
+
+  /**
+   * \brief Choose how IK is seeded. SEED_FROM_NEAREST_SOLUTION reuses the grasp IK solution of the closest candidate
+   *        already solved in the same filter call, shared between all threads
+   * \param max_translation - maximum distance in meters to a solved grasp pose for its solution to be used
+   * \param max_rotation - maximum angle in radians to a solved grasp pose for its solution to be used
+   */
+  void setIkSeedStrategy(IkSeedStrategy ik_seed_strategy, double max_translation = 0.02, double max_rotation = 0.35);
+
+  /**
+   * \brief Use a different worker pool, e.g. to share one pool between several filters. Filtering keeps the pool
+   *        for its whole parallel section, so users of a shared pool run one after the other
+   */
+  void setIkWorkerPool(const IkWorkerPoolPtr& ik_worker_pool)
+  {
+    ik_worker_pool_ = ik_worker_pool;
+  }
+
+  const IkWorkerPoolPtr& getIkWorkerPool() const
+  {
+    return ik_worker_pool_;
+  }
+
+  /**
+   * \brief Durations and counters of the last filterGrasps() call
+   */
+  const GraspStats& getStats() const
+  {
+    return stats_;
+  }
+
 protected:
+  /**
+   * \brief Checks the arm and loads its IK settings before filtering
+   * \return false if the arm can not be used for filtering
+   */
+  bool prepareFilter(const moveit::core::JointModelGroup* arm_jmg, bool filter_pregrasp);
+
+  /**
+   * \brief Collision check of the kept IK solutions of a grasp, the open and closed grasp state and the pregrasp
+   * \param robot_state - state the solutions are applied to, with the non arm joints of the scene
+   * \return true if none of the states is in collision
+   */
+  bool isGraspCollisionFree(const GraspCandidatePtr& grasp_candidate, const planning_scene::PlanningScene& scene,
+                            moveit::core::RobotStatePtr& robot_state, bool check_pregrasp) const;
+
+  /**
+   * \brief Filter the grasps of several objects with the IK workers. Every object is checked in its own diff of the
+   * scene that allows collisions between the end effector and that object
+   * \return number of grasps remaining
+   */
+  virtual std::size_t filterObjectGraspsHelper(std::vector<ObjectGraspCandidates>& object_grasp_candidates,
+                                               const planning_scene::PlanningScenePtr& planning_scene,
+                                               const moveit::core::JointModelGroup* arm_jmg,
+                                               const moveit::core::RobotStatePtr& seed_state, bool filter_pregrasp,
+                                               bool visualize);
+
   /**
    * \brief Filter grasps by cutting plane
    * \param grasp_candidates - all possible grasps that this will test. this vector is returned modified
@@ -255,6 +545,24 @@ protected:
   bool filterGraspByOrientation(GraspCandidatePtr& grasp_candidate, const Eigen::Isometry3d& desired_pose,
                                 double max_angular_offset) const;
 
+  /**
+   * \brief Apply the cutting planes and desired orientations to all valid candidates at once, before any IK work is
+   *        set up. The positions and approach axes of all candidates are gathered into matrices, so every plane and
+   *        orientation is a single matrix product over all candidates. Gives the same codes as filterGraspByPlane()
+   *        and filterGraspByOrientation()
+   * \return number of candidates filtered
+   */
+  std::size_t filterGraspsByGeometry(std::vector<GraspCandidatePtr>& grasp_candidates) const;
+
+  /**
+   * \brief Filter grasps whose pose is outside of the arm's reachability map
+   * \param grasp_candidates - a grasp candidate that this will test
+   * \param ik_thread_struct - a struct containing the reachability map and the transform to the ik frame
+   * \return true if grasp is filtered by operation
+   */
+  bool filterGraspByReachability(const GraspCandidatePtr& grasp_candidate,
+                                 const IkThreadStructPtr& ik_thread_struct) const;
+
   /**
    * \brief Filter grasps by feasablity of the grasp pose.
    * \param grasp_candidates - a grasp candidate that this will test
@@ -283,6 +591,56 @@ protected:
                       const GraspCandidatePtr& grasp_candidate,
                       const moveit::core::GroupStateValidityCallbackFn& constraint_fn) const;
 
+  /**
+   * \brief Get all IK solutions of the pose from the solver of the thread and set the state of the thread to the valid
+   *        one closest to its current arm positions, see setMultiSolutionIK()
+   * \return true if any solution is valid
+   */
+  bool findClosestIKSolution(const IkThreadStructPtr& ik_thread_struct, const moveit::core::JointModelGroup* arm_jmg,
+                             const moveit::core::GroupStateValidityCallbackFn& constraint_fn) const;
+
+  /**
+   * \brief Group the valid candidates that have the same object, grasp data and grasp pose, in processing order
+   * \param unique_grasp_ids - output, the first candidate of every pose, and every filtered candidate
+   * \param pose_variant_ids - output, the other candidates with the pose of each unique candidate
+   */
+  static void groupGraspsByPose(const std::vector<GraspCandidatePtr>& grasp_candidates,
+                                const std::vector<std::size_t>& grasp_object_ids,
+                                const std::vector<std::size_t>& processing_order,
+                                std::vector<std::size_t>& unique_grasp_ids,
+                                std::vector<std::vector<std::size_t>>& pose_variant_ids);
+
+  /**
+   * \brief Collision check of the end effector links with the arm at the grasp IK solution and the end effector at
+   *        the pre grasp posture of the candidate
+   * \return false if the candidate was filtered
+   */
+  bool checkGraspStateOpen(const GraspCandidatePtr& grasp_candidate, const IkThreadStructPtr& ik_thread_struct) const;
+
+  /**
+   * \brief The collision check used while solving IK for a candidate, staged if enabled. The callback is created with
+   *        the first candidate of the thread and only pointed at the scene and end effector of the later ones
+   * \return the callback of the thread, valid as long as the thread struct
+   */
+  const moveit::core::GroupStateValidityCallbackFn&
+  getStateValidityCallback(const IkThreadStructPtr& ik_thread_struct, const GraspCandidatePtr& grasp_candidate) const;
+
+  /**
+   * \brief Collision check of the end effector links at the current robot state of the thread, reporting a collision
+   *        the same way as the callback of getStateValidityCallback()
+   * \return true if the end effector is not in collision
+   */
+  bool checkEndEffectorCollision(const IkThreadStructPtr& ik_thread_struct,
+                                 const moveit::core::JointModelGroup* ee_jmg) const;
+
+  /**
+   * \brief Whether the collision checks of the IK threads publish or record their collisions
+   */
+  bool isCollisionVisualDebug(const IkThreadStructPtr& ik_thread_struct) const
+  {
+    return (collision_verbose_ || ik_thread_struct->visual_debug_) && visual_tools_;
+  }
+
   /**
    * \brief add a cutting plane
    * \param pose - pose describing the cutting plane
@@ -349,11 +707,11 @@ protected:
   // Allow a writeable robot state
   moveit::core::RobotStatePtr robot_state_;
 
-  // Keep a robot state for every thread
-  std::vector<moveit::core::RobotStatePtr> robot_states_;
+  // Kinematic solvers and robot states for every thread, kept between calls
+  IkWorkerPoolPtr ik_worker_pool_;
 
-  // Threaded kinematic solvers
-  std::map<std::string, std::vector<kinematics::KinematicsBaseConstPtr> > kin_solvers_;
+  // Stats of the last filterGrasps() call, the helpers add to them
+  GraspStats stats_;
 
   // Class for publishing stuff to rviz
   moveit_visual_tools::MoveItVisualToolsPtr visual_tools_;
@@ -377,9 +735,32 @@ protected:
   double show_filtered_arm_solutions_pregrasp_speed_;
   bool show_grasp_filter_collision_if_failed_;
 
+  // Share one immutable scene between all IK threads
+  bool share_planning_scene_ = false;
+
+  // Check the end effector before the arm
+  bool staged_collision_checking_ = false;
+
+  // Keep the valid IK solution closest to the seed out of all solutions of the solver
+  bool multi_solution_ik_ = false;
+
+  // Record colliding states and publish them after filtering
+  bool deferred_collision_visualization_ = false;
+  CollisionStateBufferPtr collision_state_buffer_ = std::make_shared<CollisionStateBuffer>();
+
+  // Stop after this many valid grasps, 0 to disable
+  std::size_t max_valid_grasps_ = 0;
+
   // Shared node handle
   rclcpp::Node::SharedPtr nh_;
 
+  // Seeding of IK solutions between candidates
+  IkSeedStrategy ik_seed_strategy_ = SEED_FROM_PREVIOUS_SOLUTION;
+  IkSeedCachePtr ik_seed_cache_;
+
+  // Workspace maps keyed by arm name
+  std::map<std::string, ReachabilityMapConstPtr> reachability_maps_;
+
   // Cutting planes and orientation filter
   std::vector<CuttingPlanePtr> cutting_planes_;
   std::vector<DesiredGraspOrientationPtr> desired_grasp_orientations_;
@@ -66,12 +66,14 @@
 // moveit_grasps
 #include <moveit_grasps/grasp_candidate.h>
 #include <moveit_grasps/grasp_scorer.h>
+#include <moveit_grasps/grasp_stats.h>
 
 // bounding_box
 //#include <bounding_box/bounding_box.h>
 
 // C++
 #include <cstdlib>
+#include <functional>
 #include <string>
 #include <cmath>
 #include <limits>
@@ -83,6 +85,9 @@ namespace moveit_grasps
 static const double RAD2DEG = 57.2957795;
 static const double MIN_GRASP_DISTANCE = 0.001;  // m between grasps
 
+// Receives the generated grasps in chunks, return false to stop the generation
+typedef std::function<bool(std::vector<GraspCandidatePtr>& grasp_candidates)> GraspCandidatesCallback;
+
 // Grasp axis orientation
 enum grasp_axis_t
 {
@@ -118,6 +123,18 @@ public:
   virtual bool generateGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width, double height,
                               const GraspDataPtr& grasp_data, std::vector<GraspCandidatePtr>& grasp_candidates) = 0;
 
+  /**
+   * \brief Create possible grasp positions around a cuboid and pass them to a callback in chunks, best score first.
+   *        This way filtering can start on the best grasps, and stop the generation once enough grasps were found.
+   *        This implementation generates and sorts all grasps before the first chunk, overrides can yield earlier
+   * \param callback - called for each chunk, return false to stop
+   * \param chunk_size - max number of grasps per chunk
+   * \return true if successful, also when stopped by the callback
+   */
+  virtual bool streamGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width, double height,
+                            const GraspDataPtr& grasp_data, const GraspCandidatesCallback& callback,
+                            std::size_t chunk_size = 100);
+
   /**
    * \brief Get the grasp direction vector relative to the world frame
    * \param grasp
@@ -136,6 +153,13 @@ public:
    */
   static geometry_msgs::msg::PoseStamped getPreGraspPose(const GraspCandidatePtr& grasp_candidate,
                                                          const std::string& ee_parent_link);
+
+  /**
+   * \brief Get the pregrasp pose of the eef mount with the precomputed GraspData::pre_grasp_offset_, without going
+   *        through messages. Matches the message version for grasps whose approach was set by a grasp generator
+   */
+  static void getPreGraspPose(const GraspCandidatePtr& grasp_candidate, Eigen::Isometry3d& pre_grasp_pose);
+
   /**
    * \brief Compute the pre-grasp, grasp, lift and retreat poses for a grasp candidate
    * \param grasp_candidate - the grasp candidate
@@ -206,6 +230,14 @@ public:
     verbose_ = verbose;
   }
 
+  /**
+   * \brief Durations of the last generateGrasps() or streamGrasps() call, without the time spent in the callback
+   */
+  const GraspStats& getStats() const
+  {
+    return stats_;
+  }
+
   /**
    * \brief Visualize animated grasps
    * \return true on success
@@ -217,6 +249,12 @@ public:
   Eigen::Isometry3d ideal_grasp_pose_;
 
 protected:
+  /**
+   * \brief Reserve a range of grasp ids that is unique over all generators and threads
+   * \return the first id of the range
+   */
+  static std::size_t reserveGraspIds(std::size_t num_ids);
+
   // class for publishing stuff to rviz
   moveit_visual_tools::MoveItVisualToolsPtr visual_tools_;
 
@@ -238,6 +276,9 @@ protected:
 
   GraspScoreWeightsPtr grasp_score_weights_;
 
+  // Filled by the generation of the child classes
+  GraspStats stats_;
+
 };  // end of class
 
 typedef std::shared_ptr<GraspGenerator> GraspGeneratorPtr;
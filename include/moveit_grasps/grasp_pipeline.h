@@ -0,0 +1,177 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+/* Desc:   Runs grasp generation, filtering and approach lift retreat planning as one cancellable pipeline
+*/
+
+#ifndef MOVEIT_GRASPS__GRASP_PIPELINE_
+#define MOVEIT_GRASPS__GRASP_PIPELINE_
+
+// moveit_grasps
+#include <moveit_grasps/grasp_candidate.h>
+#include <moveit_grasps/grasp_data.h>
+#include <moveit_grasps/grasp_filter.h>
+#include <moveit_grasps/grasp_generator.h>
+#include <moveit_grasps/grasp_planner.h>
+#include <moveit_grasps/grasp_stats.h>
+
+// MoveIt
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_state/robot_state.h>
+
+// C++
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace moveit_grasps
+{
+/**
+ * \brief Description of one object to grasp and the limits for finding its grasps
+ */
+struct GraspPipelineRequest
+{
+  // The cuboid to grasp, see GraspGenerator::generateGrasps()
+  Eigen::Isometry3d cuboid_pose_ = Eigen::Isometry3d::Identity();
+  double depth_ = 0;
+  double width_ = 0;
+  double height_ = 0;
+  GraspDataPtr grasp_data_;
+
+  // Read by the filter and the planner at the same time, it must not be changed while the request runs
+  planning_scene::PlanningScenePtr planning_scene_;
+  const moveit::core::JointModelGroup* arm_jmg_ = nullptr;
+  // Seed for IK and start state of the approach path
+  moveit::core::RobotStatePtr seed_state_;
+  // The name of the target grasp object in the planning scene, may be empty
+  std::string grasp_object_id_;
+  bool filter_pregrasp_ = true;
+
+  // Stop at this time and return the grasps planned until then. Stages are only interrupted between chunks
+  std::chrono::steady_clock::time_point deadline_ = std::chrono::steady_clock::time_point::max();
+  // Stop once this many grasps have a valid path, 0 to plan every candidate
+  std::size_t max_planned_grasps_ = 1;
+  // Number of generated grasps passed on to the filter at once. Smaller chunks react faster to the deadline
+  std::size_t chunk_size_ = 100;
+  // Set to true from any thread to stop the request, may be null
+  std::shared_ptr<std::atomic<bool>> cancel_requested_;
+};
+
+struct GraspPipelineResult
+{
+  enum Status
+  {
+    SUCCESS,           // generation finished or max_planned_grasps_ was reached
+    NO_VALID_GRASPS,   // generation finished without a single planned grasp
+    DEADLINE_REACHED,  // stopped by the deadline, grasp_candidates_ holds what was planned until then
+    CANCELLED,         // stopped by cancel_requested_, grasp_candidates_ holds what was planned until then
+    INVALID_REQUEST,
+  };
+
+  Status status_ = NO_VALID_GRASPS;
+
+  // Grasps with valid IK and approach lift retreat paths, best grasp_quality first
+  std::vector<GraspCandidatePtr> grasp_candidates_;
+
+  // Statistics
+  std::size_t num_generated_ = 0;
+  std::size_t num_ik_valid_ = 0;
+  double duration_ = 0;  // seconds
+  // Stage durations and counters of the generator, filter and planner, summed over all chunks
+  GraspStats stats_;
+};
+
+// Receives the result of an asynchronous request on the pipeline thread
+typedef std::function<void(const GraspPipelineResult& result)> GraspPipelineCallback;
+
+/**
+ * \brief Streams generated grasps chunk by chunk, best score first, through the filter and the planner. The next chunk
+ *        is filtered while the valid grasps of the previous one are planned, unless the planner uses the IkWorkerPool
+ *        of the filter, then the stages alternate on that pool.
+ */
+class GraspPipeline
+{
+public:
+  /**
+   * \brief Constructor
+   */
+  GraspPipeline(const GraspGeneratorPtr& grasp_generator, const GraspFilterPtr& grasp_filter,
+                const GraspPlannerPtr& grasp_planner);
+
+  /**
+   * \brief Find planned grasps for one object on the calling thread
+   * \return the planned grasps and why the pipeline stopped
+   */
+  GraspPipelineResult plan(const GraspPipelineRequest& request);
+
+  /**
+   * \brief Find planned grasps for one object on a new thread. Requests run one at a time because they share the
+   *        generator, filter and planner, so the pipeline must outlive the returned future
+   * \param callback - optional, called with the result before the future becomes ready
+   * \return the future result
+   */
+  std::future<GraspPipelineResult> planAsync(const GraspPipelineRequest& request,
+                                             const GraspPipelineCallback& callback = GraspPipelineCallback());
+
+  /**
+   * \brief Publish the stats of every request, null to stop publishing
+   */
+  void setStatsPublisher(const GraspStatsPublisherPtr& stats_publisher)
+  {
+    stats_publisher_ = stats_publisher;
+  }
+
+private:
+  GraspGeneratorPtr grasp_generator_;
+  GraspFilterPtr grasp_filter_;
+  GraspPlannerPtr grasp_planner_;
+  GraspStatsPublisherPtr stats_publisher_;
+
+  // Serializes requests
+  std::mutex pipeline_mutex_;
+};  // end class
+
+// Create smart pointers for this class
+typedef std::shared_ptr<GraspPipeline> GraspPipelinePtr;
+typedef std::shared_ptr<const GraspPipeline> GraspPipelineConstPtr;
+
+}  // namespace moveit_grasps
+
+#endif
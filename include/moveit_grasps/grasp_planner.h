@@ -45,15 +45,46 @@
 // moveit_grasps
 #include <moveit_grasps/grasp_candidate.h>
 #include <moveit_grasps/grasp_generator.h>
+#include <moveit_grasps/grasp_stats.h>
+#include <moveit_grasps/ik_worker_pool.h>
 
 // moveit
+#include <moveit/planning_scene/planning_scene.h>
 #include <moveit_visual_tools/moveit_visual_tools.h>
 
+// C++
+#include <atomic>
+
 namespace moveit_grasps
 {
 // Allow an interrupt to be called that waits for user input, useful for debugging
 typedef boost::function<void(std::string message)> WaitForNextStepCallback;
 
+/**
+ * \brief Planning scenes for the cartesian paths of one grasp object. They are built once and then used read only
+ *        by every attempt of every candidate
+ */
+struct PreparedGraspScene
+{
+  // Scene in which the end effector may touch the grasp object, used for the approach
+  planning_scene::PlanningScenePtr approach_scene_;
+
+  // Scene without the grasp object in the world, used for lift and retreat while the object is attached to the robot
+  planning_scene::PlanningScenePtr lift_scene_;
+
+  // State the compact trajectories of the candidates refer to, set once per planAllApproachLiftRetreat() call
+  moveit::core::RobotStateConstPtr reference_state_;
+
+  // Headless collision checks of the approach and lift scenes, built once and shared by all attempts
+  moveit::core::GroupStateValidityCallbackFn approach_constraint_fn_;
+  moveit::core::GroupStateValidityCallbackFn lift_constraint_fn_;
+
+  // Shapes of the grasp object and their poses in the planning frame, empty if nothing is attached
+  std::string object_id_;
+  std::vector<shapes::ShapeConstPtr> object_shapes_;
+  EigenSTL::vector_Isometry3d object_shape_poses_;
+};
+
 class GraspPlanner
 {
 public:
@@ -63,7 +94,8 @@ public:
   GraspPlanner(rclcpp::Node::SharedPtr node, const moveit_visual_tools::MoveItVisualToolsPtr& visual_tools);
 
   /**
-   * \brief Plan entire cartesian manipulation sequence
+   * \brief Plan entire cartesian manipulation sequence. Candidates are planned in order of grasp_quality and the
+   *        result is returned in that order, also when planning on a single thread
    * \param grasp_candidates - GraspCandidates for which we will compute apprach, lift and retreat paths
    * \param robot_state - robot_state to be used for computeCartesianPath
    * \param planning_scene_monitor - Current state of the world
@@ -81,6 +113,59 @@ public:
                                   const planning_scene::PlanningSceneConstPtr& planning_scene,
                                   const std::string& grasp_object_id = "");
 
+  /**
+   * \brief Plan the candidates in parallel on the workers of a pool, e.g. the pool of the GraspFilter. Debug
+   *        visualization settings fall back to planning on a single thread
+   * \param ik_worker_pool - the pool to use, or null to plan on the calling thread
+   */
+  void setIkWorkerPool(const IkWorkerPoolPtr& ik_worker_pool)
+  {
+    ik_worker_pool_ = ik_worker_pool;
+  }
+
+  const IkWorkerPoolPtr& getIkWorkerPool() const
+  {
+    return ik_worker_pool_;
+  }
+
+  /**
+   * \brief Stop planning once this many candidates have a valid path. The result always contains the first valid
+   *        candidates in the order they are planned, regardless of the number of threads
+   * \param max_successful_paths - number of paths to find, 0 to plan all candidates
+   */
+  void setMaxSuccessfulPaths(std::size_t max_successful_paths)
+  {
+    max_successful_paths_ = max_successful_paths;
+  }
+
+  std::size_t getMaxSuccessfulPaths() const
+  {
+    return max_successful_paths_;
+  }
+
+  /**
+   * \brief Keep only the arm positions of the planned paths in GraspCandidate::compact_cartesian_traj_ instead of a
+   *        full RobotState per waypoint. Call GraspCandidate::expandCartesianTrajectories() on the chosen grasp to get
+   *        segmented_cartesian_traj_ back
+   */
+  void setCompactTrajectories(bool compact_trajectories)
+  {
+    compact_trajectories_ = compact_trajectories;
+  }
+
+  bool getCompactTrajectories() const
+  {
+    return compact_trajectories_;
+  }
+
+  /**
+   * \brief Durations of the last planAllApproachLiftRetreat() call
+   */
+  const GraspStats& getStats() const
+  {
+    return stats_;
+  }
+
   /**
    * \brief Plan entire cartesian manipulation sequence
    * \param input - description
@@ -110,6 +195,19 @@ public:
                                     const EigenSTL::vector_Isometry3d& waypoints,
                                     const std::string& grasp_object_id = "");
 
+  bool computeCartesianWaypointPath(GraspCandidatePtr& grasp_candidate, const PreparedGraspScene& prepared_scene,
+                                    const moveit::core::RobotStatePtr& start_state,
+                                    const EigenSTL::vector_Isometry3d& waypoints);
+
+  /**
+   * \brief Build the scenes used for planning the cartesian paths of grasps on an object
+   * \param grasp_data - the end effector whose links may touch the object
+   * \param grasp_object_id - The name of the target grasp object in the planning scene, may be empty
+   * \param prepared_scene - the resulting scenes
+   */
+  void prepareGraspScene(const planning_scene::PlanningSceneConstPtr& planning_scene, const GraspDataPtr& grasp_data,
+                         const std::string& grasp_object_id, PreparedGraspScene& prepared_scene) const;
+
   /**
    * \brief Wait for user input to proceeed
    * \param message - text to display to user when waiting
@@ -124,22 +222,47 @@ public:
   void setWaitForNextStepCallback(WaitForNextStepCallback callback);
 
   /**
-   * \brief Load parameter settings of the server under ~/debug_level
-   * \param parent_name - only used for debugging, allows one to see what paremeters are loaded in what namespace
-   * \param setting_namespace - where on this node's namespace to load settings
-   *        e.g. /this_name/setting_namespace/some_parameter
-   * \return true on success
+   * \brief Load the settings under moveit_grasps.planner. Missing settings are disabled. The settings are updated
+   *        when those parameters are changed on the node, so isEnabled() does not query the parameter server
+   * \return true if all settings were found
    */
   bool loadEnabledSettings();
 
   /**
-   * \brief Check if a setting is enabled
+   * \brief Check if a setting is enabled, one of statistics_verbose, verbose_cartesian_filtering,
+   *        show_cartesian_waypoints and collision_checking_verbose
    * \param setting_name - name of key on the parameter server as loaded in the 'setting_namespace'
    * \return true if setting is enabled
    */
   bool isEnabled(const std::string& setting_name);
 
 private:
+  /**
+   * \brief Plan all candidates on the worker pool, removing the ones without a valid path
+   */
+  void planAllApproachLiftRetreatParallel(std::vector<GraspCandidatePtr>& grasp_candidates,
+                                          const moveit::core::RobotStatePtr& robot_state,
+                                          const PreparedGraspScene& prepared_scene, std::size_t num_threads);
+
+  /**
+   * \brief Plan entire cartesian manipulation sequence in already prepared scenes
+   */
+  bool planApproachLiftRetreat(GraspCandidatePtr& grasp_candidate, const moveit::core::RobotStatePtr& robot_state,
+                               const PreparedGraspScene& prepared_scene, bool verbose_cartesian_filtering,
+                               bool show_cartesian_waypoints, bool collision_checking_verbose);
+
+  /**
+   * \brief Compute a cartesian path along waypoints in already prepared scenes
+   */
+  bool computeCartesianWaypointPath(GraspCandidatePtr& grasp_candidate, const PreparedGraspScene& prepared_scene,
+                                    const moveit::core::RobotStatePtr& start_state,
+                                    const EigenSTL::vector_Isometry3d& waypoints, bool collision_checking_verbose);
+
+  /**
+   * \brief Get the member of an enabled setting, or nullptr if there is no setting of this name
+   */
+  std::atomic<bool>* getEnabledSetting(const std::string& setting_name);
+
   // A shared node handle
   rclcpp::Node::SharedPtr nh_;
 
@@ -148,9 +271,24 @@ private:
 
   WaitForNextStepCallback wait_for_next_step_callback_;
 
-  // Visualization settings
-  bool enabled_settings_loaded_ = false;
-  std::map<std::string, bool> enabled_setting_;
+  // Optional pool for planning candidates in parallel
+  IkWorkerPoolPtr ik_worker_pool_;
+
+  // Stop after this many valid paths, 0 to disable
+  std::size_t max_successful_paths_ = 0;
+
+  // Store the planned paths as arm positions only
+  bool compact_trajectories_ = false;
+
+  // Stats of the last planAllApproachLiftRetreat() call
+  GraspStats stats_;
+
+  // Visualization settings, read once per planAllApproachLiftRetreat() call and passed to the workers
+  std::atomic<bool> statistics_verbose_{ false };
+  std::atomic<bool> verbose_cartesian_filtering_{ false };
+  std::atomic<bool> show_cartesian_waypoints_{ false };
+  std::atomic<bool> collision_checking_verbose_{ false };
+  rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr enabled_settings_callback_handle_;
 
 };  // end class
 
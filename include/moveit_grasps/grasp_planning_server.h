@@ -0,0 +1,157 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Composable node that serves grasp generation, filtering and planning to several clients
+*/
+
+#ifndef MOVEIT_GRASPS__GRASP_PLANNING_SERVER_
+#define MOVEIT_GRASPS__GRASP_PLANNING_SERVER_
+
+// ROS
+#include <rclcpp/rclcpp.hpp>
+
+// Grasping
+#include <moveit_grasps/database_grasp_generator.h>
+#include <moveit_grasps/grasp_pipeline.h>
+#include <moveit_grasps/ik_worker_pool.h>
+#include <moveit_grasps/two_finger_grasp_data.h>
+#include <moveit_grasps/two_finger_grasp_filter.h>
+#include <moveit_grasps/two_finger_grasp_generator.h>
+
+// MoveIt
+#include <moveit/planning_scene_monitor/planning_scene_monitor.h>
+#include <moveit_msgs/srv/grasp_planning.hpp>
+#include <moveit_visual_tools/moveit_visual_tools.h>
+
+// C++
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace moveit_grasps
+{
+/**
+ * \brief Offers the generator, filter and planner of one end effector as a moveit_msgs/srv/GraspPlanning service.
+ *        The grasp data, the IK solvers and the planning scene monitor are loaded once when the node starts, so
+ *        all task nodes of a robot can share one warm grasp engine by loading this component into their container.
+ *
+ *        A request with candidate_grasps filters and plans those, otherwise grasps are generated for the box of
+ *        request.target. The grasps are checked against a snapshot of the monitored scene, with request.target
+ *        added if it is not in the scene yet. Requests run one at a time.
+ *
+ *        Parameters, besides the grasp data and moveit_grasps settings the demos use:
+ *        planning_group_name, ee_group_name - default arm and end effector
+ *        grasp_planning_server.max_planned_grasps - number of planned grasps to return, 0 for all, default 10
+ *        grasp_planning_server.timeout - seconds a request may take, 0 for no limit, default 0
+ *        grasp_planning_server.num_threads - IK workers shared by the filter and the planner, 0 for the OpenMP default
+ *        grasp_planning_server.grasp_database - optional GraspDatabase file, targets whose id is in the database get
+ *                                               their grasps from it instead of the generator
+ */
+class GraspPlanningServer : public rclcpp::Node
+{
+public:
+  /**
+   * \brief Constructor, the grasp engine is loaded once the node is spinning
+   */
+  explicit GraspPlanningServer(const rclcpp::NodeOptions& options);
+
+  /**
+   * \brief Handle one request on the calling thread, also used by the service callback
+   */
+  void planGrasps(const moveit_msgs::srv::GraspPlanning::Request& request,
+                  moveit_msgs::srv::GraspPlanning::Response& response);
+
+private:
+  /**
+   * \brief Load the robot model, scene monitor, grasp data and the grasp classes, then warm up the IK solvers
+   * \return true on success
+   */
+  bool initialize();
+
+  /**
+   * \brief Read the box to grasp from the first primitive of the target
+   * \return false if the target is not a box
+   */
+  bool getTargetCuboid(const moveit_msgs::msg::CollisionObject& target,
+                       const planning_scene::PlanningScene& planning_scene, Eigen::Isometry3d& cuboid_pose,
+                       double& depth, double& width, double& height) const;
+
+  /**
+   * \brief Filter and plan the grasps of a request, either the given candidate_grasps or newly generated ones
+   * \return the MoveItErrorCodes value of the response
+   */
+  int planTargetGrasps(const moveit_msgs::srv::GraspPlanning::Request& request,
+                       const planning_scene::PlanningScenePtr& planning_scene,
+                       const moveit::core::JointModelGroup* arm_jmg,
+                       std::vector<GraspCandidatePtr>& grasp_candidates);
+
+  rclcpp::Logger LOGGER;
+
+  // Defers the loading until shared_from_this() is available
+  rclcpp::TimerBase::SharedPtr initialize_timer_;
+  std::atomic<bool> initialized_{ false };
+
+  std::string planning_group_name_;
+  std::string ee_group_name_;
+  std::size_t max_planned_grasps_ = 10;
+  double timeout_ = 0;
+
+  planning_scene_monitor::PlanningSceneMonitorPtr planning_scene_monitor_;
+  moveit_visual_tools::MoveItVisualToolsPtr visual_tools_;
+  TwoFingerGraspDataPtr grasp_data_;
+  IkWorkerPoolPtr ik_worker_pool_;
+  TwoFingerGraspGeneratorPtr grasp_generator_;
+  TwoFingerGraspFilterPtr grasp_filter_;
+  GraspPlannerPtr grasp_planner_;
+  GraspPipelinePtr grasp_pipeline_;
+
+  // Only set if a grasp database is configured
+  GraspDatabasePtr grasp_database_;
+  DatabaseGraspGeneratorPtr database_grasp_generator_;
+  GraspPipelinePtr database_grasp_pipeline_;
+
+  rclcpp::Service<moveit_msgs::srv::GraspPlanning>::SharedPtr grasp_planning_service_;
+
+  // Serializes requests, they share the grasp classes
+  std::mutex request_mutex_;
+};  // end class
+
+// Create smart pointers for this class
+typedef std::shared_ptr<GraspPlanningServer> GraspPlanningServerPtr;
+
+}  // namespace moveit_grasps
+
+#endif
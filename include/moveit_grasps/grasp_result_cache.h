@@ -0,0 +1,157 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Cache of validated grasp candidates for objects that are seen repeatedly in nearly the same pose
+*/
+
+#ifndef MOVEIT_GRASPS__GRASP_RESULT_CACHE_
+#define MOVEIT_GRASPS__GRASP_RESULT_CACHE_
+
+// ROS
+#include <rclcpp/rclcpp.hpp>
+
+// Grasping
+#include <moveit_grasps/grasp_candidate.h>
+
+// C++
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+
+namespace moveit_grasps
+{
+/**
+ * \brief Identifies one grasping problem: an object of a given size in a quantized pose, grasped by an end effector
+ *        in a given version of the planning scene
+ */
+struct GraspResultCacheKey
+{
+  // Quantized dimensions, position and orientation (quaternion) of the object
+  std::array<std::int64_t, 10> quantized_object_;
+  std::string end_effector_name_;
+  std::uint64_t scene_revision_;
+
+  bool operator<(const GraspResultCacheKey& other) const
+  {
+    if (scene_revision_ != other.scene_revision_)
+      return scene_revision_ < other.scene_revision_;
+    if (quantized_object_ != other.quantized_object_)
+      return quantized_object_ < other.quantized_object_;
+    return end_effector_name_ < other.end_effector_name_;
+  }
+};
+
+/**
+ * \brief Stores the grasp candidates that survived filtering and planning so that they can be replayed when the
+ *        same object shows up again. Returned candidates are shared with the cache and must be treated as read only,
+ *        use GraspFilter::verifyGraspCandidates() to check them against the current scene
+ */
+class GraspResultCache
+{
+public:
+  /**
+   * \brief Constructor
+   * \param position_resolution - quantization of the object position and dimensions in meters
+   * \param orientation_resolution - quantization of the object orientation quaternion components
+   * \param max_entries - number of objects to remember, the oldest entry is dropped first
+   */
+  GraspResultCache(double position_resolution = 0.001, double orientation_resolution = 0.002,
+                   std::size_t max_entries = 1000);
+
+  /**
+   * \brief Build the key of a grasping problem
+   * \param scene_revision - incremented by the user whenever the part of the scene relevant for grasping changes
+   */
+  GraspResultCacheKey getKey(const Eigen::Isometry3d& cuboid_pose, double depth, double width, double height,
+                             const GraspDataPtr& grasp_data, std::uint64_t scene_revision) const;
+
+  /**
+   * \brief Get the candidates stored for a key
+   * \return true on a cache hit
+   */
+  bool lookup(const GraspResultCacheKey& key, std::vector<GraspCandidatePtr>& grasp_candidates);
+
+  /**
+   * \brief Store the candidates for a key, replacing any previous entry. Only valid candidates are stored
+   */
+  void insert(const GraspResultCacheKey& key, const std::vector<GraspCandidatePtr>& grasp_candidates);
+
+  /**
+   * \brief Remove all entries and reset the counters
+   */
+  void clear();
+
+  std::size_t getHits() const
+  {
+    return hits_;
+  }
+
+  std::size_t getMisses() const
+  {
+    return misses_;
+  }
+
+  std::size_t size() const;
+
+private:
+  std::int64_t quantize(double value, double resolution) const
+  {
+    return static_cast<std::int64_t>(std::llround(value / resolution));
+  }
+
+  rclcpp::Logger LOGGER;
+
+  double position_resolution_;
+  double orientation_resolution_;
+  std::size_t max_entries_;
+
+  std::map<GraspResultCacheKey, std::vector<GraspCandidatePtr> > entries_;
+
+  // Insertion order, for evicting the oldest entry
+  std::deque<GraspResultCacheKey> insertion_order_;
+
+  std::atomic<std::size_t> hits_;
+  std::atomic<std::size_t> misses_;
+  mutable std::mutex mutex_;
+};
+
+typedef std::shared_ptr<GraspResultCache> GraspResultCachePtr;
+
+}  // namespace moveit_grasps
+
+#endif
@@ -48,6 +48,7 @@
 
 #include <Eigen/Core>
 #include <Eigen/Geometry>
+#include <eigen_stl_containers/eigen_stl_vector_container.h>
 
 namespace moveit_grasps
 {
@@ -67,6 +68,10 @@ struct GraspScoreWeights
   double computeScore(const Eigen::Vector3d& orientation_scores, const Eigen::Vector3d& translation_scores,
                       bool verbose = false) const;
 
+  /* \brief Compute the weighted scores of many grasps, one column of orientation and translation scores per grasp */
+  void computeScores(const Eigen::Matrix3Xd& orientation_scores, const Eigen::Matrix3Xd& translation_scores,
+                     Eigen::VectorXd& scores) const;
+
   /* \brief returns the sum of the grasp score weights*/
   virtual double getWeightTotal() const;
 
@@ -119,6 +124,21 @@ public:
    */
   static Eigen::Vector3d scoreGraspTranslation(const Eigen::Isometry3d& grasp_pose_tcp,
                                                const Eigen::Isometry3d& ideal_pose);
+
+  /**
+   * \brief Batch version of scoreRotationsFromDesired(), without debug output
+   * \param scores - one column of unweighted x, y and z axis scores per grasp pose
+   */
+  static void scoreRotationsFromDesired(const EigenSTL::vector_Isometry3d& grasp_poses_tcp,
+                                        const Eigen::Isometry3d& ideal_pose, Eigen::Matrix3Xd& scores);
+
+  /**
+   * \brief Batch version of scoreGraspTranslation() for min/max translations, without debug output
+   * \param scores - one column of unweighted x, y and z translation scores per grasp pose
+   */
+  static void scoreGraspTranslation(const EigenSTL::vector_Isometry3d& grasp_poses_tcp,
+                                    const Eigen::Vector3d& min_translations, const Eigen::Vector3d& max_translations,
+                                    Eigen::Matrix3Xd& scores);
 };
 
 }  // namespace moveit_grasps
@@ -0,0 +1,170 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Timers and counters of the grasp generation, filtering and planning stages
+*/
+
+#ifndef MOVEIT_GRASPS__GRASP_STATS_
+#define MOVEIT_GRASPS__GRASP_STATS_
+
+// ROS
+#include <rclcpp/rclcpp.hpp>
+#include <std_msgs/msg/string.hpp>
+
+// C++
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace moveit_grasps
+{
+/**
+ * \brief The timed stages of finding a grasp
+ */
+enum GraspStage
+{
+  GENERATION,                  // creating the grasp poses, without scoring
+  SCORING,                     // scoring the generated grasp poses
+  CUTTING_PLANE_ORIENTATION,   // cutting plane, desired orientation and reachability checks of the filter
+  GRASP_IK,                    // IK and collision checks of the grasp pose
+  PREGRASP_IK,                 // IK and collision checks of the pregrasp pose
+  CLOSED_FINGER_CHECK,         // collision check of the grasp with closed fingers
+  CARTESIAN_PLANNING,          // approach, lift and retreat paths of the planner
+  NUM_GRASP_STAGES
+};
+
+/**
+ * \brief Durations and counters of the grasp stages. Worker threads fill their own copy, which are merged once the
+ *        threads are done, so nothing is shared while timing
+ */
+struct GraspStats
+{
+  /**
+   * \brief Add the duration of one run of a stage
+   */
+  void addStageDuration(GraspStage stage, double duration)
+  {
+    stage_durations_[stage] += duration;
+    ++stage_counts_[stage];
+  }
+
+  /**
+   * \brief Add the durations and counters of another stats object, threads are matched by their id
+   */
+  void merge(const GraspStats& other);
+
+  /**
+   * \brief Reset all durations and counters
+   */
+  void clear();
+
+  /**
+   * \brief Fraction of the wall duration a thread spent on tasks
+   */
+  double getThreadUtilization(std::size_t thread_id) const;
+
+  /**
+   * \brief Human readable table of all durations and counters
+   */
+  std::string toString() const;
+
+  static const char* getStageName(GraspStage stage);
+
+  // Seconds spent in each stage, summed over all threads
+  std::array<double, NUM_GRASP_STAGES> stage_durations_{};
+  // Number of runs of each stage, e.g. number of candidates that reached the grasp IK
+  std::array<std::size_t, NUM_GRASP_STAGES> stage_counts_{};
+
+  // IK results. An IK that failed only after the solver timeout is counted as timed out
+  std::size_t ik_solved_ = 0;
+  std::size_t ik_failed_ = 0;
+  std::size_t ik_timed_out_ = 0;
+
+  // Seconds each worker thread spent on tasks, indexed by thread id
+  std::vector<double> thread_busy_durations_;
+  // Seconds of wall time of the parallel sections the threads ran in
+  double parallel_duration_ = 0;
+  // Seconds of wall time of the whole call
+  double duration_ = 0;
+};
+typedef std::shared_ptr<GraspStats> GraspStatsPtr;
+
+/**
+ * \brief Adds the time until it goes out of scope to a stage. Does nothing if stats is null
+ */
+class ScopedGraspStageTimer
+{
+public:
+  ScopedGraspStageTimer(GraspStats* stats, GraspStage stage)
+    : stats_(stats), stage_(stage), start_time_(std::chrono::steady_clock::now())
+  {
+  }
+
+  ~ScopedGraspStageTimer()
+  {
+    if (stats_)
+      stats_->addStageDuration(stage_, getElapsed());
+  }
+
+  double getElapsed() const
+  {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+  }
+
+private:
+  GraspStats* stats_;
+  GraspStage stage_;
+  std::chrono::steady_clock::time_point start_time_;
+};
+
+/**
+ * \brief Publishes grasp stats as a table on a std_msgs/String topic, for watching them with ros2 topic echo
+ */
+class GraspStatsPublisher
+{
+public:
+  GraspStatsPublisher(const rclcpp::Node::SharedPtr& node, const std::string& topic = "grasp_stats");
+
+  void publish(const GraspStats& stats) const;
+
+private:
+  rclcpp::Publisher<std_msgs::msg::String>::SharedPtr publisher_;
+};
+typedef std::shared_ptr<GraspStatsPublisher> GraspStatsPublisherPtr;
+
+}  // namespace moveit_grasps
+
+#endif
@@ -0,0 +1,139 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Thread safe cache of solved IK poses, used to seed IK for nearby grasp candidates
+*/
+
+#ifndef MOVEIT_GRASPS__IK_SEED_CACHE_
+#define MOVEIT_GRASPS__IK_SEED_CACHE_
+
+// Eigen
+#include <Eigen/Geometry>
+#include <eigen_stl_containers/eigen_stl_vector_container.h>
+
+// C++
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace moveit_grasps
+{
+/**
+ * \brief How the IK solver is seeded for each grasp candidate
+ */
+enum IkSeedStrategy
+{
+  SEED_FROM_PREVIOUS_SOLUTION,  // seed from the last solution found by the same thread
+  SEED_FROM_NEAREST_SOLUTION    // seed from the solution of the closest already solved pose, if one is close enough
+};
+
+/**
+ * \brief Stores IK solutions in a spatial hash of their target poses. Lookups only search the neighboring cells,
+ *        so the cost does not grow with the number of solved candidates
+ */
+class IkSeedCache
+{
+public:
+  /**
+   * \brief Constructor
+   * \param max_translation - maximum distance between two poses in meters for a solution to be reused
+   * \param max_rotation - maximum angle between two poses in radians for a solution to be reused
+   */
+  IkSeedCache(double max_translation = 0.02, double max_rotation = 0.35);
+
+  /**
+   * \brief Remove all solutions
+   */
+  void clear();
+
+  /**
+   * \brief Add the IK solution of a pose
+   */
+  void insert(const Eigen::Isometry3d& pose, const std::vector<double>& solution);
+
+  /**
+   * \brief Add a pose without a solution, for using the cache as a set of poses with contains()
+   */
+  void insert(const Eigen::Isometry3d& pose)
+  {
+    insert(pose, std::vector<double>());
+  }
+
+  /**
+   * \brief Find the solution of the closest stored pose within the translation and rotation limits
+   * \return true if a seed was found
+   */
+  bool findNearest(const Eigen::Isometry3d& pose, std::vector<double>& seed) const;
+
+  /**
+   * \brief Check whether a stored pose is within the translation and rotation limits of a pose
+   */
+  bool contains(const Eigen::Isometry3d& pose) const;
+
+  std::size_t size() const;
+
+private:
+  struct Entry
+  {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    Eigen::Vector3d position_;
+    Eigen::Quaterniond orientation_;
+    std::vector<double> solution_;
+  };
+
+  /**
+   * \brief Find the closest stored pose within the limits, mutex_ must be held
+   * \return the entry or nullptr
+   */
+  const Entry* findNearestEntry(const Eigen::Isometry3d& pose) const;
+
+  std::int64_t getCellKey(const Eigen::Vector3i& cell) const;
+  Eigen::Vector3i getCell(const Eigen::Vector3d& position) const;
+
+  double max_translation_;
+  double max_rotation_;
+
+  // Solutions bucketed by a grid with cells of size max_translation_
+  std::unordered_map<std::int64_t, std::vector<Entry, Eigen::aligned_allocator<Entry> > > cells_;
+  std::size_t size_ = 0;
+  mutable std::mutex mutex_;
+};
+
+typedef std::shared_ptr<IkSeedCache> IkSeedCachePtr;
+
+}  // namespace moveit_grasps
+
+#endif
@@ -0,0 +1,149 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Long-lived pool of IK workers, each with its own kinematic solvers and robot state
+*/
+
+#ifndef MOVEIT_GRASPS__IK_WORKER_POOL_
+#define MOVEIT_GRASPS__IK_WORKER_POOL_
+
+// ROS
+#include <rclcpp/rclcpp.hpp>
+
+// MoveIt
+#include <moveit/kinematics_base/kinematics_base.h>
+#include <moveit/robot_model/joint_model_group.h>
+#include <moveit/robot_state/robot_state.h>
+
+// C++
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace moveit_grasps
+{
+/**
+ * \brief Holds the per-worker solvers and robot states used by the grasp filter across calls. Work is distributed
+ *        one task at a time to the OpenMP threads, which stay alive between parallel regions, so a slow IK
+ *        candidate only stalls the worker processing it.
+ *
+ *        A pool may be shared, e.g. by a filter and a planner used from different threads. loadSolvers(),
+ *        setRobotStates() and run() each lock the pool, and a caller that configures the workers and then runs them
+ *        keeps the pool with acquire() so that no other caller changes the solvers or states in between.
+ */
+class IkWorkerPool
+{
+public:
+  typedef std::unique_lock<std::recursive_mutex> Lease;
+
+  /**
+   * \brief Constructor
+   * \param num_workers - number of workers, 0 uses the OpenMP default
+   */
+  explicit IkWorkerPool(std::size_t num_workers = 0);
+
+  /**
+   * \brief Get the number of workers in the pool
+   */
+  std::size_t getNumWorkers() const
+  {
+    return num_workers_;
+  }
+
+  /**
+   * \brief Keep the pool for the calling thread until the returned lease is destroyed. The thread may still call
+   *        the other functions of the pool while holding it
+   */
+  Lease acquire()
+  {
+    return Lease(mutex_);
+  }
+
+  /**
+   * \brief Make sure every worker has a kinematic solver for the arm. Solvers are created once per arm and kept
+   *        for the lifetime of the pool
+   * \return true on success
+   */
+  bool loadSolvers(const moveit::core::JointModelGroup* arm_jmg);
+
+  /**
+   * \brief Get the solver of a worker for an arm. loadSolvers() must have been called for this arm. Not locked, call
+   *        it from within run() or while holding acquire()
+   */
+  const kinematics::KinematicsBaseConstPtr& getSolver(std::size_t worker_id,
+                                                       const moveit::core::JointModelGroup* arm_jmg) const;
+
+  /**
+   * \brief Copy a robot state into the state of the first num_workers workers, reusing the existing allocations
+   */
+  void setRobotStates(const moveit::core::RobotState& robot_state, std::size_t num_workers);
+
+  /**
+   * \brief Get the robot state owned by a worker. Not locked, call it from within run() or while holding acquire()
+   */
+  const moveit::core::RobotStatePtr& getRobotState(std::size_t worker_id) const
+  {
+    return robot_states_[worker_id];
+  }
+
+  /**
+   * \brief Call function(worker_id, task_id) for every task_id in [0, num_tasks), using at most num_workers workers.
+   *        Blocks until all tasks are processed. Only one run() may be active on a pool at a time
+   */
+  void run(std::size_t num_tasks, std::size_t num_workers,
+           const std::function<void(std::size_t worker_id, std::size_t task_id)>& function);
+
+private:
+  rclcpp::Logger LOGGER;
+
+  std::size_t num_workers_;
+
+  // Solvers for every worker, keyed by arm name
+  std::map<std::string, std::vector<kinematics::KinematicsBaseConstPtr> > kin_solvers_;
+
+  // A robot state for every worker
+  std::vector<moveit::core::RobotStatePtr> robot_states_;
+
+  // Serializes the callers of the pool, recursive so that a caller holding acquire() can use the other functions
+  std::recursive_mutex mutex_;
+};
+
+typedef std::shared_ptr<IkWorkerPool> IkWorkerPoolPtr;
+typedef std::shared_ptr<const IkWorkerPool> IkWorkerPoolConstPtr;
+
+}  // namespace moveit_grasps
+
+#endif
@@ -0,0 +1,142 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Precomputed map of the positions an arm can reach, used to reject grasps before running IK
+*/
+
+#ifndef MOVEIT_GRASPS__REACHABILITY_MAP_
+#define MOVEIT_GRASPS__REACHABILITY_MAP_
+
+// ROS
+#include <rclcpp/rclcpp.hpp>
+
+// MoveIt
+#include <moveit/robot_state/robot_state.h>
+
+// C++
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace moveit_grasps
+{
+/**
+ * \brief Voxel grid of the positions of an arm's tip link, expressed in the frame of the arm's IK solver.
+ *        The map is built offline by sampling the arm's joint space and saved to disk. A voxel is marked reachable
+ *        if any sample or any of its neighbors reached it, so the map only rejects poses that are clearly out of
+ *        the workspace and leaves everything else to IK.
+ */
+class ReachabilityMap
+{
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  ReachabilityMap();
+
+  /**
+   * \brief Build the map by sampling random joint positions of the arm
+   * \param robot_state - state used for forward kinematics, its arm joints will be modified
+   * \param arm_jmg - the arm the map is built for
+   * \param tip_link - link whose position is recorded, this should be the link the IK solver solves for
+   * \param ik_frame - base frame of the IK solver
+   * \param resolution - edge length of a voxel in meters
+   * \param num_samples - number of random arm configurations to sample
+   * \return true on success
+   */
+  bool buildFromSamples(moveit::core::RobotState& robot_state, const moveit::core::JointModelGroup* arm_jmg,
+                        const std::string& tip_link, const std::string& ik_frame, double resolution,
+                        std::size_t num_samples);
+
+  /**
+   * \brief Save the map to a binary file
+   * \return true on success
+   */
+  bool saveToFile(const std::string& filename) const;
+
+  /**
+   * \brief Load a map previously written by saveToFile()
+   * \return true on success
+   */
+  bool loadFromFile(const std::string& filename);
+
+  /**
+   * \brief Check whether a position given in the ik frame may be reachable
+   * \return false if the position is certainly not reachable
+   */
+  bool isReachable(const Eigen::Vector3d& position) const;
+
+  const std::string& getGroupName() const
+  {
+    return group_name_;
+  }
+
+  const std::string& getIkFrame() const
+  {
+    return ik_frame_;
+  }
+
+  double getResolution() const
+  {
+    return resolution_;
+  }
+
+private:
+  std::size_t getIndex(int x, int y, int z) const
+  {
+    return (static_cast<std::size_t>(z) * size_[1] + y) * size_[0] + x;
+  }
+
+  rclcpp::Logger LOGGER;
+
+  std::string group_name_;
+  std::string ik_frame_;
+  double resolution_;
+
+  // Position of the lower corner of the first voxel
+  Eigen::Vector3d origin_;
+
+  // Number of voxels along each axis
+  Eigen::Vector3i size_;
+
+  // One entry per voxel, non-zero if reachable
+  std::vector<std::uint8_t> voxels_;
+};
+
+typedef std::shared_ptr<ReachabilityMap> ReachabilityMapPtr;
+typedef std::shared_ptr<const ReachabilityMap> ReachabilityMapConstPtr;
+
+}  // namespace moveit_grasps
+
+#endif
@@ -43,9 +43,16 @@
 #include <moveit_visual_tools/moveit_visual_tools.h>
 
 // MoveIt
+#include <moveit/collision_detection/collision_common.h>
 #include <moveit/planning_scene_monitor/planning_scene_monitor.h>
 #include <moveit/robot_state/robot_state.h>
 
+// Grasping
+#include <moveit_grasps/collision_state_buffer.h>
+
+// C++
+#include <string>
+
 template <typename T>
 auto time_to_ns_duration(T seconds)
 {
@@ -54,40 +61,179 @@ auto time_to_ns_duration(T seconds)
 
 namespace
 {
-bool isGraspStateValid(const planning_scene::PlanningScene* planning_scene, bool visual_debug, double verbose_speed,
-                       const moveit_visual_tools::MoveItVisualToolsPtr& visual_tools,
-                       moveit::core::RobotState* robot_state, const moveit::core::JointModelGroup* group,
-                       const double* ik_solution)
+void publishStateCollision(const planning_scene::PlanningScene* planning_scene, double verbose_speed,
+                           moveit_visual_tools::MoveItVisualTools& visual_tools,
+                           const moveit::core::RobotState& robot_state, const std::string& group_name)
+{
+  visual_tools.publishRobotState(robot_state, rviz_visual_tools::RED);
+  planning_scene->isStateColliding(robot_state, group_name, true);
+  visual_tools.publishContactPoints(robot_state, planning_scene);
+  visual_tools.trigger();
+  rclcpp::sleep_for(time_to_ns_duration(verbose_speed));
+}
+
+/**
+ * \brief Collision report of the headless checks, compiles away
+ */
+struct NoCollisionReport
+{
+  void operator()(const planning_scene::PlanningScene* /*planning_scene*/,
+                  const moveit::core::RobotState& /*robot_state*/, const std::string& /*group_name*/) const
+  {
+  }
+};
+
+/**
+ * \brief Publishes every collision to rviz right away and blocks for verbose_speed_ seconds
+ */
+struct PublishCollisionReport
+{
+  void operator()(const planning_scene::PlanningScene* planning_scene, const moveit::core::RobotState& robot_state,
+                  const std::string& group_name) const
+  {
+    publishStateCollision(planning_scene, verbose_speed_, *visual_tools_, robot_state, group_name);
+  }
+
+  double verbose_speed_;
+  moveit_visual_tools::MoveItVisualTools* visual_tools_;
+};
+
+/**
+ * \brief Stores every collision in a buffer that is published once the IK threads are done
+ */
+struct BufferCollisionReport
+{
+  void operator()(const planning_scene::PlanningScene* planning_scene, const moveit::core::RobotState& robot_state,
+                  const std::string& group_name) const
+  {
+    buffer_->record(planning_scene, robot_state, group_name);
+  }
+
+  moveit_grasps::CollisionStateBuffer* buffer_;
+};
+
+/**
+ * \brief Check only the end effector links against the world, without self collisions. The few end effector links
+ *        are the ones that hit the neighbors of the object in clutter, so this rejects most invalid states cheaply
+ * \return true if the end effector is not in collision with the world
+ */
+bool isEndEffectorWorldCollisionFree(const planning_scene::PlanningScene* planning_scene,
+                                     const moveit::core::RobotState& robot_state,
+                                     const moveit::core::JointModelGroup* ee_jmg)
+{
+  collision_detection::CollisionRequest collision_request;
+  collision_detection::CollisionResult collision_result;
+  collision_request.group_name = ee_jmg->getName();
+  planning_scene->getCollisionEnv()->checkRobotCollision(collision_request, collision_result, robot_state,
+                                                         planning_scene->getAllowedCollisionMatrix());
+  return !collision_result.collision;
+}
+
+/**
+ * \brief Validity callback of the IK solver, the report type decides what happens with a colliding state
+ * \param ee_jmg - if set the end effector is checked against the world first and the full check of the group only
+ *                 runs if it passes, nullptr to only check the group
+ * \return true if the state is within bounds and not in collision
+ */
+template <typename CollisionReport>
+bool checkGraspState(const planning_scene::PlanningScene* planning_scene, const moveit::core::JointModelGroup* ee_jmg,
+                     const CollisionReport& report, moveit::core::RobotState* robot_state,
+                     const moveit::core::JointModelGroup* group, const double* ik_solution)
 {
-  rclcpp::Logger logger_is_grasp_state_valid = rclcpp::get_logger("is_grasp_state_valid");
   robot_state->setJointGroupPositions(group, ik_solution);
   robot_state->update();
   if (!robot_state->satisfiesBounds(group))
   {
-    RCLCPP_DEBUG_STREAM(logger_is_grasp_state_valid, "Ik solution invalid");
+    RCLCPP_DEBUG_STREAM(rclcpp::get_logger("is_grasp_state_valid"), "Ik solution invalid");
     return false;
   }
 
   if (!planning_scene)
   {
-    RCLCPP_ERROR_STREAM(logger_is_grasp_state_valid, "No planning scene provided");
+    RCLCPP_ERROR_STREAM(rclcpp::get_logger("is_grasp_state_valid"), "No planning scene provided");
+    return false;
+  }
+
+  // Broad phase, only the end effector links against the world
+  if (ee_jmg && !isEndEffectorWorldCollisionFree(planning_scene, *robot_state, ee_jmg))
+  {
+    RCLCPP_DEBUG_STREAM(rclcpp::get_logger("is_grasp_state_valid"), "End effector in collision with the world");
+    report(planning_scene, *robot_state, ee_jmg->getName());
     return false;
   }
 
   if (!planning_scene->isStateColliding(*robot_state, group->getName()))
     return true;  // not in collision
 
+  report(planning_scene, *robot_state, group->getName());
+  return false;
+}
+
+/**
+ * \brief Check a state that only differs from an already valid one in the end effector joints, e.g. with the fingers
+ *        closed. Only the collisions of the end effector links can have changed, so the rest of the robot is skipped
+ * \return true if the end effector is not in collision
+ */
+template <typename CollisionReport>
+bool checkEndEffectorState(const planning_scene::PlanningScene* planning_scene, const CollisionReport& report,
+                           moveit::core::RobotState* robot_state, const moveit::core::JointModelGroup* ee_jmg)
+{
+  robot_state->update();
+  if (!planning_scene)
+  {
+    RCLCPP_ERROR_STREAM(rclcpp::get_logger("is_grasp_state_valid"), "No planning scene provided");
+    return false;
+  }
+
+  if (!planning_scene->isStateColliding(*robot_state, ee_jmg->getName()))
+    return true;  // not in collision
+
+  report(planning_scene, *robot_state, ee_jmg->getName());
+  return false;
+}
+
+bool isGraspStateValid(const planning_scene::PlanningScene* planning_scene, bool visual_debug, double verbose_speed,
+                       const moveit_visual_tools::MoveItVisualToolsPtr& visual_tools,
+                       moveit::core::RobotState* robot_state, const moveit::core::JointModelGroup* group,
+                       const double* ik_solution)
+{
   // Display more info about the collision
   if (visual_debug && visual_tools)
   {
-    visual_tools->publishRobotState(*robot_state, rviz_visual_tools::RED);
-    planning_scene->isStateColliding(*robot_state, group->getName(), true);
-    visual_tools->publishContactPoints(*robot_state, planning_scene);
-    visual_tools->trigger();
-    rclcpp::sleep_for(time_to_ns_duration(verbose_speed));
+    return checkGraspState(planning_scene, nullptr, PublishCollisionReport{ verbose_speed, visual_tools.get() },
+                           robot_state, group, ik_solution);
   }
-  return false;
+  return checkGraspState(planning_scene, nullptr, NoCollisionReport(), robot_state, group, ik_solution);
+}
 
+/**
+ * \brief Staged version of isGraspStateValid(). The end effector is checked against the world first and the full
+ *        check of the group only runs if it passes
+ */
+bool isGraspStateValidStaged(const planning_scene::PlanningScene* planning_scene,
+                             const moveit::core::JointModelGroup* ee_jmg, bool visual_debug, double verbose_speed,
+                             const moveit_visual_tools::MoveItVisualToolsPtr& visual_tools,
+                             moveit::core::RobotState* robot_state, const moveit::core::JointModelGroup* group,
+                             const double* ik_solution)
+{
+  if (visual_debug && visual_tools)
+  {
+    return checkGraspState(planning_scene, ee_jmg, PublishCollisionReport{ verbose_speed, visual_tools.get() },
+                           robot_state, group, ik_solution);
+  }
+  return checkGraspState(planning_scene, ee_jmg, NoCollisionReport(), robot_state, group, ik_solution);
+}
+
+bool isEndEffectorStateValid(const planning_scene::PlanningScene* planning_scene, bool visual_debug,
+                             double verbose_speed, const moveit_visual_tools::MoveItVisualToolsPtr& visual_tools,
+                             moveit::core::RobotState* robot_state, const moveit::core::JointModelGroup* ee_jmg)
+{
+  if (visual_debug && visual_tools)
+  {
+    return checkEndEffectorState(planning_scene, PublishCollisionReport{ verbose_speed, visual_tools.get() },
+                                 robot_state, ee_jmg);
+  }
+  return checkEndEffectorState(planning_scene, NoCollisionReport(), robot_state, ee_jmg);
 }
 
 }  // namespace
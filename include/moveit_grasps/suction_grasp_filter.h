@@ -0,0 +1,144 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2015, University of Colorado, Boulder
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Univ of CO, Boulder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Author: Mike Lautman <mike@picknik.ai>
+   Desc:   Filters suction grasps based on kinematic feasibility, collision and suction voxel overlap
+*/
+
+#ifndef MOVEIT_GRASPS__SUCTION_GRASP_FILTER_
+#define MOVEIT_GRASPS__SUCTION_GRASP_FILTER_
+
+// Parent class
+#include <moveit_grasps/grasp_filter.h>
+
+// Grasping
+#include <moveit_grasps/suction_grasp_candidate.h>
+#include <moveit_grasps/suction_grasp_data.h>
+
+namespace moveit_grasps
+{
+struct SuctionGraspFilterCode : public GraspFilterCode
+{
+  enum
+  {
+    GRASP_FILTERED_BY_SUCTION_VOXEL_OVERLAP = LAST + 1,  // No suction voxel overlaps the object enough
+  };
+};
+
+// The candidates that enable the same suction voxels, filtered against one planning scene
+struct SuctionVoxelMaskGroup
+{
+  SuctionGraspDataPtr grasp_data_;
+  std::vector<GraspCandidatePtr> grasp_candidates_;
+  double best_score_ = 0;
+};
+
+class SuctionGraspFilter : public GraspFilter
+{
+public:
+  /**
+   * \brief Constructor
+   */
+  SuctionGraspFilter(rclcpp::Node::SharedPtr node, const moveit::core::RobotStatePtr& robot_state,
+                     const moveit_visual_tools::MoveItVisualToolsPtr& visual_tools);
+
+  using GraspFilter::filterGraspsHelper;
+
+  /**
+   * \brief Return grasps that are kinematically feasible and overlap the object with at least one suction voxel.
+   *        Candidates are filtered in groups that enable the same suction voxels, each against one planning scene
+   *        with those voxels attached, so the scene is not modified per candidate
+   * \return number of grasps remaining
+   */
+  std::size_t filterGraspsHelper(std::vector<GraspCandidatePtr>& grasp_candidates,
+                                 const planning_scene::PlanningScenePtr& planning_scene,
+                                 const moveit::core::JointModelGroup* arm_jmg,
+                                 const moveit::core::RobotStatePtr& seed_state, bool filter_pregrasp, bool visualize,
+                                 const std::string& target_object_id = "") override;
+
+  /**
+   * \brief Mark grasps where no suction voxel overlaps the object by at least the cutoff
+   * \return number of grasps remaining
+   */
+  std::size_t filterGraspsBySuctionVoxelOverlap(std::vector<GraspCandidatePtr>& grasp_candidates);
+
+  /**
+   * \brief Print grasp filtering statistics
+   */
+  void printFilterStatistics(const std::vector<GraspCandidatePtr>& grasp_candidates) const override;
+
+  /**
+   * \brief Set the minimum fraction of a suction voxel that must be over the object for the voxel to be used
+   */
+  void setSuctionVoxelOverlapCutoff(double cutoff);
+
+protected:
+  /**
+   * \brief The planning scene id of the collision object for a suction voxel
+   */
+  static std::string suctionVoxelIxToCollisionObjectId(std::size_t voxel_ix);
+
+  /**
+   * \brief Filter the grasps of several objects. The voxel mask scenes depend on the candidates, so every object is
+   *        filtered on its own with filterGraspsHelper()
+   * \return number of grasps remaining
+   */
+  std::size_t filterObjectGraspsHelper(std::vector<ObjectGraspCandidates>& object_grasp_candidates,
+                                       const planning_scene::PlanningScenePtr& planning_scene,
+                                       const moveit::core::JointModelGroup* arm_jmg,
+                                       const moveit::core::RobotStatePtr& seed_state, bool filter_pregrasp,
+                                       bool visualize) override;
+
+  /**
+   * \brief Attach a collision object to the tcp for each enabled suction voxel, and remove the disabled ones
+   * \param collision_object_names - output, the collision object id of every voxel
+   * \return true on success
+   */
+  bool attachActiveSuctionCupCO(const SuctionGraspDataPtr& grasp_data, const std::vector<bool>& suction_voxel_enabled,
+                                const planning_scene::PlanningScenePtr& planning_scene,
+                                std::vector<std::string>& collision_object_names);
+
+  // logging name
+  rclcpp::Logger LOGGER_SUCTION;
+
+  double suction_voxel_overlap_cutoff_;
+
+};  // end of class
+
+typedef std::shared_ptr<SuctionGraspFilter> SuctionGraspFilterPtr;
+typedef std::shared_ptr<const SuctionGraspFilter> SuctionGraspFilterConstPtr;
+
+}  // namespace moveit_grasps
+
+#endif
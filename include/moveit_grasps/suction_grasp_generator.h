@@ -0,0 +1,144 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2015, University of Colorado, Boulder
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Univ of CO, Boulder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Author: Dave Coleman <dave@picknik.ai>, Andy McEvoy
+   Desc:   Generates geometric grasps for cuboids and blocks, not using physics or contact wrenches
+*/
+
+#ifndef MOVEIT_GRASPS__SUCTION_GRASP_GENERATOR_H_
+#define MOVEIT_GRASPS__SUCTION_GRASP_GENERATOR_H_
+
+#include <moveit_grasps/grasp_candidate.h>
+#include <moveit_grasps/grasp_generator.h>
+#include <moveit_grasps/suction_grasp_data.h>
+#include <moveit_grasps/suction_grasp_scorer.h>
+
+namespace moveit_grasps
+{
+class SuctionGraspGenerator : public GraspGenerator
+{
+public:
+  // Eigen requires 128-bit alignment for the Eigen::Vector2d's array (of 2 doubles).
+  // With GCC, this is done with a attribute ((aligned(16))).
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * \brief Constructor
+   */
+  SuctionGraspGenerator(rclcpp::Node::SharedPtr node, const moveit_visual_tools::MoveItVisualToolsPtr& visual_tools,
+                        bool verbose = false);
+
+  /**
+   * \brief Create possible grasp positions around a cuboid
+   * \param cuboid_pose - centroid of object to grasp in world frame
+   * \param depth length of cuboid along local x-axis
+   * \param width length of cuboid along local y-axis
+   * \param height length of cuboid along local z-axis
+   * \param grasp_data data describing end effector
+   * \param grasp_candidates possible grasps generated
+   * \return true if successful
+   */
+  bool generateGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width, double height,
+                      const GraspDataPtr& grasp_data, std::vector<GraspCandidatePtr>& grasp_candidates) override;
+
+  bool generateGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width, double height,
+                      const SuctionGraspDataPtr& grasp_data, std::vector<GraspCandidatePtr>& grasp_candidates);
+
+  /**
+   * \brief Setter for grasp score weights
+   */
+  void setGraspScoreWeights(const SuctionGraspScoreWeightsPtr& grasp_score_weights)
+  {
+    auto suction_grasp_score_weights = std::make_shared<SuctionGraspScoreWeights>(*grasp_score_weights);
+    grasp_score_weights_ = std::dynamic_pointer_cast<GraspScoreWeights>(suction_grasp_score_weights);
+  }
+
+  /**
+   * \brief Getter for grasp score weights
+   */
+  const SuctionGraspScoreWeightsPtr getGraspScoreWeights()
+  {
+    return std::dynamic_pointer_cast<SuctionGraspScoreWeights>(grasp_score_weights_);
+  }
+
+protected:
+  /**
+   * \brief Create grasp positions over the top face of a cuboid, swept along x, y, depth and yaw
+   * \return true if successful
+   */
+  bool generateSuctionGrasps(const Eigen::Isometry3d& cuboid_top_pose, double depth, double width, double height,
+                             const SuctionGraspDataPtr& grasp_data, std::vector<GraspCandidatePtr>& grasp_candidates);
+
+  /**
+   * \brief Flip the cuboid pose so that its z and x axes point the same way as the ideal tcp grasp pose
+   */
+  void orientCuboidTowardsIdealTCP(Eigen::Isometry3d& cuboid_pose, double depth, double width, double height);
+
+  /**
+   * \brief creates a grasp message from a generated grasp pose, scores it and adds it to grasp_candidates
+   * \param grasp_pose_eef_mount - the grasp pose. (Note: this is the pose of the eef mount not the position of the tcp)
+   * \param grasp_data data describing the end effector
+   * \param object_pose - the pose of the top face of the object being grasped
+   * \param object_size - the size of the object being grasped
+   * \param grasp_candidates - list possible grasps with new grasp appended
+   * \param stamp - header stamp of the grasp, shared by all grasps of one generation
+   * \param grasp_id - id of the grasp, see reserveGraspIds()
+   * \return true on success
+   */
+  bool addGrasp(const Eigen::Isometry3d& grasp_pose_eef_mount, const SuctionGraspDataPtr& grasp_data,
+                const Eigen::Isometry3d& object_pose, const Eigen::Vector3d& object_size,
+                std::vector<GraspCandidatePtr>& grasp_candidates, const rclcpp::Time& stamp, std::size_t grasp_id);
+
+  /**
+   * \brief Score a grasp on its orientation, translation and suction voxel overlap
+   * \param suction_voxel_overlap - output, the overlap of each suction voxel with the object
+   * \return the weighted score
+   */
+  double scoreSuctionGrasp(const Eigen::Isometry3d& grasp_pose_tcp, const SuctionGraspDataPtr& grasp_data,
+                           const Eigen::Isometry3d& cuboid_pose, const Eigen::Vector3d& object_size,
+                           std::vector<double>& suction_voxel_overlap);
+
+  // Visual debug settings
+  bool debug_top_grasps_;
+  bool show_grasp_overhang_;
+
+  rclcpp::Node::SharedPtr node_;
+};  // end of class
+
+typedef std::shared_ptr<SuctionGraspGenerator> SuctionGraspGeneratorPtr;
+typedef std::shared_ptr<const SuctionGraspGenerator> SuctionGraspGeneratorConstPtr;
+
+}  // namespace moveit_grasps
+
+#endif
@@ -43,6 +43,9 @@
 // ROS
 #include <rclcpp/rclcpp.hpp>
 
+// C++
+#include <vector>
+
 // Eigen
 #include <Eigen/Core>
 #include <Eigen/Geometry>
@@ -90,23 +93,29 @@ public:
   {
     voxel_x_width_ = active_suction_range_x_ / suction_cols_count_;
     voxel_y_width_ = active_suction_range_y_ / suction_rows_count_;
-    suction_voxels_.resize(suction_rows_count_);
+    suction_voxels_.reserve(suction_rows_count_ * suction_cols_count_);
+    voxel_corners_.resize(3, 4 * suction_rows_count_ * suction_cols_count_);
     // We store the voxels starting bottom left and moving right then up
     for (std::size_t voxel_y = 0; voxel_y < suction_rows_count_; ++voxel_y)
     {
-      suction_voxels_[voxel_y].resize(suction_cols_count_);
       for (std::size_t voxel_x = 0; voxel_x < suction_cols_count_; ++voxel_x)
       {
-        suction_voxels_[voxel_y][voxel_x] = std::make_shared<SuctionVoxel>(
+        suction_voxels_.emplace_back(
             Eigen::Vector3d(-active_suction_range_x_ / 2.0 + voxel_x_width_ * (voxel_x + 0.5),
                             -active_suction_range_y_ / 2.0 + voxel_y_width_ * (voxel_y + 0.5), 0),
             voxel_x_width_, voxel_y_width_);
+        const SuctionVoxel& voxel = suction_voxels_.back();
+        const std::size_t column = 4 * (suction_voxels_.size() - 1);
+        voxel_corners_.col(column) = voxel.bottom_left_;
+        voxel_corners_.col(column + 1) = voxel.top_left_;
+        voxel_corners_.col(column + 2) = voxel.top_right_;
+        voxel_corners_.col(column + 3) = voxel.bottom_right_;
       }
     }
   }
 
   // \brief - get the voxel at the index location [row, col] with [0, 0] being the bottom left
-  bool getSuctionVoxel(std::size_t row, std::size_t col, std::shared_ptr<SuctionVoxel>& voxel)
+  bool getSuctionVoxel(std::size_t row, std::size_t col, const SuctionVoxel*& voxel) const
   {
     if (row >= suction_rows_count_)
     {
@@ -120,7 +129,7 @@ public:
       return false;
     }
 
-    voxel = suction_voxels_[row][col];
+    voxel = &suction_voxels_[row * suction_cols_count_ + col];
     return true;
   }
 
@@ -128,47 +137,61 @@ public:
    *  @param index - the index of the suction voxel where index / #cols is the row and index % #cols is the col
    *                 index 0 is bottom left
    */
-  bool getSuctionVoxel(std::size_t index, std::shared_ptr<SuctionVoxel>& voxel)
+  bool getSuctionVoxel(std::size_t index, const SuctionVoxel*& voxel) const
   {
     return getSuctionVoxel(index / suction_cols_count_, index % suction_cols_count_, voxel);
   }
 
-  std::size_t getNumRows()
+  /** \brief All voxels in one contiguous array, in the same index order as getSuctionVoxel(index) */
+  const std::vector<SuctionVoxel>& getSuctionVoxels() const
+  {
+    return suction_voxels_;
+  }
+
+  /** \brief The corners of every voxel in the tcp frame, four columns per voxel in index order.
+   *         Each voxel's columns are bottom_left, top_left, top_right, bottom_right
+   */
+  const Eigen::Matrix3Xd& getVoxelCorners() const
+  {
+    return voxel_corners_;
+  }
+
+  std::size_t getNumRows() const
   {
     return suction_rows_count_;
   }
 
-  std::size_t getNumCols()
+  std::size_t getNumCols() const
   {
     return suction_cols_count_;
   }
 
-  std::size_t getNumVoxels()
+  std::size_t getNumVoxels() const
   {
     return suction_cols_count_ * suction_rows_count_;
   }
 
-  double getVoxelArea()
+  double getVoxelArea() const
   {
     return voxel_x_width_ * voxel_y_width_;
   }
 
-  double getVoxelWidthX()
+  double getVoxelWidthX() const
   {
     return voxel_x_width_;
   }
 
-  double getVoxelWidthY()
+  double getVoxelWidthY() const
   {
     return voxel_y_width_;
   }
 
-  double getActiveSuctionWidthX()
+  double getActiveSuctionWidthX() const
   {
     return active_suction_range_x_;
   }
 
-  double getActiveSuctionWidthY()
+  double getActiveSuctionWidthY() const
   {
     return active_suction_range_y_;
   }
@@ -180,7 +203,8 @@ protected:
   double voxel_y_width_;
   double active_suction_range_x_;
   double active_suction_range_y_;
-  std::vector<std::vector<std::shared_ptr<SuctionVoxel>>> suction_voxels_;
+  std::vector<SuctionVoxel> suction_voxels_;
+  Eigen::Matrix3Xd voxel_corners_;
 
 private:
 rclcpp::Logger LOGGER = rclcpp::get_logger("suction_voxel_matrix");
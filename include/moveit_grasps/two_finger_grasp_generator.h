@@ -41,15 +41,23 @@
 #define MOVEIT_GRASPS__TWO_FINGER_GRASP_GENERATOR_H_
 
 #include <moveit_grasps/grasp_candidate.h>
+#include <moveit_grasps/grasp_candidate_batch.h>
 #include <moveit_grasps/grasp_generator.h>
 #include <moveit_grasps/two_finger_grasp_data.h>
 #include <moveit_grasps/two_finger_grasp_scorer.h>
 
+#include <array>
+#include <map>
+#include <tuple>
+
 // Testing
 #include <gtest/gtest.h>
 
 namespace moveit_grasps
 {
+// Marks the infeasible grasps of a list, e.g. by binding GraspFilter::filterGrasps()
+typedef std::function<void(std::vector<GraspCandidatePtr>& grasp_candidates)> GraspCandidatesFilterFn;
+
 struct TwoFingerGraspCandidateConfig
 {
   TwoFingerGraspCandidateConfig();
@@ -72,6 +80,23 @@ struct TwoFingerGraspCandidateConfig
   bool generate_z_axis_grasps_;
 };
 
+/**
+ * \brief The grasp poses of all axes of one object size in the object frame. They only depend on the grasp data, the
+ *        candidate config and the object size, so they are generated once and moved with the cuboid pose
+ */
+struct TwoFingerGraspTemplate
+{
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  // Detects a grasp data that was destroyed and whose address was reused
+  std::weak_ptr<TwoFingerGraspData> grasp_data_;
+  std::array<EigenSTL::vector_Isometry3d, 3> axis_grasp_poses_tcp_;
+  std::array<double, 3> object_widths_;
+  // The distance to the object does not change with the cuboid pose
+  std::array<Eigen::VectorXd, 3> distance_scores_;
+};
+typedef std::shared_ptr<TwoFingerGraspTemplate> TwoFingerGraspTemplatePtr;
+
 class TwoFingerGraspGenerator : public GraspGenerator
 {
 public:
@@ -108,6 +133,79 @@ public:
   bool generateGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width, double height,
                       const TwoFingerGraspDataPtr& grasp_data, std::vector<GraspCandidatePtr>& grasp_candidates);
 
+  /**
+   * \brief Create possible grasp positions around a cuboid into a compact batch, sorted by descending score.
+   *        Use GraspCandidateBatch::getGraspCandidates() to build GraspCandidates for the grasps that are needed
+   */
+  bool generateGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width, double height,
+                      const TwoFingerGraspDataPtr& grasp_data, GraspCandidateBatch& grasp_candidate_batch);
+
+  /**
+   * \brief Create possible grasp positions around a cuboid and pass them to a callback in chunks, one axis at a
+   *        time. The axes are ordered by their best score at 4 times the resolutions of grasp_data and each axis is
+   *        passed best score first, so the first chunk arrives after one axis was generated. A later axis can still
+   *        hold better grasps than an earlier one. GraspCandidates are only built for the chunks that are requested
+   */
+  bool streamGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width, double height,
+                    const GraspDataPtr& grasp_data, const GraspCandidatesCallback& callback,
+                    std::size_t chunk_size = 100) override;
+
+  /**
+   * \brief Create grasps coarse to fine. The first level samples with the resolutions of grasp_data multiplied by
+   *        2^(num_levels - 1) and filters all of them. Every following level halves the resolutions and only filters
+   *        the grasps within one resolution step of a valid grasp of the previous level, down to the resolutions of
+   *        grasp_data. Poses that were already filtered on a coarser level are not filtered or returned again
+   * \param filter - marks the infeasible grasps of each level
+   * \param grasp_candidates - output, the valid grasps of all levels, best score first
+   * \param num_levels - number of resolutions, 1 filters every grasp at the resolution of grasp_data
+   * \param max_filtered_grasps - stop once this many grasps were passed to the filter, best score first within a
+   *        level, 0 for no limit
+   * \return true if a valid grasp was found
+   */
+  bool generateGraspsAdaptive(const Eigen::Isometry3d& cuboid_pose, double depth, double width, double height,
+                              const TwoFingerGraspDataPtr& grasp_data, const GraspCandidatesFilterFn& filter,
+                              std::vector<GraspCandidatePtr>& grasp_candidates, std::size_t num_levels = 3,
+                              std::size_t max_filtered_grasps = 0);
+
+  /**
+   * \brief Generate the axes, grasp poses and scores on all OpenMP threads. The grasps are the same and in the same
+   *        order as with serial generation
+   */
+  void setParallelGeneration(bool parallel_generation)
+  {
+    parallel_generation_ = parallel_generation;
+  }
+
+  /**
+   * \brief Cache the object frame grasp poses per grasp data and object size. Repeated requests for the same size
+   *        only transform the cached poses to the cuboid pose and recompute the pose dependent scores. Grasp data
+   *        that is modified in place needs clearGraspTemplates(). The templates of destroyed grasp data are dropped
+   *        when the next template is created
+   * \param size_resolution - objects whose sizes round to the same multiple of this share a template, which is
+   *        generated for the size of the first of them
+   */
+  void setUseGraspTemplates(bool use_grasp_templates, double size_resolution = 0.001)
+  {
+    use_grasp_templates_ = use_grasp_templates;
+    grasp_template_size_resolution_ = size_resolution;
+    clearGraspTemplates();
+  }
+
+  bool getUseGraspTemplates() const
+  {
+    return use_grasp_templates_;
+  }
+
+  void clearGraspTemplates()
+  {
+    grasp_templates_.clear();
+  }
+
+  std::size_t getNumGraspTemplates() const
+  {
+    return grasp_templates_.size();
+  }
+
   /**
    * \brief Setter for grasp score weights
    */
@@ -140,6 +238,20 @@ protected:
                 const Eigen::Isometry3d& object_pose, const Eigen::Vector3d& object_size, double object_width,
                 std::vector<GraspCandidatePtr>& grasp_candidates);
 
+  /**
+   * \brief adds the grasps for the generated grasp poses to a batch, one per finger opening
+   * \param grasp_poses_tcp - the grasp poses of the tcp
+   * \param grasp_data - data describing the end effector
+   * \param object_pose - pose of object to grasp
+   * \param object_width - the width of the object in the dimension betwen the fingers
+   * \param grasp_candidate_batch - the batch the grasps are appended to
+   * \param distance_scores - precomputed distance scores of the poses, nullptr to compute them
+   * \return the number of poses that were added with all finger openings
+   */
+  std::size_t addGrasps(const EigenSTL::vector_Isometry3d& grasp_poses_tcp, const TwoFingerGraspDataPtr& grasp_data,
+                        const Eigen::Isometry3d& object_pose, double object_width,
+                        GraspCandidateBatch& grasp_candidate_batch, const Eigen::VectorXd* distance_scores = nullptr);
+
   /**
    * \brief Create grasp positions around one axis of a cuboid
    * \param cuboid_pose:      centroid of object to grasp in world frame
@@ -157,6 +269,55 @@ protected:
                                 const TwoFingerGraspCandidateConfig& grasp_candidate_config,
                                 std::vector<GraspCandidatePtr>& grasp_candidates);
 
+  bool generateCuboidAxisGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width, double height,
+                                grasp_axis_t axis, const TwoFingerGraspDataPtr& grasp_data,
+                                const TwoFingerGraspCandidateConfig& grasp_candidate_config,
+                                GraspCandidateBatch& grasp_candidate_batch);
+
+  /**
+   * \brief Create the tcp grasp poses around one axis of a cuboid. Does not modify any member, so several axes can
+   *        be generated at the same time
+   * \param grasp_poses_tcp: the generated poses
+   * \param object_width: the width of the object between the fingers for this axis
+   * \return true if successful
+   */
+  bool generateCuboidAxisGraspPoses(const Eigen::Isometry3d& cuboid_pose, double depth, double width, double height,
+                                    grasp_axis_t axis, const TwoFingerGraspDataPtr& grasp_data,
+                                    const TwoFingerGraspCandidateConfig& grasp_candidate_config,
+                                    EigenSTL::vector_Isometry3d& grasp_poses_tcp, double& object_width);
+
+  /**
+   * \brief Score the grasp poses of one axis and add them to a batch
+   */
+  void addCuboidAxisGrasps(const Eigen::Isometry3d& cuboid_pose, const EigenSTL::vector_Isometry3d& grasp_poses_tcp,
+                           const TwoFingerGraspDataPtr& grasp_data, double object_width,
+                           GraspCandidateBatch& grasp_candidate_batch,
+                           const Eigen::VectorXd* distance_scores = nullptr);
+
+  /**
+   * \brief Create the tcp grasp poses of all enabled axes, the axes are generated in parallel
+   */
+  void generateAxesGraspPoses(const Eigen::Isometry3d& cuboid_pose, double depth, double width, double height,
+                              const TwoFingerGraspDataPtr& grasp_data, const std::array<bool, 3>& generate_axis,
+                              const std::array<TwoFingerGraspCandidateConfig, 3>& axis_configs,
+                              std::array<EigenSTL::vector_Isometry3d, 3>& axis_grasp_poses_tcp,
+                              std::array<double, 3>& object_widths);
+
+  /**
+   * \brief Get the cached template for an object size, generating it in the object frame on the first request
+   */
+  TwoFingerGraspTemplatePtr getGraspTemplate(double depth, double width, double height,
+                                             const TwoFingerGraspDataPtr& grasp_data,
+                                             const TwoFingerGraspCandidateConfig& grasp_candidate_config,
+                                             const std::array<bool, 3>& generate_axis,
+                                             const std::array<TwoFingerGraspCandidateConfig, 3>& axis_configs);
+
+  /**
+   * \brief Compute the min/max grasp distance and translation statistics used for scoring grasp poses
+   */
+  void computeGraspPoseStatistics(const Eigen::Isometry3d& cuboid_pose,
+                                  const EigenSTL::vector_Isometry3d& grasp_poses_tcp);
+
   /**
    * \brief helper function for adding grasps at corner of cuboid
    * \param pose - pose of the object to grasp
@@ -203,6 +364,19 @@ protected:
                                   double alignment_rotation, std::size_t num_grasps,
                                   EigenSTL::vector_Isometry3d& grasp_poses_tcp, double corner_rotation);
 
+  /**
+   * \brief helper function for adding grasps tilted around a grasp pose for as long as they intersect the cuboid
+   * \param base_pose - the grasp pose to tilt
+   * \param angle_res - the angle between two tilted grasps
+   * \param max_iterations - max number of grasps in each direction
+   * \param grasp_poses_tcp - where the poses are written to, nullptr to only count them
+   * \return the number of poses generated
+   */
+  std::size_t addVariableAngleGraspsHelper(const Eigen::Isometry3d& cuboid_pose, double depth, double width,
+                                           double height, const Eigen::Isometry3d& base_pose,
+                                           const TwoFingerGraspDataPtr& grasp_data, double angle_res,
+                                           std::size_t max_iterations, Eigen::Isometry3d* grasp_poses_tcp);
+
   /**
    * \brief helper function for determining if the grasp will intersect the
    * cuboid \param cuboid_pose - centroid of object to grasp in world frame
@@ -238,14 +412,37 @@ protected:
    */
   double scoreFingerGrasp(const Eigen::Isometry3d& grasp_pose_tcp, const TwoFingerGraspDataPtr& grasp_data,
                           const Eigen::Isometry3d& object_pose, double percent_open);
+
+  /**
+   * \brief Score many finger grasp poses at once with the batch scoring functions
+   * \param grasp_poses_tcp - the grasp poses of the tcp
+   * \param percent_opens - the finger openings each pose is scored for
+   * \param scores - one vector of scores per finger opening, one score per pose
+   * \param distance_scores - precomputed distance scores of the poses, nullptr to compute them
+   */
+  void scoreFingerGrasps(const EigenSTL::vector_Isometry3d& grasp_poses_tcp, const TwoFingerGraspDataPtr& grasp_data,
+                         const Eigen::Isometry3d& object_pose, const std::vector<double>& percent_opens,
+                         std::vector<Eigen::VectorXd>& scores, const Eigen::VectorXd* distance_scores = nullptr);
   bool
   generateFingerGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width, double height,
                        const TwoFingerGraspDataPtr& grasp_data, std::vector<GraspCandidatePtr>& grasp_candidates,
                        const TwoFingerGraspCandidateConfig& grasp_candidate_config = TwoFingerGraspCandidateConfig());
+  bool
+  generateFingerGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width, double height,
+                       const TwoFingerGraspDataPtr& grasp_data, GraspCandidateBatch& grasp_candidate_batch,
+                       const TwoFingerGraspCandidateConfig& grasp_candidate_config = TwoFingerGraspCandidateConfig());
 
 protected:
   TwoFingerGraspCandidateConfig grasp_candidate_config_;
 
+  bool parallel_generation_ = false;
+
+  // Grasp templates keyed by grasp data, object size in multiples of the resolution and candidate config
+  typedef std::tuple<const TwoFingerGraspData*, long, long, long, unsigned int> GraspTemplateKey;
+  bool use_grasp_templates_ = false;
+  double grasp_template_size_resolution_ = 0.001;
+  std::map<GraspTemplateKey, TwoFingerGraspTemplatePtr> grasp_templates_;
+
   // Tests
   FRIEND_TEST(TwoFingerGraspGeneratorTest, GenerateFaceGrasps);
   FRIEND_TEST(TwoFingerGraspGeneratorTest, GenerateEdgeGrasps);
@@ -54,6 +54,11 @@ struct TwoFingerGraspScoreWeights : public GraspScoreWeights
   double computeScore(const Eigen::Vector3d& orientation_scores, const Eigen::Vector3d& translation_scores,
                       double depth_score, double width_score, bool verbose = false) const;
 
+  /* \brief Compute the weighted scores of many grasps, one column or element per grasp */
+  void computeScores(const Eigen::Matrix3Xd& orientation_scores, const Eigen::Matrix3Xd& translation_scores,
+                     const Eigen::VectorXd& depth_scores, const Eigen::VectorXd& width_scores,
+                     Eigen::VectorXd& scores) const;
+
   /* \brief returns the sum of the grasp score weights*/
   double getWeightTotal() const override;
 
@@ -97,6 +102,14 @@ public:
   static double scoreDistanceToPalm(const Eigen::Isometry3d& grasp_pose_tcp, const TwoFingerGraspDataPtr& grasp_data,
                                     const Eigen::Isometry3d& object_pose, double min_grasp_distance,
                                     double max_grasp_distance);
+
+  /**
+   * \brief Batch version of scoreDistanceToPalm(), warns once if any object is beyond the max_grasp_distance
+   * \param scores - one unweighted score per grasp pose
+   */
+  static void scoreDistanceToPalm(const EigenSTL::vector_Isometry3d& grasp_poses_tcp,
+                                  const TwoFingerGraspDataPtr& grasp_data, const Eigen::Isometry3d& object_pose,
+                                  double min_grasp_distance, double max_grasp_distance, Eigen::VectorXd& scores);
 };
 
 }  // namespace moveit_grasps
@@ -0,0 +1,83 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Area of the overlap of rotated suction voxels with an axis aligned box, only depends on Eigen
+*/
+
+#ifndef MOVEIT_GRASPS__VOXEL_BOX_OVERLAP_
+#define MOVEIT_GRASPS__VOXEL_BOX_OVERLAP_
+
+// Eigen
+#include <Eigen/Core>
+
+// C++
+#include <cstddef>
+#include <vector>
+
+namespace moveit_grasps
+{
+/**
+ * \brief Exact area of the intersection of a convex quadrilateral with an axis aligned box.
+ *        Clips the quadrilateral against the four box edges on the stack, so it does not allocate.
+ * \param corners - the xy coordinates of the quadrilateral's corners in winding order, one per column
+ * \param box_min - the minimum xy corner of the box
+ * \param box_max - the maximum xy corner of the box
+ * \return the area of the intersection
+ */
+double computeVoxelBoxOverlap(const Eigen::Matrix<double, 2, 4>& corners, const Eigen::Vector2d& box_min,
+                              const Eigen::Vector2d& box_max);
+
+/**
+ * \brief Batch version of computeVoxelBoxOverlap()
+ * \param corners - four columns per voxel, in the same winding order as computeVoxelBoxOverlap()
+ * \param voxel_area - each overlap is divided by this area
+ * \param overlaps - one normalized overlap per voxel
+ */
+void computeVoxelBoxOverlaps(const Eigen::Matrix2Xd& corners, const Eigen::Vector2d& box_min,
+                             const Eigen::Vector2d& box_max, double voxel_area, std::vector<double>& overlaps);
+
+/**
+ * \brief Estimate of the intersection area that slices the quadrilateral into horizontal strips.
+ *        This is what SuctionGraspScorer::scoreSuctionVoxelOverlap() used before computeVoxelBoxOverlap(), kept for
+ *        comparison.
+ * \param corners - the xy coordinates of a rectangle's corners in winding order, one per column
+ * \param slices - the number of strips
+ * \return the estimated area of the intersection
+ */
+double computeVoxelBoxOverlapSliced(const Eigen::Matrix<double, 2, 4>& corners, const Eigen::Vector2d& box_min,
+                                    const Eigen::Vector2d& box_max, std::size_t slices = 10);
+
+}  // namespace moveit_grasps
+
+#endif
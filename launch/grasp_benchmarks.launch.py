@@ -0,0 +1,105 @@
+import os
+import yaml
+from launch import LaunchDescription
+from launch.actions import DeclareLaunchArgument
+from launch.substitutions import LaunchConfiguration
+from launch_ros.actions import Node
+from ament_index_python.packages import get_package_share_directory
+
+
+def load_file(package_name, file_path):
+    package_path = get_package_share_directory(package_name)
+    absolute_file_path = os.path.join(package_path, file_path)
+
+    try:
+        with open(absolute_file_path, "r") as file:
+            return file.read()
+    except EnvironmentError:  # parent of IOError, OSError *and* WindowsError where available
+        return None
+
+
+def load_yaml(package_name, file_path):
+    package_path = get_package_share_directory(package_name)
+    absolute_file_path = os.path.join(package_path, file_path)
+
+    try:
+        with open(absolute_file_path, "r") as file:
+            return yaml.safe_load(file)
+    except EnvironmentError:  # parent of IOError, OSError *and* WindowsError where available
+        return None
+
+
+def generate_launch_description():
+    # planning_context
+    robot_description_config = load_file(
+        "moveit_resources_panda_description", "urdf/panda.urdf"
+    )
+    robot_description = {"robot_description": robot_description_config}
+
+    robot_description_semantic_config = load_file(
+        "moveit_resources_panda_moveit_config", "config/panda.srdf"
+    )
+    robot_description_semantic = {
+        "robot_description_semantic": robot_description_semantic_config
+    }
+
+    kinematics_yaml = load_yaml(
+        "moveit_resources_panda_moveit_config", "config/kinematics.yaml"
+    )
+
+    ee_group_name = {"ee_group_name": "hand"}
+    planning_group_name = {"planning_group_name": "panda_arm"}
+    panda_grasp_data_yaml = load_yaml(
+        "moveit_grasps", "config_robot/panda_grasp_data.yaml"
+    )
+    moveit_grasps_config_yaml = load_yaml(
+        "moveit_grasps", "config/moveit_grasps_config.yaml"
+    )
+
+    # Disable everything that visualizes or serializes the filtering so only the computation is timed
+    benchmark_overrides = {
+        "moveit_grasps": {
+            "generator": {
+                "verbose": False,
+                "show_prefiltered_grasps": False,
+                "debug_top_grasps": False,
+                "show_grasp_overhang": False,
+            },
+            "filter": {
+                "collision_verbose": False,
+                "show_cutting_planes": False,
+                "show_grasp_filter_collision_if_failed": False,
+                "show_filtered_grasps": False,
+                "show_filtered_arm_solutions": False,
+            },
+        }
+    }
+
+    # Results are written as JSON so they can be compared across versions
+    benchmark_out = DeclareLaunchArgument(
+        "benchmark_out", default_value="grasp_benchmarks.json"
+    )
+
+    # Grasp benchmarks executable
+    grasp_benchmarks = Node(
+        name="grasp_benchmarks",
+        package="moveit_grasps",
+        executable="moveit_grasps_benchmarks",
+        output="screen",
+        arguments=[
+            ["--benchmark_out=", LaunchConfiguration("benchmark_out")],
+            "--benchmark_out_format=json",
+        ],
+        parameters=[
+            robot_description,
+            robot_description_semantic,
+            kinematics_yaml,
+            ee_group_name,
+            planning_group_name,
+            panda_grasp_data_yaml,
+            moveit_grasps_config_yaml,
+            benchmark_overrides,
+        ],
+    )
+
+    return LaunchDescription([benchmark_out, grasp_benchmarks])
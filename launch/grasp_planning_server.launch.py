@@ -0,0 +1,86 @@
+import os
+import yaml
+from launch import LaunchDescription
+from launch_ros.actions import ComposableNodeContainer
+from launch_ros.descriptions import ComposableNode
+from ament_index_python.packages import get_package_share_directory
+
+
+def load_file(package_name, file_path):
+    package_path = get_package_share_directory(package_name)
+    absolute_file_path = os.path.join(package_path, file_path)
+
+    try:
+        with open(absolute_file_path, "r") as file:
+            return file.read()
+    except EnvironmentError:  # parent of IOError, OSError *and* WindowsError where available
+        return None
+
+
+def load_yaml(package_name, file_path):
+    package_path = get_package_share_directory(package_name)
+    absolute_file_path = os.path.join(package_path, file_path)
+
+    try:
+        with open(absolute_file_path, "r") as file:
+            return yaml.safe_load(file)
+    except EnvironmentError:  # parent of IOError, OSError *and* WindowsError where available
+        return None
+
+
+def generate_launch_description():
+    # planning_context
+    robot_description_config = load_file(
+        "moveit_resources_panda_description", "urdf/panda.urdf"
+    )
+    robot_description = {"robot_description": robot_description_config}
+
+    robot_description_semantic_config = load_file(
+        "moveit_resources_panda_moveit_config", "config/panda.srdf"
+    )
+    robot_description_semantic = {
+        "robot_description_semantic": robot_description_semantic_config
+    }
+
+    kinematics_yaml = load_yaml(
+        "moveit_resources_panda_moveit_config", "config/kinematics.yaml"
+    )
+
+    ee_group_name = {"ee_group_name": "hand"}
+    planning_group_name = {"planning_group_name": "panda_arm"}
+    max_planned_grasps = {"grasp_planning_server.max_planned_grasps": 10}
+    panda_grasp_data_yaml = load_yaml(
+        "moveit_grasps", "config_robot/panda_grasp_data.yaml"
+    )
+    moveit_grasps_config_yaml = load_yaml(
+        "moveit_grasps", "config/moveit_grasps_config.yaml"
+    )
+
+    # Task nodes loaded into this container share the grasp planning server
+    grasp_planning_container = ComposableNodeContainer(
+        name="grasp_planning_container",
+        namespace="",
+        package="rclcpp_components",
+        executable="component_container_mt",
+        output="screen",
+        composable_node_descriptions=[
+            ComposableNode(
+                package="moveit_grasps",
+                plugin="moveit_grasps::GraspPlanningServer",
+                name="grasp_planning_server",
+                parameters=[
+                    robot_description,
+                    robot_description_semantic,
+                    kinematics_yaml,
+                    ee_group_name,
+                    planning_group_name,
+                    max_planned_grasps,
+                    panda_grasp_data_yaml,
+                    moveit_grasps_config_yaml,
+                ],
+                extra_arguments=[{"use_intra_process_comms": True}],
+            ),
+        ],
+    )
+
+    return LaunchDescription([grasp_planning_container])
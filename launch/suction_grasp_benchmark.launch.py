@@ -0,0 +1,96 @@
+import os
+import yaml
+from launch import LaunchDescription
+from launch_ros.actions import Node
+from ament_index_python.packages import get_package_share_directory
+
+
+def load_file(package_name, file_path):
+    package_path = get_package_share_directory(package_name)
+    absolute_file_path = os.path.join(package_path, file_path)
+
+    try:
+        with open(absolute_file_path, "r") as file:
+            return file.read()
+    except EnvironmentError:  # parent of IOError, OSError *and* WindowsError where available
+        return None
+
+
+def load_yaml(package_name, file_path):
+    package_path = get_package_share_directory(package_name)
+    absolute_file_path = os.path.join(package_path, file_path)
+
+    try:
+        with open(absolute_file_path, "r") as file:
+            return yaml.safe_load(file)
+    except EnvironmentError:  # parent of IOError, OSError *and* WindowsError where available
+        return None
+
+
+def generate_launch_description():
+    # planning_context
+    robot_description_config = load_file(
+        "moveit_resources_panda_description", "urdf/panda.urdf"
+    )
+    robot_description = {"robot_description": robot_description_config}
+
+    robot_description_semantic_config = load_file(
+        "moveit_resources_panda_moveit_config", "config/panda.srdf"
+    )
+    robot_description_semantic = {
+        "robot_description_semantic": robot_description_semantic_config
+    }
+
+    kinematics_yaml = load_yaml(
+        "moveit_resources_panda_moveit_config", "config/kinematics.yaml"
+    )
+
+    ee_group_name = {"ee_group_name": "hand"}
+    planning_group_name = {"planning_group_name": "panda_arm"}
+    iterations = {"iterations": 10}
+    panda_grasp_data_yaml = load_yaml(
+        "moveit_grasps", "config_robot/panda_grasp_data.yaml"
+    )
+    moveit_grasps_config_yaml = load_yaml(
+        "moveit_grasps", "config/moveit_grasps_config.yaml"
+    )
+
+    # Disable everything that visualizes or serializes the filtering so only the computation is timed
+    benchmark_overrides = {
+        "moveit_grasps": {
+            "generator": {
+                "verbose": False,
+                "show_prefiltered_grasps": False,
+                "debug_top_grasps": False,
+                "show_grasp_overhang": False,
+            },
+            "filter": {
+                "collision_verbose": False,
+                "show_cutting_planes": False,
+                "show_grasp_filter_collision_if_failed": False,
+                "show_filtered_grasps": False,
+                "show_filtered_arm_solutions": False,
+            },
+        }
+    }
+
+    # Suction grasp benchmark executable
+    suction_grasp_benchmark = Node(
+        name="suction_grasp_benchmark",
+        package="moveit_grasps",
+        executable="moveit_grasps_suction_grasp_benchmark",
+        output="screen",
+        parameters=[
+            robot_description,
+            robot_description_semantic,
+            kinematics_yaml,
+            ee_group_name,
+            planning_group_name,
+            iterations,
+            panda_grasp_data_yaml,
+            moveit_grasps_config_yaml,
+            benchmark_overrides,
+        ],
+    )
+
+    return LaunchDescription([suction_grasp_benchmark])
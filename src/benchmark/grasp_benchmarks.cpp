@@ -0,0 +1,500 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Repeatable microbenchmarks of the generator, scorer, filter and planner hot paths in a fixed panda scene.
+           Run with --benchmark_out=<file> --benchmark_out_format=json to track the results across versions
+*/
+
+// C++
+#include <memory>
+#include <thread>
+
+// Benchmark
+#include <benchmark/benchmark.h>
+
+// ROS
+#include <rclcpp/rclcpp.hpp>
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+// MoveIt
+#include <geometric_shapes/shapes.h>
+#include <moveit/planning_scene_monitor/planning_scene_monitor.h>
+#include <moveit_visual_tools/moveit_visual_tools.h>
+
+// Grasp
+#include <moveit_grasps/grasp_pipeline.h>
+#include <moveit_grasps/grasp_planner.h>
+#include <moveit_grasps/ik_worker_pool.h>
+#include <moveit_grasps/suction_grasp_data.h>
+#include <moveit_grasps/suction_grasp_scorer.h>
+#include <moveit_grasps/two_finger_grasp_data.h>
+#include <moveit_grasps/two_finger_grasp_filter.h>
+#include <moveit_grasps/two_finger_grasp_generator.h>
+
+// Parameter loading
+#include <rosparam_shortcuts/rosparam_shortcuts.h>
+
+namespace moveit_grasps_benchmark
+{
+namespace
+{
+const rclcpp::Logger LOGGER = rclcpp::get_logger("grasp_benchmarks");
+
+// The benchmarked cuboid, small enough to be grasped around every axis
+const std::string OBJECT_ID = "pick_target";
+constexpr double OBJECT_DEPTH = 0.02;
+constexpr double OBJECT_WIDTH = 0.03;
+constexpr double OBJECT_HEIGHT = 0.05;
+
+// The panda default state is in self collision
+const std::vector<double> READY_JOINT_POSITIONS = { 0.0, -0.785, 0.0, -2.356, 0.0, 1.571, 0.785 };
+
+enum GraspType
+{
+  CORNER_GRASPS,
+  FACE_GRASPS,
+  VARIABLE_ANGLE_GRASPS,
+  EDGE_GRASPS
+};
+
+moveit_grasps::TwoFingerGraspCandidateConfig getGraspCandidateConfig(std::size_t axis, GraspType grasp_type)
+{
+  moveit_grasps::TwoFingerGraspCandidateConfig grasp_candidate_config;
+  grasp_candidate_config.disableAll();
+  grasp_candidate_config.generate_x_axis_grasps_ = axis == 0;
+  grasp_candidate_config.generate_y_axis_grasps_ = axis == 1;
+  grasp_candidate_config.generate_z_axis_grasps_ = axis == 2;
+  grasp_candidate_config.enable_corner_grasps_ = grasp_type == CORNER_GRASPS;
+  // Variable angle grasps are tilted face grasps
+  grasp_candidate_config.enable_face_grasps_ = grasp_type == FACE_GRASPS || grasp_type == VARIABLE_ANGLE_GRASPS;
+  grasp_candidate_config.enable_variable_angle_grasps_ = grasp_type == VARIABLE_ANGLE_GRASPS;
+  grasp_candidate_config.enable_edge_grasps_ = grasp_type == EDGE_GRASPS;
+  return grasp_candidate_config;
+}
+}  // namespace
+
+// Gives the benchmarks access to the protected stages of the generator
+class TwoFingerGraspGeneratorBenchmark : public moveit_grasps::TwoFingerGraspGenerator
+{
+public:
+  using moveit_grasps::TwoFingerGraspGenerator::TwoFingerGraspGenerator;
+  using moveit_grasps::TwoFingerGraspGenerator::computeGraspPoseStatistics;
+  using moveit_grasps::TwoFingerGraspGenerator::generateCuboidAxisGraspPoses;
+  using moveit_grasps::TwoFingerGraspGenerator::scoreFingerGrasp;
+};
+
+/**
+ * \brief Everything the benchmarks share, loaded once from the parameters of the node
+ */
+class GraspBenchmarkEnvironment
+{
+public:
+  // Constructor
+  GraspBenchmarkEnvironment(const rclcpp::Node::SharedPtr& nh) : nh_(nh)
+  {
+    // Get arm info from param server
+    std::size_t error = 0;
+    error += !rosparam_shortcuts::get(nh_, "planning_group_name", planning_group_name_);
+    error += !rosparam_shortcuts::get(nh_, "ee_group_name", ee_group_name_);
+    rosparam_shortcuts::shutdownIfError(error);
+
+    // ---------------------------------------------------------------------------------------------
+    // Load planning scene
+    planning_scene_monitor_ = std::make_shared<planning_scene_monitor::PlanningSceneMonitor>(nh_, "robot_description");
+    if (!planning_scene_monitor_->getPlanningScene())
+    {
+      RCLCPP_ERROR_STREAM(LOGGER, "Planning scene not configured");
+      exit(-1);
+    }
+    const moveit::core::RobotModelConstPtr robot_model = planning_scene_monitor_->getRobotModel();
+    arm_jmg_ = robot_model->getJointModelGroup(planning_group_name_);
+
+    // ---------------------------------------------------------------------------------------------
+    // Visual tools are required by the generator and filter, but nothing is published while benchmarking
+    visual_tools_ = std::make_shared<moveit_visual_tools::MoveItVisualTools>(
+        nh_, robot_model->getModelFrame(), "/rviz_visual_tools", planning_scene_monitor_);
+    visual_tools_->loadSharedRobotState();
+    visual_tools_->getSharedRobotState()->setToDefaultValues();
+    visual_tools_->getSharedRobotState()->setJointGroupPositions(arm_jmg_, READY_JOINT_POSITIONS);
+    visual_tools_->getSharedRobotState()->update();
+
+    // ---------------------------------------------------------------------------------------------
+    // Fixed scene with the robot in its ready state and the object in front of it
+    object_pose_ = Eigen::Isometry3d::Identity();
+    object_pose_.translation() = Eigen::Vector3d(0.5, 0.0, 0.4);
+    planning_scene_ = planning_scene::PlanningScene::clone(planning_scene_monitor_->getPlanningScene());
+    planning_scene_->setCurrentState(*visual_tools_->getSharedRobotState());
+    planning_scene_->getWorldNonConst()->addToObject(
+        OBJECT_ID, std::make_shared<shapes::Box>(OBJECT_DEPTH, OBJECT_WIDTH, OBJECT_HEIGHT), object_pose_);
+
+    // ---------------------------------------------------------------------------------------------
+    // Load grasp data specific to our robot, the panda config has both two finger and suction parameters
+    two_finger_grasp_data_ = std::make_shared<moveit_grasps::TwoFingerGraspData>(nh_, ee_group_name_, robot_model);
+    suction_grasp_data_ = std::make_shared<moveit_grasps::SuctionGraspData>(nh_, ee_group_name_, robot_model);
+    if (!two_finger_grasp_data_->loadGraspData(nh_, ee_group_name_) ||
+        !suction_grasp_data_->loadGraspData(nh_, ee_group_name_))
+    {
+      RCLCPP_ERROR_STREAM(LOGGER, "Failed to load Grasp Data parameters.");
+      exit(-1);
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // Load grasp generator, filter and planner
+    grasp_generator_ = std::make_shared<TwoFingerGraspGeneratorBenchmark>(nh_, visual_tools_);
+    std::vector<double> ideal_grasp_rpy = { 3.14, 0.0, 0.0 };
+    grasp_generator_->setIdealTCPGraspPoseRPY(ideal_grasp_rpy);
+
+    grasp_filter_ =
+        std::make_shared<moveit_grasps::TwoFingerGraspFilter>(nh_, visual_tools_->getSharedRobotState(), visual_tools_);
+    grasp_planner_ = std::make_shared<moveit_grasps::GraspPlanner>(nh_, visual_tools_);
+  }
+
+  /**
+   * \brief Generate all grasps of the object around every axis
+   */
+  void generateGrasps(std::vector<moveit_grasps::GraspCandidatePtr>& grasp_candidates)
+  {
+    grasp_generator_->setGraspCandidateConfig(moveit_grasps::TwoFingerGraspCandidateConfig());
+    grasp_generator_->generateGrasps(object_pose_, OBJECT_DEPTH, OBJECT_WIDTH, OBJECT_HEIGHT, two_finger_grasp_data_,
+                                     grasp_candidates);
+  }
+
+  /**
+   * \brief Filter the generated grasps once, the valid grasps are the input of the planner benchmarks
+   */
+  const std::vector<moveit_grasps::GraspCandidatePtr>& getValidGraspCandidates()
+  {
+    if (valid_grasp_candidates_.empty())
+    {
+      generateGrasps(valid_grasp_candidates_);
+      grasp_filter_->filterGrasps(valid_grasp_candidates_, planning_scene_, arm_jmg_,
+                                  visual_tools_->getSharedRobotState(), true, OBJECT_ID);
+      grasp_filter_->removeInvalidAndFilter(valid_grasp_candidates_);
+      RCLCPP_INFO_STREAM(LOGGER, valid_grasp_candidates_.size() << " valid grasps for the planner benchmarks");
+    }
+    return valid_grasp_candidates_;
+  }
+
+  // A shared node handle
+  rclcpp::Node::SharedPtr nh_;
+
+  // Tool for visualizing things in Rviz
+  moveit_visual_tools::MoveItVisualToolsPtr visual_tools_;
+
+  // Grasp generator, filter and planner
+  std::shared_ptr<TwoFingerGraspGeneratorBenchmark> grasp_generator_;
+  moveit_grasps::TwoFingerGraspFilterPtr grasp_filter_;
+  moveit_grasps::GraspPlannerPtr grasp_planner_;
+
+  // data for generating grasps
+  moveit_grasps::TwoFingerGraspDataPtr two_finger_grasp_data_;
+  moveit_grasps::SuctionGraspDataPtr suction_grasp_data_;
+
+  // Shared planning scene and the fixed scene with the object
+  planning_scene_monitor::PlanningSceneMonitorPtr planning_scene_monitor_;
+  planning_scene::PlanningScenePtr planning_scene_;
+
+  // Arm
+  const moveit::core::JointModelGroup* arm_jmg_;
+
+  // Which arm should be used
+  std::string ee_group_name_;
+  std::string planning_group_name_;
+
+  // Pose of the benchmarked cuboid
+  Eigen::Isometry3d object_pose_;
+
+private:
+  std::vector<moveit_grasps::GraspCandidatePtr> valid_grasp_candidates_;
+};
+
+// Created in main() once the node is up
+std::unique_ptr<GraspBenchmarkEnvironment> environment;
+
+// Arguments: axis, grasp type
+void benchmarkGenerateGrasps(benchmark::State& state)
+{
+  environment->grasp_generator_->setGraspCandidateConfig(
+      getGraspCandidateConfig(state.range(0), static_cast<GraspType>(state.range(1))));
+  std::size_t num_grasps = 0;
+  for (auto _ : state)
+  {
+    moveit_grasps::GraspCandidateBatch grasp_candidate_batch(environment->two_finger_grasp_data_,
+                                                             environment->object_pose_);
+    environment->grasp_generator_->generateGrasps(environment->object_pose_, OBJECT_DEPTH, OBJECT_WIDTH,
+                                                  OBJECT_HEIGHT, environment->two_finger_grasp_data_,
+                                                  grasp_candidate_batch);
+    num_grasps = grasp_candidate_batch.size();
+    benchmark::DoNotOptimize(num_grasps);
+  }
+  state.SetItemsProcessed(state.iterations() * num_grasps);
+  state.counters["grasps"] = num_grasps;
+}
+BENCHMARK(benchmarkGenerateGrasps)
+    ->ArgNames({ "axis", "type" })
+    ->ArgsProduct({ { 0, 1, 2 }, { CORNER_GRASPS, FACE_GRASPS, VARIABLE_ANGLE_GRASPS, EDGE_GRASPS } })
+    ->Unit(benchmark::kMicrosecond);
+
+// Argument: use grasp templates
+void benchmarkGenerateAllGrasps(benchmark::State& state)
+{
+  environment->grasp_generator_->setGraspCandidateConfig(moveit_grasps::TwoFingerGraspCandidateConfig());
+  environment->grasp_generator_->setUseGraspTemplates(state.range(0));
+  std::size_t num_grasps = 0;
+  for (auto _ : state)
+  {
+    moveit_grasps::GraspCandidateBatch grasp_candidate_batch(environment->two_finger_grasp_data_,
+                                                             environment->object_pose_);
+    environment->grasp_generator_->generateGrasps(environment->object_pose_, OBJECT_DEPTH, OBJECT_WIDTH,
+                                                  OBJECT_HEIGHT, environment->two_finger_grasp_data_,
+                                                  grasp_candidate_batch);
+    num_grasps = grasp_candidate_batch.size();
+    benchmark::DoNotOptimize(num_grasps);
+  }
+  environment->grasp_generator_->setUseGraspTemplates(false);
+  state.SetItemsProcessed(state.iterations() * num_grasps);
+  state.counters["grasps"] = num_grasps;
+}
+BENCHMARK(benchmarkGenerateAllGrasps)->ArgName("templates")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+void benchmarkScoreFingerGrasp(benchmark::State& state)
+{
+  EigenSTL::vector_Isometry3d grasp_poses_tcp;
+  double object_width;
+  environment->grasp_generator_->generateCuboidAxisGraspPoses(
+      environment->object_pose_, OBJECT_DEPTH, OBJECT_WIDTH, OBJECT_HEIGHT, moveit_grasps::X_AXIS,
+      environment->two_finger_grasp_data_, moveit_grasps::TwoFingerGraspCandidateConfig(), grasp_poses_tcp,
+      object_width);
+  environment->grasp_generator_->computeGraspPoseStatistics(environment->object_pose_, grasp_poses_tcp);
+
+  for (auto _ : state)
+  {
+    for (const Eigen::Isometry3d& grasp_pose_tcp : grasp_poses_tcp)
+    {
+      benchmark::DoNotOptimize(environment->grasp_generator_->scoreFingerGrasp(
+          grasp_pose_tcp, environment->two_finger_grasp_data_, environment->object_pose_, 1.0));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * grasp_poses_tcp.size());
+}
+BENCHMARK(benchmarkScoreFingerGrasp)->Unit(benchmark::kMicrosecond);
+
+// Score a fixed set of tcp poses swept over the top face of the object
+void benchmarkScoreSuctionVoxelOverlap(benchmark::State& state)
+{
+  EigenSTL::vector_Isometry3d grasp_poses_tcp;
+  for (double x = -OBJECT_DEPTH; x <= OBJECT_DEPTH; x += 0.005)
+  {
+    for (double y = -OBJECT_WIDTH; y <= OBJECT_WIDTH; y += 0.005)
+    {
+      for (double yaw = 0; yaw < M_PI; yaw += M_PI / 8.0)
+      {
+        grasp_poses_tcp.emplace_back(environment->object_pose_ * Eigen::Translation3d(x, y, 0) *
+                                     Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ()) *
+                                     Eigen::AngleAxisd(M_PI, Eigen::Vector3d::UnitX()));
+      }
+    }
+  }
+
+  const Eigen::Vector3d object_size(OBJECT_DEPTH, OBJECT_WIDTH, OBJECT_HEIGHT);
+  std::vector<double> overlap_vector;
+  for (auto _ : state)
+  {
+    for (const Eigen::Isometry3d& grasp_pose_tcp : grasp_poses_tcp)
+    {
+      benchmark::DoNotOptimize(moveit_grasps::SuctionGraspScorer::scoreSuctionVoxelOverlap(
+          grasp_pose_tcp, environment->suction_grasp_data_, environment->object_pose_, object_size, overlap_vector));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * grasp_poses_tcp.size());
+}
+BENCHMARK(benchmarkScoreSuctionVoxelOverlap)->Unit(benchmark::kMicrosecond);
+
+// Grasp and pregrasp IK of single candidates, round robin over all generated grasps
+void benchmarkProcessCandidateGrasp(benchmark::State& state)
+{
+  std::vector<moveit_grasps::GraspCandidatePtr> grasp_candidates;
+  environment->generateGrasps(grasp_candidates);
+  if (grasp_candidates.empty())
+  {
+    state.SkipWithError("No grasps generated");
+    return;
+  }
+
+  // The end effector may touch the object, as in GraspFilter
+  planning_scene::PlanningScenePtr planning_scene = environment->planning_scene_->diff();
+  planning_scene->getAllowedCollisionMatrixNonConst().setEntry(
+      OBJECT_ID, environment->two_finger_grasp_data_->ee_jmg_->getLinkModelNames(), true);
+
+  moveit_grasps::IkWorkerPool ik_worker_pool(1);
+  if (!ik_worker_pool.loadSolvers(environment->arm_jmg_))
+  {
+    state.SkipWithError("Unable to load the kinematic solver");
+    return;
+  }
+  ik_worker_pool.setRobotStates(*environment->visual_tools_->getSharedRobotState(), 1);
+
+  std::vector<double> ik_seed_state;
+  environment->visual_tools_->getSharedRobotState()->copyJointGroupPositions(environment->arm_jmg_, ik_seed_state);
+
+  // The solvers of the panda work in its model frame
+  Eigen::Isometry3d link_transform = Eigen::Isometry3d::Identity();
+  auto ik_thread_struct = std::make_shared<moveit_grasps::IkThreadStruct>(
+      grasp_candidates, planning_scene, link_transform, 0, ik_worker_pool.getSolver(0, environment->arm_jmg_),
+      ik_worker_pool.getRobotState(0), 0.05, true, false, 0, OBJECT_ID, false);
+
+  std::size_t num_valid = 0;
+  for (auto _ : state)
+  {
+    const std::size_t grasp_id = ik_thread_struct->grasp_id;
+    grasp_candidates[grasp_id]->grasp_filtered_code_ = moveit_grasps::GraspFilterCode::NOT_FILTERED;
+    // Every candidate starts from the same seed, so the result does not depend on the order
+    ik_thread_struct->ik_seed_state_ = ik_seed_state;
+    num_valid += environment->grasp_filter_->processCandidateGrasp(ik_thread_struct);
+    ik_thread_struct->grasp_id = (grasp_id + 1) % grasp_candidates.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["valid_ratio"] = static_cast<double>(num_valid) / state.iterations();
+}
+BENCHMARK(benchmarkProcessCandidateGrasp)->Unit(benchmark::kMicrosecond);
+
+// The approach path of the valid grasps, which carries no attached object
+void benchmarkComputeCartesianWaypointPath(benchmark::State& state)
+{
+  const std::vector<moveit_grasps::GraspCandidatePtr>& valid_grasp_candidates =
+      environment->getValidGraspCandidates();
+  if (valid_grasp_candidates.empty())
+  {
+    state.SkipWithError("No valid grasps");
+    return;
+  }
+
+  moveit_grasps::PreparedGraspScene prepared_scene;
+  environment->grasp_planner_->prepareGraspScene(environment->planning_scene_, environment->two_finger_grasp_data_,
+                                                 OBJECT_ID, prepared_scene);
+
+  std::size_t grasp_id = 0;
+  std::size_t num_valid = 0;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    moveit_grasps::GraspCandidatePtr grasp_candidate =
+        std::make_shared<moveit_grasps::GraspCandidate>(*valid_grasp_candidates[grasp_id]);
+    grasp_id = (grasp_id + 1) % valid_grasp_candidates.size();
+
+    EigenSTL::vector_Isometry3d waypoints;
+    moveit_grasps::GraspGenerator::getGraspWaypoints(grasp_candidate, waypoints);
+    // Plan from the pregrasp to the grasp
+    waypoints.resize(2);
+    auto start_state = std::make_shared<moveit::core::RobotState>(*environment->visual_tools_->getSharedRobotState());
+    grasp_candidate->getPreGraspState(start_state);
+    state.ResumeTiming();
+
+    num_valid += environment->grasp_planner_->computeCartesianWaypointPath(grasp_candidate, prepared_scene,
+                                                                           start_state, waypoints);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["valid_ratio"] = static_cast<double>(num_valid) / state.iterations();
+}
+BENCHMARK(benchmarkComputeCartesianWaypointPath)->Unit(benchmark::kMicrosecond);
+
+// Argument: number of threads of the filter and planner
+void benchmarkGraspPipeline(benchmark::State& state)
+{
+  auto ik_worker_pool = std::make_shared<moveit_grasps::IkWorkerPool>(state.range(0));
+  const moveit_grasps::IkWorkerPoolPtr filter_ik_worker_pool = environment->grasp_filter_->getIkWorkerPool();
+  environment->grasp_filter_->setIkWorkerPool(ik_worker_pool);
+  environment->grasp_planner_->setIkWorkerPool(ik_worker_pool);
+  environment->grasp_generator_->setGraspCandidateConfig(moveit_grasps::TwoFingerGraspCandidateConfig());
+
+  moveit_grasps::GraspPipeline grasp_pipeline(environment->grasp_generator_, environment->grasp_filter_,
+                                              environment->grasp_planner_);
+  moveit_grasps::GraspPipelineRequest request;
+  request.cuboid_pose_ = environment->object_pose_;
+  request.depth_ = OBJECT_DEPTH;
+  request.width_ = OBJECT_WIDTH;
+  request.height_ = OBJECT_HEIGHT;
+  request.grasp_data_ = environment->two_finger_grasp_data_;
+  request.planning_scene_ = environment->planning_scene_;
+  request.arm_jmg_ = environment->arm_jmg_;
+  request.seed_state_ = environment->visual_tools_->getSharedRobotState();
+  request.grasp_object_id_ = OBJECT_ID;
+  // Plan every candidate so each iteration does the same work
+  request.max_planned_grasps_ = 0;
+
+  std::size_t num_generated = 0;
+  std::size_t num_planned = 0;
+  for (auto _ : state)
+  {
+    const moveit_grasps::GraspPipelineResult result = grasp_pipeline.plan(request);
+    num_generated = result.num_generated_;
+    num_planned = result.grasp_candidates_.size();
+  }
+
+  environment->grasp_filter_->setIkWorkerPool(filter_ik_worker_pool);
+  environment->grasp_planner_->setIkWorkerPool(moveit_grasps::IkWorkerPoolPtr());
+  state.SetItemsProcessed(state.iterations() * num_generated);
+  state.counters["planned"] = num_planned;
+}
+BENCHMARK(benchmarkGraspPipeline)
+    ->ArgName("threads")
+    ->RangeMultiplier(2)
+    ->Range(1, std::max(1u, std::thread::hardware_concurrency()))
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace moveit_grasps_benchmark
+
+int main(int argc, char* argv[])
+{
+  // Consumes the --benchmark_* arguments, the rest are passed on to ROS
+  benchmark::Initialize(&argc, argv);
+
+  rclcpp::init(argc, argv);
+  rclcpp::NodeOptions node_options;
+  node_options.automatically_declare_parameters_from_overrides(true);
+  auto node = rclcpp::Node::make_shared("grasp_benchmarks", node_options);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  std::thread([&executor]() { executor.spin(); }).detach();
+
+  moveit_grasps_benchmark::environment = std::make_unique<moveit_grasps_benchmark::GraspBenchmarkEnvironment>(node);
+  benchmark::RunSpecifiedBenchmarks();
+  moveit_grasps_benchmark::environment.reset();
+
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,267 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Long-lived pool of IK workers, each with its own kinematic solvers and robot state
+*/
+/* Desc:   Measures suction voxel overlap scoring, suction grasp generation and suction filtering throughput
+*/
+
+// C++
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+// ROS
+#include <rclcpp/rclcpp.hpp>
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+// MoveIt
+#include <moveit/planning_scene_monitor/planning_scene_monitor.h>
+#include <moveit_visual_tools/moveit_visual_tools.h>
+
+// Grasp
+#include <moveit_grasps/suction_grasp_data.h>
+#include <moveit_grasps/suction_grasp_filter.h>
+#include <moveit_grasps/suction_grasp_generator.h>
+#include <moveit_grasps/suction_grasp_scorer.h>
+
+// Parameter loading
+#include <rosparam_shortcuts/rosparam_shortcuts.h>
+
+namespace moveit_grasps_benchmark
+{
+namespace
+{
+const rclcpp::Logger LOGGER = rclcpp::get_logger("suction_grasp_benchmark");
+
+// Dimensions of the benchmarked cuboid, it is slightly larger than the suction gripper along x
+constexpr double OBJECT_DEPTH = 0.25;
+constexpr double OBJECT_WIDTH = 0.1;
+constexpr double OBJECT_HEIGHT = 0.05;
+
+double secondsSince(const std::chrono::steady_clock::time_point& start_time)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+}
+}  // namespace
+
+class SuctionGraspBenchmark
+{
+public:
+  // Constructor
+  SuctionGraspBenchmark(const rclcpp::Node::SharedPtr& nh) : nh_(nh)
+  {
+    // Get arm info from param server
+    std::size_t error = 0;
+    error += !rosparam_shortcuts::get(nh_, "planning_group_name", planning_group_name_);
+    error += !rosparam_shortcuts::get(nh_, "ee_group_name", ee_group_name_);
+    rosparam_shortcuts::shutdownIfError(error);
+    nh_->get_parameter_or<int>("iterations", iterations_, 10);
+
+    RCLCPP_INFO_STREAM(LOGGER, "End Effector: " << ee_group_name_);
+    RCLCPP_INFO_STREAM(LOGGER, "Planning Group: " << planning_group_name_);
+
+    // ---------------------------------------------------------------------------------------------
+    // Load planning scene to share
+    planning_scene_monitor_ = std::make_shared<planning_scene_monitor::PlanningSceneMonitor>(nh_, "robot_description");
+    if (!planning_scene_monitor_->getPlanningScene())
+    {
+      RCLCPP_ERROR_STREAM(LOGGER, "Planning scene not configured");
+      exit(-1);
+    }
+
+    const moveit::core::RobotModelConstPtr robot_model = planning_scene_monitor_->getRobotModel();
+    arm_jmg_ = robot_model->getJointModelGroup(planning_group_name_);
+
+    // ---------------------------------------------------------------------------------------------
+    // Visual tools are required by the generator and filter, but nothing is published while benchmarking
+    visual_tools_ = std::make_shared<moveit_visual_tools::MoveItVisualTools>(
+        nh_, robot_model->getModelFrame(), "/rviz_visual_tools", planning_scene_monitor_);
+    visual_tools_->loadSharedRobotState();
+    visual_tools_->getSharedRobotState()->setToDefaultValues();
+
+    // ---------------------------------------------------------------------------------------------
+    // Load grasp data specific to our robot
+    grasp_data_ = std::make_shared<moveit_grasps::SuctionGraspData>(nh_, ee_group_name_, robot_model);
+    if (!grasp_data_->loadGraspData(nh_, ee_group_name_))
+    {
+      RCLCPP_ERROR_STREAM(LOGGER, "Failed to load Grasp Data parameters.");
+      exit(-1);
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // Load grasp generator
+    grasp_generator_ = std::make_shared<moveit_grasps::SuctionGraspGenerator>(nh_, visual_tools_);
+    std::vector<double> ideal_grasp_rpy = { 3.14, 0.0, 0.0 };
+    grasp_generator_->setIdealTCPGraspPoseRPY(ideal_grasp_rpy);
+
+    // ---------------------------------------------------------------------------------------------
+    // Load grasp filter
+    grasp_filter_ =
+        std::make_shared<moveit_grasps::SuctionGraspFilter>(nh_, visual_tools_->getSharedRobotState(), visual_tools_);
+    grasp_filter_->setSuctionVoxelOverlapCutoff(0.5);
+
+    object_pose_ = Eigen::Isometry3d::Identity();
+    object_pose_.translation() = Eigen::Vector3d(0.4, 0.0, 0.3);
+  }
+
+  // Score a fixed set of tcp poses swept over the top face of the object
+  void benchmarkVoxelOverlapScoring()
+  {
+    EigenSTL::vector_Isometry3d grasp_poses_tcp;
+    for (double x = -OBJECT_DEPTH; x <= OBJECT_DEPTH; x += 0.01)
+    {
+      for (double y = -OBJECT_WIDTH; y <= OBJECT_WIDTH; y += 0.01)
+      {
+        for (double yaw = 0; yaw < M_PI; yaw += M_PI / 8.0)
+        {
+          grasp_poses_tcp.emplace_back(object_pose_ * Eigen::Translation3d(x, y, 0) *
+                                       Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ()) *
+                                       Eigen::AngleAxisd(M_PI, Eigen::Vector3d::UnitX()));
+        }
+      }
+    }
+
+    const Eigen::Vector3d object_size(OBJECT_DEPTH, OBJECT_WIDTH, OBJECT_HEIGHT);
+    std::vector<double> overlap_vector;
+    double score_sum = 0;
+
+    const auto start_time = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations_; ++i)
+    {
+      for (const Eigen::Isometry3d& grasp_pose_tcp : grasp_poses_tcp)
+      {
+        score_sum += moveit_grasps::SuctionGraspScorer::scoreSuctionVoxelOverlap(grasp_pose_tcp, grasp_data_,
+                                                                                 object_pose_, object_size,
+                                                                                 overlap_vector);
+      }
+    }
+    const double duration = secondsSince(start_time);
+
+    const std::size_t num_scored = grasp_poses_tcp.size() * iterations_;
+    report("voxel overlap scoring", num_scored, duration);
+    RCLCPP_DEBUG_STREAM(LOGGER, "Mean overhang score: " << score_sum / num_scored);
+  }
+
+  // Generate and filter suction grasps for the object in an empty planning scene
+  void benchmarkGenerateAndFilter()
+  {
+    std::vector<moveit_grasps::GraspCandidatePtr> grasp_candidates;
+    double generate_duration = 0;
+    double filter_duration = 0;
+    std::size_t num_generated = 0;
+    std::size_t num_valid = 0;
+
+    for (int i = 0; i < iterations_; ++i)
+    {
+      auto start_time = std::chrono::steady_clock::now();
+      grasp_generator_->generateGrasps(object_pose_, OBJECT_DEPTH, OBJECT_WIDTH, OBJECT_HEIGHT, grasp_data_,
+                                       grasp_candidates);
+      generate_duration += secondsSince(start_time);
+      num_generated += grasp_candidates.size();
+
+      start_time = std::chrono::steady_clock::now();
+      grasp_filter_->filterGrasps(grasp_candidates, planning_scene_monitor_, arm_jmg_,
+                                  visual_tools_->getSharedRobotState(), true);
+      filter_duration += secondsSince(start_time);
+      if (grasp_filter_->removeInvalidAndFilter(grasp_candidates))
+        num_valid += grasp_candidates.size();
+    }
+
+    report("suction grasp generation", num_generated, generate_duration);
+    report("suction grasp filtering", num_generated, filter_duration);
+    RCLCPP_INFO_STREAM(LOGGER, "Valid grasps: " << num_valid << " of " << num_generated);
+  }
+
+private:
+  void report(const std::string& name, std::size_t count, double duration) const
+  {
+    RCLCPP_INFO_STREAM(LOGGER, name << ": " << count << " in " << duration << "s, " << count / duration << " /s");
+    std::cout << name << "\t" << count << "\t" << duration << "\t" << count / duration << std::endl;
+  }
+
+  // A shared node handle
+  rclcpp::Node::SharedPtr nh_;
+
+  // Tool for visualizing things in Rviz
+  moveit_visual_tools::MoveItVisualToolsPtr visual_tools_;
+
+  // Grasp generator
+  moveit_grasps::SuctionGraspGeneratorPtr grasp_generator_;
+
+  // Grasp filter
+  moveit_grasps::SuctionGraspFilterPtr grasp_filter_;
+
+  // data for generating grasps
+  moveit_grasps::SuctionGraspDataPtr grasp_data_;
+
+  // Shared planning scene (load once for everything)
+  planning_scene_monitor::PlanningSceneMonitorPtr planning_scene_monitor_;
+
+  // Arm
+  const moveit::core::JointModelGroup* arm_jmg_;
+
+  // Which arm should be used
+  std::string ee_group_name_;
+  std::string planning_group_name_;
+
+  // Number of times each benchmark is repeated
+  int iterations_;
+
+  // Pose of the benchmarked cuboid
+  Eigen::Isometry3d object_pose_;
+
+};  // end of class
+
+}  // namespace moveit_grasps_benchmark
+
+int main(int argc, char* argv[])
+{
+  rclcpp::init(argc, argv);
+  rclcpp::NodeOptions node_options;
+  node_options.automatically_declare_parameters_from_overrides(true);
+  auto node = rclcpp::Node::make_shared("suction_grasp_benchmark", node_options);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  std::thread([&executor]() { executor.spin(); }).detach();
+
+  moveit_grasps_benchmark::SuctionGraspBenchmark benchmark(node);
+  benchmark.benchmarkVoxelOverlapScoring();
+  benchmark.benchmarkGenerateAndFilter();
+
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,115 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Thread safe buffer of colliding states, recorded while filtering and published to rviz afterwards
+*/
+
+#include <moveit_grasps/collision_state_buffer.h>
+#include <moveit_grasps/state_validity_callback.h>
+
+namespace moveit_grasps
+{
+CollisionStateBuffer::CollisionStateBuffer(std::size_t max_states) : max_states_(max_states)
+{
+}
+
+void CollisionStateBuffer::record(const planning_scene::PlanningScene* planning_scene,
+                                  const moveit::core::RobotState& robot_state, const std::string& group_name)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++num_collisions_;
+  if (entries_.size() >= max_states_)
+    return;
+  entries_.push_back(Entry{ planning_scene->shared_from_this(), robot_state, group_name });
+}
+
+std::size_t CollisionStateBuffer::publish(const moveit_visual_tools::MoveItVisualToolsPtr& visual_tools,
+                                          double verbose_speed)
+{
+  std::vector<Entry> entries;
+  std::size_t num_collisions;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries.swap(entries_);
+    num_collisions = num_collisions_;
+    num_collisions_ = 0;
+  }
+
+  if (!visual_tools || entries.empty())
+    return 0;
+
+  RCLCPP_INFO_STREAM(rclcpp::get_logger("collision_state_buffer"),
+                     "Publishing " << entries.size() << " of " << num_collisions << " colliding states");
+  for (const Entry& entry : entries)
+  {
+    if (!rclcpp::ok())
+      break;
+    publishStateCollision(entry.planning_scene_.get(), verbose_speed, *visual_tools, entry.robot_state_,
+                          entry.group_name_);
+  }
+  return entries.size();
+}
+
+void CollisionStateBuffer::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  num_collisions_ = 0;
+}
+
+std::size_t CollisionStateBuffer::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+std::size_t CollisionStateBuffer::getNumCollisions() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_collisions_;
+}
+
+void CollisionStateBuffer::setMaxStates(std::size_t max_states)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_states_ = max_states;
+}
+
+std::size_t CollisionStateBuffer::getMaxStates() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return max_states_;
+}
+
+}  // namespace moveit_grasps
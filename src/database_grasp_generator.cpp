@@ -0,0 +1,171 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Streams the grasps of known objects from a precomputed grasp database instead of generating them
+*/
+
+#include <moveit_grasps/database_grasp_generator.h>
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace moveit_grasps
+{
+namespace
+{
+const rclcpp::Logger LOGGER = rclcpp::get_logger("grasp_generator.database");
+}  // namespace
+
+DatabaseGraspGenerator::DatabaseGraspGenerator(rclcpp::Node::SharedPtr node,
+                                               const moveit_visual_tools::MoveItVisualToolsPtr& visual_tools,
+                                               const GraspDatabaseConstPtr& grasp_database, bool verbose)
+  : GraspGenerator(node, visual_tools, verbose), grasp_database_(grasp_database)
+{
+}
+
+bool DatabaseGraspGenerator::generateGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width,
+                                            double height, const GraspDataPtr& grasp_data,
+                                            std::vector<GraspCandidatePtr>& grasp_candidates)
+{
+  return streamGrasps(cuboid_pose, depth, width, height, grasp_data,
+                      [&grasp_candidates](std::vector<GraspCandidatePtr>& chunk) {
+                        grasp_candidates.insert(grasp_candidates.end(), chunk.begin(), chunk.end());
+                        return true;
+                      },
+                      std::numeric_limits<std::size_t>::max());
+}
+
+bool DatabaseGraspGenerator::streamGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width,
+                                          double height, const GraspDataPtr& grasp_data,
+                                          const GraspCandidatesCallback& callback, std::size_t chunk_size)
+{
+  stats_.clear();
+  const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+  double callback_duration = 0;
+
+  const GraspDatabaseEntry* entry = findObject(depth, width, height, grasp_data);
+  if (!entry)
+    return false;
+
+  // The stored postures only hold the joint positions, the rest of the message comes from the grasp data
+  std::vector<trajectory_msgs::msg::JointTrajectory> pre_grasp_postures(entry->num_postures_,
+                                                                        grasp_data->pre_grasp_posture_);
+  for (std::size_t i = 0; i < pre_grasp_postures.size(); ++i)
+  {
+    pre_grasp_postures[i].points.resize(1);
+    pre_grasp_postures[i].points[0].positions.assign(entry->posture_positions_[i],
+                                                     entry->posture_positions_[i] + entry->num_posture_joints_);
+  }
+
+  // All openings of a pose share its id, like the grasps of the other generators
+  const std::size_t first_grasp_id = reserveGraspIds(entry->num_pose_ids_);
+  const GraspDatabaseRecord* records = grasp_database_->getRecords(entry);
+  const rclcpp::Time stamp = nh_->get_clock()->now();
+
+  chunk_size = std::max<std::size_t>(chunk_size, 1);
+  GraspCandidateBatch grasp_candidate_batch(grasp_data, cuboid_pose);
+  std::vector<GraspCandidatePtr> chunk;
+  for (std::size_t begin = 0, end = 0; begin < entry->num_records_; begin = end)
+  {
+    end = begin + std::min<std::size_t>(chunk_size, entry->num_records_ - begin);
+    grasp_candidate_batch.clear();
+    for (std::size_t i = 0; i < pre_grasp_postures.size(); ++i)
+      grasp_candidate_batch.addPreGraspPosture(pre_grasp_postures[i], entry->posture_percent_opens_[i]);
+    grasp_candidate_batch.reserve(end - begin);
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      const GraspDatabaseRecord& record = records[i];
+      if (record.posture_index_ >= entry->num_postures_ || record.pose_id_ >= entry->num_pose_ids_)
+      {
+        RCLCPP_ERROR_STREAM(LOGGER, "Invalid grasp " << i << " of object " << entry->name_ << " in the database");
+        return false;
+      }
+      Eigen::Isometry3d grasp_pose(Eigen::Quaterniond(record.orientation_));
+      grasp_pose.translation() = Eigen::Map<const Eigen::Vector3d>(record.position_);
+      grasp_candidate_batch.addGrasp(cuboid_pose * grasp_pose, record.score_, record.posture_index_,
+                                     first_grasp_id + record.pose_id_);
+    }
+    chunk.clear();
+    grasp_candidate_batch.getGraspCandidates(chunk, stamp);
+
+    // The time spent in the callback is not part of the generation
+    const std::chrono::steady_clock::time_point callback_start_time = std::chrono::steady_clock::now();
+    const bool proceed = callback(chunk);
+    callback_duration +=
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - callback_start_time).count();
+    if (!proceed)
+      break;
+  }
+
+  stats_.duration_ =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count() - callback_duration;
+  stats_.addStageDuration(GENERATION, stats_.duration_);
+  return true;
+}
+
+const GraspDatabaseEntry* DatabaseGraspGenerator::findObject(double depth, double width, double height,
+                                                             const GraspDataPtr& grasp_data) const
+{
+  if (!grasp_database_ || !grasp_database_->isLoaded())
+  {
+    RCLCPP_ERROR(LOGGER, "No grasp database loaded");
+    return nullptr;
+  }
+  if (!grasp_data || grasp_database_->getEndEffectorName() != grasp_data->ee_jmg_->getName())
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "The grasp database was built for end effector "
+                                    << grasp_database_->getEndEffectorName() << ", not for the one of the grasp data");
+    return nullptr;
+  }
+
+  const GraspDatabaseEntry* entry = object_name_.empty() ?
+                                        grasp_database_->findObject(depth, width, height, dimension_tolerance_) :
+                                        grasp_database_->findObject(object_name_);
+  if (!entry)
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "No grasps in the database for object '" << object_name_ << "' of size " << depth
+                                                                         << " x " << width << " x " << height);
+    return nullptr;
+  }
+  if (entry->num_posture_joints_ != grasp_data->pre_grasp_posture_.joint_names.size())
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Pre grasp postures of object " << entry->name_ << " do not match the end effector");
+    return nullptr;
+  }
+  return entry;
+}
+
+}  // namespace moveit_grasps
@@ -223,8 +223,10 @@ public:
     grasp_generator_config.generate_z_axis_grasps_ = true;
 
     grasp_generator_->setGraspCandidateConfig(grasp_generator_config);
+    // The grasps are kept in a compact batch, GraspCandidates are only built while filtering
+    moveit_grasps::GraspCandidateBatch grasp_candidate_batch(grasp_data_, visual_tools_->convertPose(object_pose));
     if (!grasp_generator_->generateGrasps(visual_tools_->convertPose(object_pose), object_x_depth, object_y_width,
-                                          object_z_height, grasp_data_, grasp_candidates))
+                                          object_z_height, grasp_data_, grasp_candidate_batch))
     {
       RCLCPP_ERROR(rclcpp::get_logger(LOGNAME), "Grasp generator failed to generate any valid grasps");
       return false;
@@ -245,9 +247,10 @@ public:
     // --------------------------------------------
     // Filtering grasps
     // Note: This step also solves for the grasp and pre-grasp states and stores them in grasp candidates)
+    // Only the valid grasps are returned as candidates
     bool filter_pregrasps = true;
-    if (!grasp_filter_->filterGrasps(grasp_candidates, planning_scene_monitor_, arm_jmg_, seed_state, filter_pregrasps,
-                                     object_name))
+    if (!grasp_filter_->filterGrasps(grasp_candidate_batch, planning_scene_monitor_, arm_jmg_, seed_state,
+                                     filter_pregrasps, object_name, grasp_candidates))
     {
       RCLCPP_ERROR_STREAM(rclcpp::get_logger(LOGNAME), "Filter grasps failed");
       return false;
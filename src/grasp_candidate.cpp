@@ -114,4 +114,52 @@ bool GraspCandidate::isValid()
   return grasp_filtered_code_ == GraspFilterCode::NOT_FILTERED;
 }
 
+void GraspCandidate::compactCartesianTrajectories(const moveit::core::RobotStateConstPtr& reference_state)
+{
+  const moveit::core::JointModelGroup* arm_jmg = grasp_data_->arm_jmg_;
+  compact_cartesian_traj_.reference_state_ = reference_state;
+  compact_cartesian_traj_.arm_jmg_ = arm_jmg;
+  compact_cartesian_traj_.segment_positions_.resize(segmented_cartesian_traj_.size());
+  for (std::size_t segment = 0; segment < segmented_cartesian_traj_.size(); ++segment)
+  {
+    const std::vector<moveit::core::RobotStatePtr>& states = segmented_cartesian_traj_[segment];
+    Eigen::MatrixXd& positions = compact_cartesian_traj_.segment_positions_[segment];
+    positions.resize(arm_jmg->getVariableCount(), states.size());
+    for (std::size_t waypoint = 0; waypoint < states.size(); ++waypoint)
+      states[waypoint]->copyJointGroupPositions(arm_jmg, positions.col(waypoint).data());
+  }
+  segmented_cartesian_traj_.clear();
+}
+
+bool GraspCandidate::expandCartesianTrajectories()
+{
+  if (!segmented_cartesian_traj_.empty())
+    return true;
+  if (compact_cartesian_traj_.empty() || !compact_cartesian_traj_.reference_state_)
+  {
+    RCLCPP_ERROR_STREAM(grasp_candidate_logger, "No compact cartesian trajectories available to expand");
+    return false;
+  }
+
+  const moveit::core::JointModelGroup* arm_jmg = compact_cartesian_traj_.arm_jmg_;
+  segmented_cartesian_traj_.resize(compact_cartesian_traj_.segment_positions_.size());
+  for (std::size_t segment = 0; segment < segmented_cartesian_traj_.size(); ++segment)
+  {
+    const Eigen::MatrixXd& positions = compact_cartesian_traj_.segment_positions_[segment];
+    std::vector<moveit::core::RobotStatePtr>& states = segmented_cartesian_traj_[segment];
+    states.resize(positions.cols());
+    for (std::size_t waypoint = 0; waypoint < states.size(); ++waypoint)
+    {
+      states[waypoint] = std::make_shared<moveit::core::RobotState>(*compact_cartesian_traj_.reference_state_);
+      states[waypoint]->setJointGroupPositions(arm_jmg, positions.col(waypoint).data());
+      if (segment == APPROACH)
+        getGraspStateOpenEEOnly(states[waypoint]);
+      else
+        getGraspStateClosedEEOnly(states[waypoint]);
+      states[waypoint]->update();
+    }
+  }
+  return true;
+}
+
 }  // namespace moveit_grasps
@@ -0,0 +1,309 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+/* Desc:   Compact, structure of arrays storage for large numbers of generated grasp candidates
+*/
+
+#include <moveit_grasps/grasp_candidate_batch.h>
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+// ROS
+#include <tf2_eigen/tf2_eigen.h>
+
+namespace moveit_grasps
+{
+GraspCandidateBatch::GraspCandidateBatch(const GraspDataPtr& grasp_data, const Eigen::Isometry3d& cuboid_pose)
+  : grasp_data_(grasp_data), cuboid_pose_(cuboid_pose)
+{
+}
+
+void GraspCandidateBatch::clear()
+{
+  grasp_poses_.clear();
+  scores_.clear();
+  filter_codes_.clear();
+  pre_grasp_posture_ids_.clear();
+  ids_.clear();
+  ik_solution_size_ = 0;
+  grasp_ik_solutions_.clear();
+  pregrasp_ik_solutions_.clear();
+  pre_grasp_postures_.clear();
+  pre_grasp_percent_opens_.clear();
+}
+
+void GraspCandidateBatch::reserve(std::size_t num_grasps)
+{
+  grasp_poses_.reserve(num_grasps);
+  scores_.reserve(num_grasps);
+  filter_codes_.reserve(num_grasps);
+  pre_grasp_posture_ids_.reserve(num_grasps);
+  ids_.reserve(num_grasps);
+}
+
+void GraspCandidateBatch::resize(std::size_t num_grasps)
+{
+  grasp_poses_.resize(num_grasps);
+  scores_.resize(num_grasps);
+  filter_codes_.resize(num_grasps, GraspFilterCode::NOT_FILTERED);
+  pre_grasp_posture_ids_.resize(num_grasps);
+  ids_.resize(num_grasps);
+  if (ik_solution_size_)
+  {
+    grasp_ik_solutions_.resize(num_grasps * ik_solution_size_, std::numeric_limits<double>::quiet_NaN());
+    pregrasp_ik_solutions_.resize(num_grasps * ik_solution_size_, std::numeric_limits<double>::quiet_NaN());
+  }
+}
+
+std::size_t GraspCandidateBatch::addPreGraspPosture(const trajectory_msgs::msg::JointTrajectory& pre_grasp_posture,
+                                                    double percent_open)
+{
+  pre_grasp_postures_.push_back(pre_grasp_posture);
+  pre_grasp_percent_opens_.push_back(percent_open);
+  return pre_grasp_postures_.size() - 1;
+}
+
+void GraspCandidateBatch::addGrasp(const Eigen::Isometry3d& grasp_pose_eef_mount, double score,
+                                   std::size_t pre_grasp_posture_id, std::size_t id)
+{
+  grasp_poses_.push_back(grasp_pose_eef_mount);
+  scores_.push_back(score);
+  filter_codes_.push_back(GraspFilterCode::NOT_FILTERED);
+  pre_grasp_posture_ids_.push_back(static_cast<std::uint16_t>(pre_grasp_posture_id));
+  ids_.push_back(id);
+  if (ik_solution_size_)
+  {
+    grasp_ik_solutions_.resize(grasp_poses_.size() * ik_solution_size_, std::numeric_limits<double>::quiet_NaN());
+    pregrasp_ik_solutions_.resize(grasp_poses_.size() * ik_solution_size_, std::numeric_limits<double>::quiet_NaN());
+  }
+}
+
+void GraspCandidateBatch::setGrasp(std::size_t index, const Eigen::Isometry3d& grasp_pose_eef_mount, double score,
+                                   std::size_t pre_grasp_posture_id, std::size_t id)
+{
+  grasp_poses_[index] = grasp_pose_eef_mount;
+  scores_[index] = score;
+  pre_grasp_posture_ids_[index] = static_cast<std::uint16_t>(pre_grasp_posture_id);
+  ids_[index] = id;
+}
+
+void GraspCandidateBatch::append(const GraspCandidateBatch& other)
+{
+  const std::size_t posture_offset = pre_grasp_postures_.size();
+  pre_grasp_postures_.insert(pre_grasp_postures_.end(), other.pre_grasp_postures_.begin(),
+                             other.pre_grasp_postures_.end());
+  pre_grasp_percent_opens_.insert(pre_grasp_percent_opens_.end(), other.pre_grasp_percent_opens_.begin(),
+                                  other.pre_grasp_percent_opens_.end());
+
+  reserve(size() + other.size());
+  for (std::size_t i = 0; i < other.size(); ++i)
+  {
+    addGrasp(other.grasp_poses_[i], other.scores_[i], posture_offset + other.pre_grasp_posture_ids_[i],
+             other.ids_[i]);
+    filter_codes_.back() = other.filter_codes_[i];
+  }
+
+  if (other.ik_solution_size_)
+  {
+    std::vector<double> solution;
+    for (std::size_t i = 0; i < other.size(); ++i)
+    {
+      if (other.getGraspIKSolution(i, solution))
+        setGraspIKSolution(size() - other.size() + i, solution);
+      if (other.getPreGraspIKSolution(i, solution))
+        setPreGraspIKSolution(size() - other.size() + i, solution);
+    }
+  }
+}
+
+void GraspCandidateBatch::sortByScore()
+{
+  std::vector<std::size_t> order(size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [this](std::size_t a, std::size_t b) { return scores_[a] > scores_[b]; });
+
+  EigenSTL::vector_Isometry3d grasp_poses(size());
+  std::vector<double> scores(size());
+  std::vector<int> filter_codes(size());
+  std::vector<std::uint16_t> pre_grasp_posture_ids(size());
+  std::vector<std::size_t> ids(size());
+  std::vector<double> grasp_ik_solutions(grasp_ik_solutions_.size());
+  std::vector<double> pregrasp_ik_solutions(pregrasp_ik_solutions_.size());
+  for (std::size_t i = 0; i < order.size(); ++i)
+  {
+    grasp_poses[i] = grasp_poses_[order[i]];
+    scores[i] = scores_[order[i]];
+    filter_codes[i] = filter_codes_[order[i]];
+    pre_grasp_posture_ids[i] = pre_grasp_posture_ids_[order[i]];
+    ids[i] = ids_[order[i]];
+    if (ik_solution_size_)
+    {
+      std::copy_n(grasp_ik_solutions_.begin() + order[i] * ik_solution_size_, ik_solution_size_,
+                  grasp_ik_solutions.begin() + i * ik_solution_size_);
+      std::copy_n(pregrasp_ik_solutions_.begin() + order[i] * ik_solution_size_, ik_solution_size_,
+                  pregrasp_ik_solutions.begin() + i * ik_solution_size_);
+    }
+  }
+  grasp_poses_.swap(grasp_poses);
+  scores_.swap(scores);
+  filter_codes_.swap(filter_codes);
+  pre_grasp_posture_ids_.swap(pre_grasp_posture_ids);
+  ids_.swap(ids);
+  grasp_ik_solutions_.swap(grasp_ik_solutions);
+  pregrasp_ik_solutions_.swap(pregrasp_ik_solutions);
+}
+
+void GraspCandidateBatch::setGraspIKSolution(std::size_t index, const std::vector<double>& solution)
+{
+  setIKSolution(grasp_ik_solutions_, index, solution);
+}
+
+bool GraspCandidateBatch::getGraspIKSolution(std::size_t index, std::vector<double>& solution) const
+{
+  return getIKSolution(grasp_ik_solutions_, index, solution);
+}
+
+void GraspCandidateBatch::setPreGraspIKSolution(std::size_t index, const std::vector<double>& solution)
+{
+  setIKSolution(pregrasp_ik_solutions_, index, solution);
+}
+
+bool GraspCandidateBatch::getPreGraspIKSolution(std::size_t index, std::vector<double>& solution) const
+{
+  return getIKSolution(pregrasp_ik_solutions_, index, solution);
+}
+
+void GraspCandidateBatch::setIKSolution(std::vector<double>& solutions, std::size_t index,
+                                        const std::vector<double>& solution)
+{
+  if (solution.empty())
+    return;
+
+  // Allocate the solution tables on first use, unset rows are marked with NaN
+  if (!ik_solution_size_)
+  {
+    ik_solution_size_ = solution.size();
+    grasp_ik_solutions_.assign(size() * ik_solution_size_, std::numeric_limits<double>::quiet_NaN());
+    pregrasp_ik_solutions_.assign(size() * ik_solution_size_, std::numeric_limits<double>::quiet_NaN());
+  }
+  else if (solution.size() != ik_solution_size_)
+  {
+    RCLCPP_ERROR_STREAM(rclcpp::get_logger("grasp_candidate_batch"),
+                        "IK solution has " << solution.size() << " values, expected " << ik_solution_size_);
+    return;
+  }
+  std::copy(solution.begin(), solution.end(), solutions.begin() + index * ik_solution_size_);
+}
+
+bool GraspCandidateBatch::getIKSolution(const std::vector<double>& solutions, std::size_t index,
+                                        std::vector<double>& solution) const
+{
+  solution.clear();
+  if (!ik_solution_size_ || std::isnan(solutions[index * ik_solution_size_]))
+    return false;
+
+  solution.assign(solutions.begin() + index * ik_solution_size_,
+                  solutions.begin() + (index + 1) * ik_solution_size_);
+  return true;
+}
+
+moveit_msgs::msg::Grasp GraspCandidateBatch::getGraspMsg(std::size_t index, const rclcpp::Time& stamp) const
+{
+  moveit_msgs::msg::Grasp grasp;
+
+  // Approach and retreat - aligned with eef to grasp transform
+  Eigen::Vector3d grasp_approach_vector = -1 * grasp_data_->tcp_to_eef_mount_.translation();
+  grasp_approach_vector = grasp_approach_vector / grasp_approach_vector.norm();
+
+  // set pregrasp
+  grasp.pre_grasp_approach.direction.header.stamp = stamp;
+  grasp.pre_grasp_approach.desired_distance = grasp_data_->grasp_max_depth_ + grasp_data_->approach_distance_desired_;
+  grasp.pre_grasp_approach.min_distance = 0;  // NOT IMPLEMENTED
+  grasp.pre_grasp_approach.direction.header.frame_id = grasp_data_->parent_link_->getName();
+  grasp.pre_grasp_approach.direction.vector.x = grasp_approach_vector.x();
+  grasp.pre_grasp_approach.direction.vector.y = grasp_approach_vector.y();
+  grasp.pre_grasp_approach.direction.vector.z = grasp_approach_vector.z();
+
+  // set postgrasp
+  grasp.post_grasp_retreat.direction.header.stamp = stamp;
+  grasp.post_grasp_retreat.desired_distance = grasp_data_->grasp_max_depth_ + grasp_data_->retreat_distance_desired_;
+  grasp.post_grasp_retreat.min_distance = 0;  // NOT IMPLEMENTED
+  grasp.post_grasp_retreat.direction.header.frame_id = grasp_data_->parent_link_->getName();
+  grasp.post_grasp_retreat.direction.vector.x = -1 * grasp_approach_vector.x();
+  grasp.post_grasp_retreat.direction.vector.y = -1 * grasp_approach_vector.y();
+  grasp.post_grasp_retreat.direction.vector.z = -1 * grasp_approach_vector.z();
+
+  // set grasp pose
+  grasp.grasp_pose.header.stamp = stamp;
+  grasp.grasp_pose.header.frame_id = grasp_data_->base_link_;
+  grasp.grasp_pose.pose = Eigen::toMsg(grasp_poses_[index]);
+
+  grasp.id = "Grasp" + std::to_string(ids_[index]);
+  grasp.grasp_quality = scores_[index];
+
+  // set grasp postures
+  grasp.grasp_posture = grasp_data_->grasp_posture_;
+  grasp.pre_grasp_posture = getPreGraspPosture(index);
+
+  return grasp;
+}
+
+GraspCandidatePtr GraspCandidateBatch::getGraspCandidate(std::size_t index, const rclcpp::Time& stamp) const
+{
+  auto grasp_candidate = std::make_shared<GraspCandidate>(getGraspMsg(index, stamp), grasp_data_, cuboid_pose_);
+  grasp_candidate->grasp_filtered_code_ = filter_codes_[index];
+  getGraspIKSolution(index, grasp_candidate->grasp_ik_solution_);
+  getPreGraspIKSolution(index, grasp_candidate->pregrasp_ik_solution_);
+  return grasp_candidate;
+}
+
+void GraspCandidateBatch::getGraspCandidates(std::vector<GraspCandidatePtr>& grasp_candidates,
+                                             const rclcpp::Time& stamp, bool only_valid) const
+{
+  grasp_candidates.reserve(grasp_candidates.size() + size());
+  for (std::size_t i = 0; i < size(); ++i)
+  {
+    if (only_valid && filter_codes_[i] != GraspFilterCode::NOT_FILTERED)
+      continue;
+    grasp_candidates.push_back(getGraspCandidate(i, stamp));
+  }
+}
+
+}  // namespace moveit_grasps
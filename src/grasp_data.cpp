@@ -57,7 +57,11 @@ namespace moveit_grasps
 {
 GraspData::GraspData(const rclcpp::Node::SharedPtr nh, const std::string& end_effector,
                      const moveit::core::RobotModelConstPtr& robot_model)
-  : base_link_("/base_link"), robot_model_(robot_model), grasp_data_logger(rclcpp::get_logger("grasp_data"))
+  : pre_grasp_offset_(Eigen::Isometry3d::Identity())
+  , post_grasp_retreat_offset_(Eigen::Isometry3d::Identity())
+  , base_link_("/base_link")
+  , robot_model_(robot_model)
+  , grasp_data_logger(rclcpp::get_logger("grasp_data"))
 {
 }
 
@@ -168,9 +172,23 @@ bool GraspData::loadGraspData(const rclcpp::Node::SharedPtr nh, const std::strin
     tcp_to_eef_mount_ = tcp_mount_pose.inverse() * eef_mount_pose;
   }
 
+  computeApproachOffsets();
+
   return true;
 }
 
+void GraspData::computeApproachOffsets()
+{
+  // The generated grasps approach along the tcp to eef mount direction, given in the frame of the eef mount
+  const Eigen::Vector3d approach_direction = (-1 * tcp_to_eef_mount_.translation()).normalized();
+  pre_grasp_offset_ =
+      Eigen::Translation3d(-approach_direction * (grasp_max_depth_ + approach_distance_desired_)) *
+      Eigen::Isometry3d::Identity();
+  post_grasp_retreat_offset_ =
+      Eigen::Translation3d(-approach_direction * (grasp_max_depth_ + retreat_distance_desired_)) *
+      Eigen::Isometry3d::Identity();
+}
+
 bool GraspData::setRobotStatePreGrasp(moveit::core::RobotStatePtr& robot_state)
 {
   RCLCPP_WARN_STREAM(grasp_data_logger, "setRobotStatePreGrasp is probably wrong");
@@ -0,0 +1,343 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Memory mapped database of grasps precomputed offline for a catalog of known objects
+*/
+
+#include <moveit_grasps/grasp_database.h>
+
+// C++
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+// POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace moveit_grasps
+{
+namespace
+{
+const char MAGIC[4] = { 'M', 'G', 'D', 'B' };
+const std::uint32_t VERSION = 1;
+
+bool copyName(const std::string& name, char (&destination)[GRASP_DATABASE_MAX_NAME_LENGTH])
+{
+  if (name.empty() || name.size() >= GRASP_DATABASE_MAX_NAME_LENGTH)
+    return false;
+  std::memset(destination, 0, GRASP_DATABASE_MAX_NAME_LENGTH);
+  std::memcpy(destination, name.data(), name.size());
+  return true;
+}
+
+}  // namespace
+
+GraspDatabaseBuilder::GraspDatabaseBuilder(const std::string& end_effector_name)
+  : LOGGER(rclcpp::get_logger("grasp_database")), end_effector_name_(end_effector_name)
+{
+}
+
+bool GraspDatabaseBuilder::addObject(const std::string& name, double depth, double width, double height,
+                                     const GraspCandidateBatch& grasp_candidate_batch)
+{
+  GraspDatabaseEntry entry{};
+  if (!copyName(name, entry.name_))
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Object name '" << name << "' must have 1 to " << GRASP_DATABASE_MAX_NAME_LENGTH - 1
+                                                << " characters");
+    return false;
+  }
+  for (const GraspDatabaseEntry& other : entries_)
+  {
+    if (std::strncmp(other.name_, entry.name_, GRASP_DATABASE_MAX_NAME_LENGTH) == 0)
+    {
+      RCLCPP_ERROR_STREAM(LOGGER, "Object " << name << " was already added");
+      return false;
+    }
+  }
+
+  const std::size_t num_posture_joints = grasp_candidate_batch.getGraspData()->pre_grasp_posture_.joint_names.size();
+  if (num_posture_joints > GRASP_DATABASE_MAX_POSTURE_JOINTS)
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "End effectors with more than " << GRASP_DATABASE_MAX_POSTURE_JOINTS
+                                                                << " joints are not supported");
+    return false;
+  }
+  entry.depth_ = depth;
+  entry.width_ = width;
+  entry.height_ = height;
+  entry.num_posture_joints_ = static_cast<std::uint16_t>(num_posture_joints);
+
+  // Store the grasps by descending score, so that they can be streamed in order
+  std::vector<std::size_t> order(grasp_candidate_batch.size());
+  std::iota(order.begin(), order.end(), 0);
+  const std::vector<double>& scores = grasp_candidate_batch.getScores();
+  std::stable_sort(order.begin(), order.end(),
+                   [&scores](std::size_t a, std::size_t b) { return scores[a] > scores[b]; });
+
+  const Eigen::Isometry3d object_to_world = grasp_candidate_batch.getCuboidPose().inverse();
+  std::unordered_map<std::size_t, std::uint32_t> pose_ids;
+  std::vector<GraspDatabaseRecord> records;
+  records.reserve(order.size());
+  for (std::size_t index : order)
+  {
+    if (grasp_candidate_batch.getFilterCode(index) != GraspFilterCode::NOT_FILTERED)
+      continue;
+
+    // The batch repeats the postures of every pose set, only the distinct ones are stored
+    const trajectory_msgs::msg::JointTrajectory& posture = grasp_candidate_batch.getPreGraspPosture(index);
+    if (posture.points.empty() || posture.points[0].positions.size() != num_posture_joints)
+    {
+      RCLCPP_ERROR_STREAM(LOGGER, "Pre grasp posture of object " << name << " does not match the end effector");
+      return false;
+    }
+    const std::vector<double>& positions = posture.points[0].positions;
+    std::size_t posture_index = 0;
+    while (posture_index < entry.num_postures_ &&
+           !std::equal(positions.begin(), positions.end(), entry.posture_positions_[posture_index]))
+      ++posture_index;
+    if (posture_index == entry.num_postures_)
+    {
+      if (entry.num_postures_ == GRASP_DATABASE_MAX_POSTURES)
+      {
+        RCLCPP_ERROR_STREAM(LOGGER, "Object " << name << " has more than " << GRASP_DATABASE_MAX_POSTURES
+                                              << " distinct pre grasp postures");
+        return false;
+      }
+      std::copy(positions.begin(), positions.end(), entry.posture_positions_[posture_index]);
+      entry.posture_percent_opens_[posture_index] = grasp_candidate_batch.getPreGraspPercentOpen(index);
+      ++entry.num_postures_;
+    }
+
+    GraspDatabaseRecord record{};
+    const Eigen::Isometry3d grasp_pose = object_to_world * grasp_candidate_batch.getGraspPoses()[index];
+    const Eigen::Quaterniond orientation(grasp_pose.rotation());
+    Eigen::Map<Eigen::Vector3d>(record.position_) = grasp_pose.translation();
+    Eigen::Map<Eigen::Vector4d>(record.orientation_) = orientation.coeffs();
+    record.score_ = scores[index];
+    record.pose_id_ = pose_ids.emplace(grasp_candidate_batch.getId(index), pose_ids.size()).first->second;
+    record.posture_index_ = static_cast<std::uint16_t>(posture_index);
+    records.push_back(record);
+  }
+  entry.num_records_ = records.size();
+  entry.num_pose_ids_ = static_cast<std::uint32_t>(pose_ids.size());
+
+  entries_.push_back(entry);
+  records_.push_back(std::move(records));
+  RCLCPP_DEBUG_STREAM(LOGGER, "Added " << entry.num_records_ << " grasps of object " << name);
+  return true;
+}
+
+bool GraspDatabaseBuilder::saveToFile(const std::string& filename) const
+{
+  GraspDatabaseHeader header{};
+  if (!copyName(end_effector_name_, header.end_effector_))
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Invalid end effector name '" << end_effector_name_ << "'");
+    return false;
+  }
+  std::copy(MAGIC, MAGIC + sizeof(MAGIC), header.magic_);
+  header.version_ = VERSION;
+  header.num_entries_ = entries_.size();
+
+  // Entries are sorted by name for the lookup, the records follow in the same order
+  std::vector<std::size_t> order(entries_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+    return std::strncmp(entries_[a].name_, entries_[b].name_, GRASP_DATABASE_MAX_NAME_LENGTH) < 0;
+  });
+  std::vector<GraspDatabaseEntry> entries;
+  entries.reserve(entries_.size());
+  for (std::size_t index : order)
+  {
+    entries.push_back(entries_[index]);
+    entries.back().first_record_ = header.num_records_;
+    header.num_records_ += entries_[index].num_records_;
+  }
+
+  std::ofstream out(filename, std::ios::binary);
+  if (!out)
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Unable to open " << filename << " for writing");
+    return false;
+  }
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(GraspDatabaseEntry));
+  for (std::size_t index : order)
+  {
+    out.write(reinterpret_cast<const char*>(records_[index].data()),
+              records_[index].size() * sizeof(GraspDatabaseRecord));
+  }
+
+  if (!out)
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Failed writing grasp database to " << filename);
+    return false;
+  }
+  RCLCPP_INFO_STREAM(LOGGER, "Saved " << header.num_records_ << " grasps of " << header.num_entries_ << " objects to "
+                                      << filename);
+  return true;
+}
+
+GraspDatabase::GraspDatabase() : LOGGER(rclcpp::get_logger("grasp_database"))
+{
+}
+
+GraspDatabase::~GraspDatabase()
+{
+  close();
+}
+
+bool GraspDatabase::loadFromFile(const std::string& filename)
+{
+  close();
+
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Unable to open grasp database " << filename << ": " << std::strerror(errno));
+    return false;
+  }
+  struct stat file_stat;
+  if (::fstat(fd, &file_stat) != 0 || static_cast<std::size_t>(file_stat.st_size) < sizeof(GraspDatabaseHeader))
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, filename << " is too small to be a grasp database");
+    ::close(fd);
+    return false;
+  }
+
+  // The mapping stays valid after closing the file
+  size_ = file_stat.st_size;
+  data_ = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data_ == MAP_FAILED)
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Unable to map grasp database " << filename << ": " << std::strerror(errno));
+    data_ = nullptr;
+    size_ = 0;
+    return false;
+  }
+
+  // Only the tables are checked, the records are not touched until they are streamed
+  const auto* header = static_cast<const GraspDatabaseHeader*>(data_);
+  const std::size_t max_entries = size_ / sizeof(GraspDatabaseEntry);
+  const std::size_t max_records = size_ / sizeof(GraspDatabaseRecord);
+  if (!std::equal(MAGIC, MAGIC + sizeof(MAGIC), header->magic_) || header->version_ != VERSION ||
+      header->num_entries_ > max_entries || header->num_records_ > max_records ||
+      size_ != sizeof(GraspDatabaseHeader) + header->num_entries_ * sizeof(GraspDatabaseEntry) +
+                   header->num_records_ * sizeof(GraspDatabaseRecord) ||
+      !std::memchr(header->end_effector_, '\0', GRASP_DATABASE_MAX_NAME_LENGTH))
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, filename << " is not a grasp database of version " << VERSION);
+    close();
+    return false;
+  }
+
+  const auto* entries = reinterpret_cast<const GraspDatabaseEntry*>(header + 1);
+  for (std::size_t i = 0; i < header->num_entries_; ++i)
+  {
+    const GraspDatabaseEntry& entry = entries[i];
+    if (!std::memchr(entry.name_, '\0', GRASP_DATABASE_MAX_NAME_LENGTH) ||
+        entry.first_record_ > header->num_records_ || entry.num_records_ > header->num_records_ - entry.first_record_ ||
+        entry.num_postures_ > GRASP_DATABASE_MAX_POSTURES ||
+        entry.num_posture_joints_ > GRASP_DATABASE_MAX_POSTURE_JOINTS)
+    {
+      RCLCPP_ERROR_STREAM(LOGGER, "Grasp database " << filename << " has an invalid entry " << i);
+      close();
+      return false;
+    }
+  }
+
+  header_ = header;
+  entries_ = entries;
+  records_ = reinterpret_cast<const GraspDatabaseRecord*>(entries + header->num_entries_);
+  RCLCPP_INFO_STREAM(LOGGER, "Mapped " << header_->num_records_ << " grasps of " << header_->num_entries_
+                                       << " objects from " << filename);
+  return true;
+}
+
+void GraspDatabase::close()
+{
+  if (data_)
+    ::munmap(data_, size_);
+  data_ = nullptr;
+  size_ = 0;
+  header_ = nullptr;
+  entries_ = nullptr;
+  records_ = nullptr;
+}
+
+const GraspDatabaseEntry* GraspDatabase::findObject(const std::string& name) const
+{
+  if (!header_)
+    return nullptr;
+
+  const GraspDatabaseEntry* end = entries_ + header_->num_entries_;
+  const GraspDatabaseEntry* entry =
+      std::lower_bound(entries_, end, name, [](const GraspDatabaseEntry& entry, const std::string& name) {
+        return std::strncmp(entry.name_, name.c_str(), GRASP_DATABASE_MAX_NAME_LENGTH) < 0;
+      });
+  if (entry == end || name.size() >= GRASP_DATABASE_MAX_NAME_LENGTH || name != entry->name_)
+    return nullptr;
+  return entry;
+}
+
+const GraspDatabaseEntry* GraspDatabase::findObject(double depth, double width, double height,
+                                                    double tolerance) const
+{
+  const GraspDatabaseEntry* closest_entry = nullptr;
+  double closest_difference = std::numeric_limits<double>::max();
+  for (std::size_t i = 0; i < getNumObjects(); ++i)
+  {
+    const GraspDatabaseEntry& entry = entries_[i];
+    const double difference = std::max({ std::abs(entry.depth_ - depth), std::abs(entry.width_ - width),
+                                         std::abs(entry.height_ - height) });
+    if (difference <= tolerance && difference < closest_difference)
+    {
+      closest_entry = &entry;
+      closest_difference = difference;
+    }
+  }
+  return closest_entry;
+}
+
+}  // namespace moveit_grasps
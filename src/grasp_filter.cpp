@@ -48,11 +48,36 @@
 #include <tf2_eigen/tf2_eigen.h>
 
 // Parameter loading
-#include <omp.h>
 #include <rosparam_shortcuts/rosparam_shortcuts.h>
 
+// C++
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <utility>
+
 namespace moveit_grasps
 {
+namespace
+{
+/**
+ * \brief Validity callback that only holds the checker and the report, so it reads the current scene of the checker
+ */
+template <typename CollisionReport>
+moveit::core::GroupStateValidityCallbackFn makeStateValidityCallback(const StateValidityChecker* checker,
+                                                                     const CollisionReport& report)
+{
+  return [checker, report](moveit::core::RobotState* robot_state, const moveit::core::JointModelGroup* group,
+                           const double* ik_solution) {
+    return checkGraspState(checker->planning_scene_, checker->ee_jmg_, report, robot_state, group, ik_solution);
+  };
+}
+}  // namespace
+
 // Constructor
 GraspFilter::GraspFilter(rclcpp::Node::SharedPtr node, const moveit::core::RobotStatePtr& robot_state,
                          const moveit_visual_tools::MoveItVisualToolsPtr& visual_tools)
@@ -60,6 +85,7 @@ GraspFilter::GraspFilter(rclcpp::Node::SharedPtr node, const moveit::core::Robot
   , LOGGER_SUPERDEBUG(rclcpp::get_logger("grasp_filter.superdebug"))
   , LOGGER_FILTER_STATISTIC(rclcpp::get_logger("grasp_filter.filter_statistics"))
   , LOGGER_FILTER_BY_PLANE(rclcpp::get_logger("filter_by_plane"))
+  , ik_worker_pool_(std::make_shared<IkWorkerPool>())
   , visual_tools_(visual_tools)
   , nh_(rclcpp::Node::make_shared("moveit_grasps_filter", node->get_namespace()))
 {
@@ -113,6 +139,8 @@ bool GraspFilter::filterGrasps(std::vector<GraspCandidatePtr>& grasp_candidates,
                                const std::string& target_object_id)
 {
   bool verbose = false;
+  stats_.clear();
+  const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
 
   // Error check
   if (grasp_candidates.empty())
@@ -120,6 +148,154 @@ bool GraspFilter::filterGrasps(std::vector<GraspCandidatePtr>& grasp_candidates,
     RCLCPP_ERROR(LOGGER, "Unable to filter grasps because vector is empty");
     return false;
   }
+  if (!prepareFilter(arm_jmg, filter_pregrasp))
+    return false;
+
+  // Try to filter grasps not in verbose mode
+  std::size_t remaining_grasps = filterGraspsHelper(grasp_candidates, planning_scene, arm_jmg, seed_state,
+                                                    filter_pregrasp, verbose, target_object_id);
+
+  // Print stats
+  printFilterStatistics(grasp_candidates);
+
+  if (remaining_grasps == 0)
+  {
+    RCLCPP_INFO_STREAM(LOGGER, "Grasp filters removed all grasps");
+    if (show_grasp_filter_collision_if_failed_)
+    {
+      RCLCPP_INFO_STREAM(LOGGER, "Re-running in verbose mode since it failed");
+      verbose = true;
+      remaining_grasps = filterGraspsHelper(grasp_candidates, planning_scene, arm_jmg, seed_state, filter_pregrasp,
+                                            verbose, target_object_id);
+    }
+    else
+      RCLCPP_INFO_STREAM(LOGGER, "NOT re-running in verbose mode");
+  }
+  stats_.duration_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+  // Visualize valid grasps as arrows with cartesian path as well
+  if (show_filtered_grasps_)
+  {
+    RCLCPP_INFO_STREAM(LOGGER, "Showing filtered grasps");
+    visualizeGrasps(grasp_candidates, arm_jmg);
+  }
+
+  // Visualize valid grasp as arm positions
+  if (show_filtered_arm_solutions_)
+  {
+    RCLCPP_INFO_STREAM(LOGGER, "Showing filtered arm solutions");
+    visualizeCandidateGrasps(grasp_candidates);
+  }
+
+  if (grasp_candidates.empty())
+  {
+    RCLCPP_WARN_STREAM(LOGGER, "No grasps remaining after filtering");
+    return false;
+  }
+
+  return true;
+}
+
+bool GraspFilter::filterGrasps(GraspCandidateBatch& grasp_candidate_batch,
+                               const planning_scene_monitor::PlanningSceneMonitorPtr& planning_scene_monitor,
+                               const moveit::core::JointModelGroup* arm_jmg,
+                               const moveit::core::RobotStatePtr& seed_state, bool filter_pregrasp,
+                               const std::string& target_object_id,
+                               std::vector<GraspCandidatePtr>& valid_grasp_candidates, std::size_t chunk_size)
+{
+  planning_scene::PlanningScenePtr planning_scene;
+  {
+    planning_scene_monitor::LockedPlanningSceneRO scene(planning_scene_monitor);
+    planning_scene = planning_scene::PlanningScene::clone(scene);
+  }
+  return filterGrasps(grasp_candidate_batch, planning_scene, arm_jmg, seed_state, filter_pregrasp, target_object_id,
+                      valid_grasp_candidates, chunk_size);
+}
+
+bool GraspFilter::filterGrasps(GraspCandidateBatch& grasp_candidate_batch,
+                               const planning_scene::PlanningScenePtr& planning_scene,
+                               const moveit::core::JointModelGroup* arm_jmg,
+                               const moveit::core::RobotStatePtr& seed_state, bool filter_pregrasp,
+                               const std::string& target_object_id,
+                               std::vector<GraspCandidatePtr>& valid_grasp_candidates, std::size_t chunk_size)
+{
+  stats_.clear();
+  const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+  // Error check
+  if (grasp_candidate_batch.empty())
+  {
+    RCLCPP_ERROR(LOGGER, "Unable to filter grasps because batch is empty");
+    return false;
+  }
+  if (!prepareFilter(arm_jmg, filter_pregrasp))
+    return false;
+
+  chunk_size = std::max<std::size_t>(chunk_size, 1);
+  const rclcpp::Time stamp = nh_->get_clock()->now();
+  const std::size_t num_valid_before = valid_grasp_candidates.size();
+  std::vector<GraspCandidatePtr> chunk;
+  std::size_t begin = 0;
+  for (; begin < grasp_candidate_batch.size(); begin += chunk_size)
+  {
+    if (max_valid_grasps_ > 0 && valid_grasp_candidates.size() - num_valid_before >= max_valid_grasps_)
+      break;
+
+    // Grasps already filtered in the batch keep their code and are skipped by the helper
+    const std::size_t end = std::min(begin + chunk_size, grasp_candidate_batch.size());
+    chunk.clear();
+    for (std::size_t i = begin; i < end; ++i)
+      chunk.push_back(grasp_candidate_batch.getGraspCandidate(i, stamp));
+    filterGraspsHelper(chunk, planning_scene, arm_jmg, seed_state, filter_pregrasp, false, target_object_id);
+
+    // The invalid candidates of the chunk are released, their results are kept in the batch
+    for (std::size_t i = 0; i < chunk.size(); ++i)
+    {
+      grasp_candidate_batch.setFilterCode(begin + i, chunk[i]->grasp_filtered_code_);
+      grasp_candidate_batch.setGraspIKSolution(begin + i, chunk[i]->grasp_ik_solution_);
+      grasp_candidate_batch.setPreGraspIKSolution(begin + i, chunk[i]->pregrasp_ik_solution_);
+      if (chunk[i]->isValid())
+        valid_grasp_candidates.push_back(chunk[i]);
+    }
+  }
+
+  // Mark the grasps of the skipped chunks
+  for (std::size_t i = begin; i < grasp_candidate_batch.size(); ++i)
+    if (grasp_candidate_batch.getFilterCode(i) == GraspFilterCode::NOT_FILTERED)
+      grasp_candidate_batch.setFilterCode(i, GraspFilterCode::GRASP_FILTERED_BY_EARLY_EXIT);
+
+  const std::size_t num_valid = valid_grasp_candidates.size() - num_valid_before;
+  RCLCPP_INFO_STREAM(LOGGER, num_valid << " of " << grasp_candidate_batch.size() << " grasps of the batch are valid");
+  stats_.duration_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+  if (num_valid == 0)
+  {
+    RCLCPP_WARN_STREAM(LOGGER, "No grasps remaining after filtering");
+    return false;
+  }
+
+  const std::vector<GraspCandidatePtr> new_valid_grasp_candidates(valid_grasp_candidates.begin() + num_valid_before,
+                                                                  valid_grasp_candidates.end());
+
+  // Visualize valid grasps as arrows with cartesian path as well
+  if (show_filtered_grasps_)
+  {
+    RCLCPP_INFO_STREAM(LOGGER, "Showing filtered grasps");
+    visualizeGrasps(new_valid_grasp_candidates, arm_jmg);
+  }
+
+  // Visualize valid grasp as arm positions
+  if (show_filtered_arm_solutions_)
+  {
+    RCLCPP_INFO_STREAM(LOGGER, "Showing filtered arm solutions");
+    visualizeCandidateGrasps(new_valid_grasp_candidates);
+  }
+
+  return true;
+}
+
+bool GraspFilter::prepareFilter(const moveit::core::JointModelGroup* arm_jmg, bool filter_pregrasp)
+{
   if (!filter_pregrasp)
     RCLCPP_WARN_STREAM(LOGGER, "Not filtering pre-grasp - GraspCandidate may have bad data");
 
@@ -145,27 +321,46 @@ bool GraspFilter::filterGrasps(std::vector<GraspCandidatePtr>& grasp_candidates,
     RCLCPP_ERROR_STREAM(LOGGER, "More than one end effectors attached to this arm");
     return false;
   }
+  return true;
+}
 
-  // Try to filter grasps not in verbose mode
-  std::size_t remaining_grasps = filterGraspsHelper(grasp_candidates, planning_scene, arm_jmg, seed_state,
-                                                    filter_pregrasp, verbose, target_object_id);
+bool GraspFilter::filterGrasps(std::vector<ObjectGraspCandidates>& object_grasp_candidates,
+                               const planning_scene_monitor::PlanningSceneMonitorPtr& planning_scene_monitor,
+                               const moveit::core::JointModelGroup* arm_jmg,
+                               const moveit::core::RobotStatePtr& seed_state, bool filter_pregrasp)
+{
+  planning_scene::PlanningScenePtr planning_scene;
+  {
+    planning_scene_monitor::LockedPlanningSceneRO scene(planning_scene_monitor);
+    planning_scene = planning_scene::PlanningScene::clone(scene);
+  }
+  return filterGrasps(object_grasp_candidates, planning_scene, arm_jmg, seed_state, filter_pregrasp);
+}
 
-  // Print stats
-  printFilterStatistics(grasp_candidates);
+bool GraspFilter::filterGrasps(std::vector<ObjectGraspCandidates>& object_grasp_candidates,
+                               const planning_scene::PlanningScenePtr& planning_scene,
+                               const moveit::core::JointModelGroup* arm_jmg,
+                               const moveit::core::RobotStatePtr& seed_state, bool filter_pregrasp)
+{
+  stats_.clear();
+  const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
 
-  if (remaining_grasps == 0)
+  if (object_grasp_candidates.empty())
   {
-    RCLCPP_INFO_STREAM(LOGGER, "Grasp filters removed all grasps");
-    if (show_grasp_filter_collision_if_failed_)
-    {
-      RCLCPP_INFO_STREAM(LOGGER, "Re-running in verbose mode since it failed");
-      verbose = true;
-      remaining_grasps = filterGraspsHelper(grasp_candidates, planning_scene, arm_jmg, seed_state, filter_pregrasp,
-                                            verbose, target_object_id);
-    }
-    else
-      RCLCPP_INFO_STREAM(LOGGER, "NOT re-running in verbose mode");
+    RCLCPP_ERROR(LOGGER, "Unable to filter grasps because no objects were passed");
+    return false;
   }
+  if (!prepareFilter(arm_jmg, filter_pregrasp))
+    return false;
+
+  const std::size_t remaining_grasps =
+      filterObjectGraspsHelper(object_grasp_candidates, planning_scene, arm_jmg, seed_state, filter_pregrasp, false);
+  stats_.duration_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+  std::vector<GraspCandidatePtr> grasp_candidates;
+  for (const ObjectGraspCandidates& object : object_grasp_candidates)
+    grasp_candidates.insert(grasp_candidates.end(), object.grasp_candidates_.begin(), object.grasp_candidates_.end());
+  printFilterStatistics(grasp_candidates);
 
   // Visualize valid grasps as arrows with cartesian path as well
   if (show_filtered_grasps_)
@@ -181,15 +376,41 @@ bool GraspFilter::filterGrasps(std::vector<GraspCandidatePtr>& grasp_candidates,
     visualizeCandidateGrasps(grasp_candidates);
   }
 
-  if (grasp_candidates.empty())
+  rankObjectGraspCandidates(object_grasp_candidates);
+
+  if (remaining_grasps == 0)
   {
     RCLCPP_WARN_STREAM(LOGGER, "No grasps remaining after filtering");
     return false;
   }
-
   return true;
 }
 
+void GraspFilter::rankObjectGraspCandidates(std::vector<ObjectGraspCandidates>& object_grasp_candidates)
+{
+  for (ObjectGraspCandidates& object : object_grasp_candidates)
+  {
+    object.num_valid_grasps_ = 0;
+    object.best_grasp_quality_ = 0;
+    for (const GraspCandidatePtr& grasp_candidate : object.grasp_candidates_)
+    {
+      if (!grasp_candidate->isValid())
+        continue;
+      if (object.num_valid_grasps_ == 0 || grasp_candidate->grasp_.grasp_quality > object.best_grasp_quality_)
+        object.best_grasp_quality_ = grasp_candidate->grasp_.grasp_quality;
+      ++object.num_valid_grasps_;
+    }
+  }
+
+  // Objects with the best valid grasp first, objects without any valid grasp last
+  std::stable_sort(object_grasp_candidates.begin(), object_grasp_candidates.end(),
+                   [](const ObjectGraspCandidates& a, const ObjectGraspCandidates& b) {
+                     if ((a.num_valid_grasps_ > 0) != (b.num_valid_grasps_ > 0))
+                       return a.num_valid_grasps_ > 0;
+                     return a.best_grasp_quality_ > b.best_grasp_quality_;
+                   });
+}
+
 bool GraspFilter::filterGraspByPlane(GraspCandidatePtr& grasp_candidate, const Eigen::Isometry3d& filter_pose,
                                      GraspParallelPlane plane, int direction) const
 {
@@ -253,17 +474,130 @@ bool GraspFilter::filterGraspByOrientation(GraspCandidatePtr& grasp_candidate, c
     return false;
 }
 
+std::size_t GraspFilter::filterGraspsByGeometry(std::vector<GraspCandidatePtr>& grasp_candidates) const
+{
+  if (cutting_planes_.empty() && desired_grasp_orientations_.empty())
+    return 0;
+
+  std::vector<std::size_t> grasp_ids;
+  grasp_ids.reserve(grasp_candidates.size());
+  for (std::size_t grasp_id = 0; grasp_id < grasp_candidates.size(); ++grasp_id)
+    if (grasp_candidates[grasp_id]->isValid())
+      grasp_ids.push_back(grasp_id);
+
+  // One column per candidate
+  const Eigen::Index num_grasps = static_cast<Eigen::Index>(grasp_ids.size());
+  Eigen::Matrix3Xd positions(3, num_grasps);
+  Eigen::Matrix3Xd z_axes(3, desired_grasp_orientations_.empty() ? 0 : num_grasps);
+  for (Eigen::Index i = 0; i < num_grasps; ++i)
+  {
+    const GraspCandidatePtr& grasp_candidate = grasp_candidates[grasp_ids[i]];
+    const geometry_msgs::msg::Pose& pose = grasp_candidate->grasp_.grasp_pose.pose;
+    positions.col(i) << pose.position.x, pose.position.y, pose.position.z;
+    if (desired_grasp_orientations_.empty())
+      continue;
+
+    // z axis of the tcp, in the standard grasping orientation
+    const Eigen::Quaterniond orientation(pose.orientation.w, pose.orientation.x, pose.orientation.y,
+                                         pose.orientation.z);
+    z_axes.col(i) = (orientation.normalized() *
+                     grasp_candidate->grasp_data_->tcp_to_eef_mount_.linear().row(2).transpose())
+                        .normalized();
+  }
+
+  // Candidates on the cut side of any plane
+  static const double EPSILON = 0.00000001;
+  Eigen::Array<bool, 1, Eigen::Dynamic> cut = Eigen::Array<bool, 1, Eigen::Dynamic>::Zero(num_grasps);
+  for (const CuttingPlanePtr& cutting_plane : cutting_planes_)
+  {
+    int axis;
+    switch (cutting_plane->plane_)
+    {
+      case XY:
+        axis = 2;
+        break;
+      case XZ:
+        axis = 1;
+        break;
+      case YZ:
+        axis = 0;
+        break;
+      default:
+        RCLCPP_WARN_STREAM(LOGGER_FILTER_BY_PLANE, "plane not specified correctly");
+        continue;
+    }
+
+    // Coordinate of every grasp position along the normal of the plane, in the frame of the plane
+    const Eigen::Isometry3d world_to_plane = cutting_plane->pose_.inverse();
+    const Eigen::Array<double, 1, Eigen::Dynamic> distances =
+        (world_to_plane.linear().row(axis) * positions).array() + world_to_plane.translation()(axis);
+    if (cutting_plane->direction_ == -1)
+      cut = cut || (distances < EPSILON);
+    else if (cutting_plane->direction_ == 1)
+      cut = cut || (distances > -EPSILON);
+  }
+
+  // Candidates outside of any orientation cone, angle > max_angle_offset_ is cos(angle) < cos(max_angle_offset_)
+  Eigen::Array<bool, 1, Eigen::Dynamic> misoriented = Eigen::Array<bool, 1, Eigen::Dynamic>::Zero(num_grasps);
+  for (const DesiredGraspOrientationPtr& desired_grasp_orientation : desired_grasp_orientations_)
+  {
+    if (desired_grasp_orientation->max_angle_offset_ < 0)
+    {
+      misoriented.setConstant(true);
+      break;
+    }
+    const Eigen::RowVector3d desired_z_axis =
+        desired_grasp_orientation->pose_.rotation().col(2).normalized().transpose();
+    misoriented =
+        misoriented || ((desired_z_axis * z_axes).array() < std::cos(desired_grasp_orientation->max_angle_offset_));
+  }
+
+  // The planes are checked first, as in processCandidateGrasp()
+  std::size_t num_filtered = 0;
+  for (Eigen::Index i = 0; i < num_grasps; ++i)
+  {
+    if (cut(i))
+      grasp_candidates[grasp_ids[i]]->grasp_filtered_code_ = GraspFilterCode::GRASP_FILTERED_BY_CUTTING_PLANE;
+    else if (misoriented(i))
+      grasp_candidates[grasp_ids[i]]->grasp_filtered_code_ = GraspFilterCode::GRASP_FILTERED_BY_ORIENTATION;
+    else
+      continue;
+    ++num_filtered;
+  }
+  return num_filtered;
+}
+
+bool GraspFilter::filterGraspByReachability(const GraspCandidatePtr& grasp_candidate,
+                                            const IkThreadStructPtr& ik_thread_struct) const
+{
+  // The map stores positions of the ik tip in the ik frame
+  Eigen::Isometry3d grasp_pose = visual_tools_->convertPose(grasp_candidate->grasp_.grasp_pose.pose);
+  Eigen::Vector3d grasp_position = ik_thread_struct->link_transform_ * grasp_pose.translation();
+
+  if (!ik_thread_struct->reachability_map_->isReachable(grasp_position))
+  {
+    RCLCPP_DEBUG_STREAM(LOGGER_SUPERDEBUG, "grasp filtered by reachability map");
+    grasp_candidate->grasp_filtered_code_ = GraspFilterCode::GRASP_FILTERED_BY_REACHABILITY;
+    return true;
+  }
+  return false;
+}
+
 bool GraspFilter::filterGraspByGraspIK(const GraspCandidatePtr& grasp_candidate, std::vector<double>& grasp_ik_solution,
                                        const IkThreadStructPtr& ik_thread_struct) const
 {
+  ScopedGraspStageTimer timer(&ik_thread_struct->stats_, GRASP_IK);
+
   // Get pose
-  ik_thread_struct->ik_pose_ = grasp_candidate->grasp_.grasp_pose;
+  Eigen::fromMsg(grasp_candidate->grasp_.grasp_pose.pose, ik_thread_struct->ik_pose_);
 
-  // Create constraint_fn
-  moveit::core::GroupStateValidityCallbackFn constraint_fn =
-      boost::bind(&isGraspStateValid, ik_thread_struct->planning_scene_.get(),
-                  collision_verbose_ || ik_thread_struct->visual_debug_, collision_verbose_speed_, visual_tools_, _1,
-                  _2, _3);
+  // Point the constraint_fn of the thread at this candidate
+  const moveit::core::GroupStateValidityCallbackFn& constraint_fn =
+      getStateValidityCallback(ik_thread_struct, grasp_candidate);
+
+  // Seed from the closest candidate solved so far, if there is one
+  if (ik_thread_struct->ik_seed_cache_)
+    ik_thread_struct->ik_seed_cache_->findNearest(ik_thread_struct->ik_pose_, ik_thread_struct->ik_seed_state_);
 
   // Set gripper position (eg. how open the eef is) to the custom open position
   grasp_candidate->getGraspStateOpenEEOnly(ik_thread_struct->robot_state_);
@@ -287,15 +621,13 @@ bool GraspFilter::filterGraspByPreGraspIK(const GraspCandidatePtr& grasp_candida
     RCLCPP_DEBUG_STREAM(LOGGER, "Not filtering pregrasp");
     return true;
   }
+  ScopedGraspStageTimer timer(&ik_thread_struct->stats_, PREGRASP_IK);
 
   // Set IK target pose to the pre-grasp pose
-  const std::string& ee_parent_link_name = grasp_candidate->grasp_data_->ee_jmg_->getEndEffectorParentGroup().second;
-  ik_thread_struct->ik_pose_ = GraspGenerator::getPreGraspPose(grasp_candidate, ee_parent_link_name);
+  GraspGenerator::getPreGraspPose(grasp_candidate, ik_thread_struct->ik_pose_);
 
-  moveit::core::GroupStateValidityCallbackFn constraint_fn =
-      boost::bind(&isGraspStateValid, ik_thread_struct->planning_scene_.get(),
-                  collision_verbose_ || ik_thread_struct->visual_debug_, collision_verbose_speed_, visual_tools_, _1,
-                  _2, _3);
+  const moveit::core::GroupStateValidityCallbackFn& constraint_fn =
+      getStateValidityCallback(ik_thread_struct, grasp_candidate);
 
   // Solve IK Problem for pregrasp
   pregrasp_ik_solution.resize(0);
@@ -329,12 +661,54 @@ std::size_t GraspFilter::filterGraspsHelper(std::vector<GraspCandidatePtr>& gras
                                             const moveit::core::RobotStatePtr& seed_state, bool filter_pregrasp,
                                             bool visualize, const std::string& target_object_id)
 {
-  // Clone the planning scene for const correctness
-  planning_scene::PlanningScenePtr planning_scene_clone = planning_scene::PlanningScene::clone(planning_scene);
+  // Check that we have grasp candidates
+  if (!grasp_candidates.size())
+  {
+    RCLCPP_WARN(LOGGER, "filterGraspsHelper passed empty grasp candidates");
+    return 0;
+  }
+
+  std::vector<ObjectGraspCandidates> object_grasp_candidates(1);
+  object_grasp_candidates.front().object_id_ = target_object_id;
+  object_grasp_candidates.front().grasp_candidates_ = grasp_candidates;
+  return filterObjectGraspsHelper(object_grasp_candidates, planning_scene, arm_jmg, seed_state, filter_pregrasp,
+                                  visualize);
+}
+
+std::size_t GraspFilter::filterObjectGraspsHelper(std::vector<ObjectGraspCandidates>& object_grasp_candidates,
+                                                  const planning_scene::PlanningScenePtr& planning_scene,
+                                                  const moveit::core::JointModelGroup* arm_jmg,
+                                                  const moveit::core::RobotStatePtr& seed_state, bool filter_pregrasp,
+                                                  bool visualize)
+{
+  // Benchmark the time spent preparing the scene for the threads
+  rclcpp::Time scene_setup_start_time = nh_->get_clock()->now();
+
+  // Clone the planning scene for const correctness. When the scene is shared between threads a diff is enough, since
+  // only the ACM entries below are written to it
+  planning_scene::PlanningScenePtr planning_scene_clone =
+      share_planning_scene_ ? planning_scene->diff() : planning_scene::PlanningScene::clone(planning_scene);
 
   // Setup collision checking
   *robot_state_ = planning_scene_clone->getCurrentState();
 
+  // Gather the candidates of all objects, remembering the object of each
+  std::vector<GraspCandidatePtr> grasp_candidates;
+  std::vector<std::size_t> grasp_object_ids;
+  for (std::size_t object_id = 0; object_id < object_grasp_candidates.size(); ++object_id)
+  {
+    ObjectGraspCandidates& object = object_grasp_candidates[object_id];
+    if (!object.object_id_.empty() && !planning_scene_clone->knowsFrameTransform(object.object_id_))
+    {
+      RCLCPP_ERROR_STREAM(LOGGER, "target_object_id: " << object.object_id_ << " unknown to the planning scene");
+      for (GraspCandidatePtr& grasp_candidate : object.grasp_candidates_)
+        grasp_candidate->grasp_filtered_code_ = GraspFilterCode::GRASP_INVALID;
+      continue;
+    }
+    grasp_candidates.insert(grasp_candidates.end(), object.grasp_candidates_.begin(), object.grasp_candidates_.end());
+    grasp_object_ids.insert(grasp_object_ids.end(), object.grasp_candidates_.size(), object_id);
+  }
+
   // Check that we have grasp candidates
   if (!grasp_candidates.size())
   {
@@ -342,66 +716,55 @@ std::size_t GraspFilter::filterGraspsHelper(std::vector<GraspCandidatePtr>& gras
     return 0;
   }
 
+  // Apply the cutting planes and orientations to all candidates at once, only the remaining ones are handed to the
+  // IK workers
+  std::size_t num_candidates;
+  {
+    ScopedGraspStageTimer timer(&stats_, CUTTING_PLANE_ORIENTATION);
+    filterGraspsByGeometry(grasp_candidates);
+    num_candidates = static_cast<std::size_t>(
+        std::count_if(grasp_candidates.begin(), grasp_candidates.end(),
+                      [](const GraspCandidatePtr& grasp_candidate) { return grasp_candidate->isValid(); }));
+  }
+  if (num_candidates == 0)
+  {
+    RCLCPP_INFO_STREAM(LOGGER, "All " << grasp_candidates.size() << " candidates filtered by cutting planes or "
+                                                                  "orientation");
+    return 0;
+  }
+
   // Choose Number of cores
-  std::size_t num_threads = omp_get_max_threads();
-  if (num_threads > grasp_candidates.size())
+  std::size_t num_threads = ik_worker_pool_->getNumWorkers();
+  if (num_threads > num_candidates)
   {
-    num_threads = grasp_candidates.size();
+    num_threads = num_candidates;
   }
 
-  // Debug
-  if (visualize || collision_verbose_)
+  // Debug, unless the collisions are recorded and published after filtering
+  if ((visualize || collision_verbose_) && !deferred_collision_visualization_)
   {
     num_threads = 1;
     RCLCPP_WARN_STREAM(LOGGER, "Using only " << num_threads << " threads because verbose is true");
   }
-  RCLCPP_INFO_STREAM(LOGGER,
-                     "Filtering " << grasp_candidates.size() << " candidate grasps with " << num_threads << " threads");
+  RCLCPP_INFO_STREAM(LOGGER, "Filtering " << grasp_candidates.size() << " candidate grasps of "
+                                          << object_grasp_candidates.size() << " objects with " << num_threads
+                                          << " threads");
 
-  // Load kinematic solvers if not already loaded
-  if (kin_solvers_[arm_jmg->getName()].size() != num_threads)
-  {
-    kin_solvers_[arm_jmg->getName()].clear();
+  // Keep the pool until the workers are done, it may be shared with other filters or a planner
+  const IkWorkerPool::Lease ik_worker_pool_lease = ik_worker_pool_->acquire();
 
-    // Create an ik solver for every thread
-    for (std::size_t i = 0; i < num_threads; ++i)
-    {
-      // ROS_DEBUG_STREAM_NAMED(name_,"Creating ik solver " << i);
-      kin_solvers_[arm_jmg->getName()].push_back(arm_jmg->getSolverInstance());
-
-      // Test to make sure we have a valid kinematics solver
-      if (!kin_solvers_[arm_jmg->getName()][i])
-      {
-        RCLCPP_ERROR_STREAM(LOGGER, "No kinematic solver found");
-        return 0;
-      }
-    }
-  }
+  // Load kinematic solvers if not already loaded for this arm
+  if (!ik_worker_pool_->loadSolvers(arm_jmg))
+    return 0;
 
-  // Robot states
-  // Create a robot state for every thread
-  if (robot_states_.size() != num_threads)
-  {
-    robot_states_.clear();
-    for (std::size_t i = 0; i < num_threads; ++i)
-    {
-      // Copy the previous robot state
-      robot_states_.push_back(std::make_shared<moveit::core::RobotState>(*robot_state_));
-    }
-  }
-  else  // update the states
-  {
-    for (std::size_t i = 0; i < num_threads; ++i)
-    {
-      // Copy the previous robot state
-      *(robot_states_[i]) = *robot_state_;
-    }
-  }
+  // Update the robot state of every thread. The copies include the attached bodies of the scene, so the IK of the
+  // threads works on them directly
+  ik_worker_pool_->setRobotStates(*robot_state_, num_threads);
 
   // Transform poses
   // bring the pose to the frame of the IK solver
-  const std::string& ik_frame = kin_solvers_[arm_jmg->getName()][0]->getBaseFrame();
-  Eigen::Isometry3d link_transform;
+  const std::string& ik_frame = ik_worker_pool_->getSolver(0, arm_jmg)->getBaseFrame();
+  Eigen::Isometry3d link_transform = Eigen::Isometry3d::Identity();
   RCLCPP_DEBUG_STREAM(LOGGER_SUPERDEBUG,
                       "Frame transform from ik_frame: " << ik_frame << " and robot model frame: "
                                                         << robot_state_->getRobotModel()->getModelFrame());
@@ -419,19 +782,43 @@ std::size_t GraspFilter::filterGraspsHelper(std::vector<GraspCandidatePtr>& gras
     link_transform = robot_state_->getGlobalLinkTransform(lm).inverse();
   }
 
-  // Ensure the ACM entries are set to ignore collisions between the eef and the
-  // target object
-  if (!target_object_id.empty())
+  // Only use a reachability map that was built in the frame of this solver
+  ReachabilityMapConstPtr reachability_map;
+  std::map<std::string, ReachabilityMapConstPtr>::const_iterator map_it = reachability_maps_.find(arm_jmg->getName());
+  if (map_it != reachability_maps_.end())
   {
-    if (!planning_scene_clone->knowsFrameTransform(target_object_id))
-    {
-      RCLCPP_ERROR_STREAM(LOGGER, "target_object_id: " << target_object_id << " unknown to the planning scene");
-      return 0;
-    }
-    std::vector<std::string> ee_links = grasp_candidates.front()->grasp_data_->ee_jmg_->getLinkModelNames();
-    if (!ee_links.empty())
+    if (moveit::core::Transforms::sameFrame(map_it->second->getIkFrame(), ik_frame))
+      reachability_map = map_it->second;
+    else
+      RCLCPP_WARN_STREAM(LOGGER, "Ignoring reachability map for " << arm_jmg->getName() << " built in frame "
+                                                                   << map_it->second->getIkFrame()
+                                                                   << " instead of the ik frame " << ik_frame);
+  }
+
+  // One scene per object, in which the ACM entries are set to ignore collisions between the eef and that object.
+  // Objects without a target object id use the scene as is. When the scene is not shared every thread gets its own
+  // clone, and the objects' scenes are diffs on top of it
+  std::vector<std::vector<planning_scene::PlanningScenePtr>> object_scenes(share_planning_scene_ ? 1 : num_threads);
+  for (std::vector<planning_scene::PlanningScenePtr>& thread_object_scenes : object_scenes)
+  {
+    planning_scene::PlanningScenePtr thread_scene = share_planning_scene_ ?
+                                                        planning_scene_clone :
+                                                        planning_scene::PlanningScene::clone(planning_scene_clone);
+    thread_object_scenes.resize(object_grasp_candidates.size(), thread_scene);
+    for (std::size_t object_id = 0; object_id < object_grasp_candidates.size(); ++object_id)
     {
-      setACMFingerEntry(target_object_id, true, ee_links, planning_scene_clone);
+      const ObjectGraspCandidates& object = object_grasp_candidates[object_id];
+      if (object.object_id_.empty() || object.grasp_candidates_.empty())
+        continue;
+
+      std::vector<std::string> ee_links = object.grasp_candidates_.front()->grasp_data_->ee_jmg_->getLinkModelNames();
+      if (!ee_links.empty())
+      {
+        // A single object can use the thread's scene directly
+        if (object_grasp_candidates.size() > 1)
+          thread_object_scenes[object_id] = thread_scene->diff();
+        setACMFingerEntry(object.object_id_, true, ee_links, thread_object_scenes[object_id]);
+      }
     }
   }
 
@@ -439,44 +826,121 @@ std::size_t GraspFilter::filterGraspsHelper(std::vector<GraspCandidatePtr>& gras
   std::vector<double> ik_seed_state;
   seed_state->copyJointGroupPositions(arm_jmg, ik_seed_state);
 
-  // Thread data
-  // Allocate only once to increase performance
+  // Solutions are only reused within one call
+  if (ik_seed_strategy_ == SEED_FROM_NEAREST_SOLUTION)
+    ik_seed_cache_->clear();
+
+  // Thread data, referencing the solver and robot state of each worker. The scene and target object are set for
+  // each grasp
   std::vector<IkThreadStructPtr> ik_thread_structs;
   ik_thread_structs.resize(num_threads);
   for (std::size_t thread_id = 0; thread_id < num_threads; ++thread_id)
   {
-    ik_thread_structs[thread_id] =
-        std::make_shared<IkThreadStruct>(grasp_candidates, planning_scene_clone, link_transform,
-                                         0,  // this is filled in by OpenMP
-                                         kin_solvers_[arm_jmg->getName()][thread_id], robot_states_[thread_id],
-                                         solver_timeout_, filter_pregrasp, visualize, thread_id, target_object_id);
+    ik_thread_structs[thread_id] = std::make_shared<IkThreadStruct>(
+        grasp_candidates, object_scenes[share_planning_scene_ ? 0 : thread_id].front(), link_transform,
+        0,  // this is filled in by the worker pool
+        ik_worker_pool_->getSolver(thread_id, arm_jmg), ik_worker_pool_->getRobotState(thread_id), solver_timeout_,
+        filter_pregrasp, visualize, thread_id, object_grasp_candidates.front().object_id_, false);
     ik_thread_structs[thread_id]->ik_seed_state_ = ik_seed_state;
+    ik_thread_structs[thread_id]->reachability_map_ = reachability_map;
+    ik_thread_structs[thread_id]->geometry_prefiltered_ = true;
+    if (ik_seed_strategy_ == SEED_FROM_NEAREST_SOLUTION)
+      ik_thread_structs[thread_id]->ik_seed_cache_ = ik_seed_cache_;
+    ik_thread_structs[thread_id]->stats_.thread_busy_durations_.resize(num_threads, 0);
   }
 
   // Benchmark time
   rclcpp::Time start_time;
   start_time = nh_->get_clock()->now();
+  double scene_setup_duration = (start_time - scene_setup_start_time).seconds();
 
-  // Loop through poses and find those that are kinematically feasible
-
-  omp_set_num_threads(num_threads);
-#pragma omp parallel for schedule(dynamic)
+  // When only the first few valid grasps are wanted, process the best scoring candidates first
+  std::vector<std::size_t> processing_order;
+  processing_order.reserve(num_candidates);
   for (std::size_t grasp_id = 0; grasp_id < grasp_candidates.size(); ++grasp_id)
+    if (grasp_candidates[grasp_id]->isValid())
+      processing_order.push_back(grasp_id);
+  if (max_valid_grasps_ > 0)
+  {
+    std::stable_sort(processing_order.begin(), processing_order.end(), [&](std::size_t a, std::size_t b) {
+      return compareGraspScores(grasp_candidates[a], grasp_candidates[b]);
+    });
+  }
+
+  // Candidates that only differ in their pre grasp posture, e.g. the finger openings of a two finger grasp, have the
+  // same IK solutions. Only the first of every pose is solved, the others copy its results
+  std::vector<std::size_t> unique_grasp_ids;
+  std::vector<std::vector<std::size_t>> pose_variant_ids;
+  groupGraspsByPose(grasp_candidates, grasp_object_ids, processing_order, unique_grasp_ids, pose_variant_ids);
+  if (unique_grasp_ids.size() < processing_order.size())
   {
-    std::size_t thread_id = omp_get_thread_num();
+    RCLCPP_DEBUG_STREAM(LOGGER, "Solving IK for " << unique_grasp_ids.size() << " unique poses of "
+                                                  << processing_order.size() << " candidates");
+  }
+
+  std::atomic<std::size_t> num_valid_grasps(0);
+  const std::chrono::steady_clock::time_point parallel_start_time = std::chrono::steady_clock::now();
+
+  // Loop through poses and find those that are kinematically feasible
+  ik_worker_pool_->run(unique_grasp_ids.size(), num_threads, [&](std::size_t thread_id, std::size_t task_id) {
+    const std::size_t grasp_id = unique_grasp_ids[task_id];
+    const std::chrono::steady_clock::time_point task_start_time = std::chrono::steady_clock::now();
     RCLCPP_DEBUG_STREAM(LOGGER_SUPERDEBUG, "Thread " << thread_id << " processing grasp " << grasp_id);
 
     // If in verbose mode allow for quick exit
     if (ik_thread_structs[thread_id]->visual_debug_ && !rclcpp::ok())
-      continue;  // breaking a for loop is not allows with OpenMP
+      return;
+
+    // Skip the remaining candidates once enough valid grasps were found
+    if (max_valid_grasps_ > 0 && num_valid_grasps >= max_valid_grasps_)
+    {
+      if (grasp_candidates[grasp_id]->isValid())
+        grasp_candidates[grasp_id]->grasp_filtered_code_ = GraspFilterCode::GRASP_FILTERED_BY_EARLY_EXIT;
+      for (std::size_t variant_id : pose_variant_ids[task_id])
+        grasp_candidates[variant_id]->grasp_filtered_code_ = GraspFilterCode::GRASP_FILTERED_BY_EARLY_EXIT;
+      return;
+    }
 
-    // Assign grasp to process
+    // Assign grasp to process, in the scene of its object
+    const std::size_t object_id = grasp_object_ids[grasp_id];
     ik_thread_structs[thread_id]->grasp_id = grasp_id;
+    ik_thread_structs[thread_id]->planning_scene_ = object_scenes[share_planning_scene_ ? 0 : thread_id][object_id];
+    ik_thread_structs[thread_id]->grasp_target_object_id_ = object_grasp_candidates[object_id].object_id_;
 
     // Process the grasp if it hasn't already been filtered out
     if (grasp_candidates[grasp_id]->isValid())
+    {
       processCandidateGrasp(ik_thread_structs[thread_id]);
-  }
+
+      // The open end effector is the only difference between the variants of a pose, checked if staged
+      for (std::size_t variant_id : pose_variant_ids[task_id])
+      {
+        grasp_candidates[variant_id]->grasp_filtered_code_ = grasp_candidates[grasp_id]->grasp_filtered_code_;
+        grasp_candidates[variant_id]->grasp_ik_solution_ = grasp_candidates[grasp_id]->grasp_ik_solution_;
+        grasp_candidates[variant_id]->pregrasp_ik_solution_ = grasp_candidates[grasp_id]->pregrasp_ik_solution_;
+        if (staged_collision_checking_ && grasp_candidates[variant_id]->isValid())
+          checkGraspStateOpen(grasp_candidates[variant_id], ik_thread_structs[thread_id]);
+        if (grasp_candidates[variant_id]->isValid())
+          ++num_valid_grasps;
+      }
+      if (staged_collision_checking_ && grasp_candidates[grasp_id]->isValid())
+        checkGraspStateOpen(grasp_candidates[grasp_id], ik_thread_structs[thread_id]);
+      if (grasp_candidates[grasp_id]->isValid())
+        ++num_valid_grasps;
+    }
+    ik_thread_structs[thread_id]->stats_.thread_busy_durations_[thread_id] +=
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - task_start_time).count();
+  });
+
+  // Merge the per thread accumulators
+  for (const IkThreadStructPtr& ik_thread_struct : ik_thread_structs)
+    stats_.merge(ik_thread_struct->stats_);
+  stats_.parallel_duration_ +=
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - parallel_start_time).count();
+
+  // Show the collisions recorded by the threads
+  if (deferred_collision_visualization_)
+    collision_state_buffer_->publish(visual_tools_, collision_verbose_speed_);
 
   if (statistics_verbose_)
   {
@@ -484,8 +948,12 @@ std::size_t GraspFilter::filterGraspsHelper(std::vector<GraspCandidatePtr>& gras
     double duration = (nh_->get_clock()->now() - start_time).seconds();
     RCLCPP_INFO_STREAM(LOGGER_FILTER_STATISTIC, "===================================================");
     RCLCPP_INFO_STREAM(LOGGER_FILTER_STATISTIC, "FILTER DURATION");
+    const std::string scene_setup_type = share_planning_scene_ ? " (shared scene)" : " (cloned per thread)";
+    RCLCPP_INFO_STREAM(LOGGER_FILTER_STATISTIC,
+                       "Scene Setup Duration  :\t" << scene_setup_duration << scene_setup_type);
     RCLCPP_INFO_STREAM(LOGGER_FILTER_STATISTIC, "Grasp Filter Duration :\t" << duration);
     RCLCPP_INFO_STREAM(LOGGER_FILTER_STATISTIC, "---------------------------------------------------");
+    RCLCPP_INFO_STREAM(LOGGER_FILTER_STATISTIC, "Stage durations so far:\n" << stats_.toString());
   }
 
   std::size_t not_filtered = 0;
@@ -496,6 +964,55 @@ std::size_t GraspFilter::filterGraspsHelper(std::vector<GraspCandidatePtr>& gras
   return not_filtered;
 }
 
+void GraspFilter::groupGraspsByPose(const std::vector<GraspCandidatePtr>& grasp_candidates,
+                                    const std::vector<std::size_t>& grasp_object_ids,
+                                    const std::vector<std::size_t>& processing_order,
+                                    std::vector<std::size_t>& unique_grasp_ids,
+                                    std::vector<std::vector<std::size_t>>& pose_variant_ids)
+{
+  typedef std::tuple<std::size_t, const GraspData*, std::array<double, 7>> PoseKey;
+  std::map<PoseKey, std::size_t> unique_poses;
+
+  unique_grasp_ids.clear();
+  pose_variant_ids.clear();
+  unique_grasp_ids.reserve(processing_order.size());
+  for (std::size_t grasp_id : processing_order)
+  {
+    const GraspCandidatePtr& grasp_candidate = grasp_candidates[grasp_id];
+
+    // Filtered candidates keep their code, they are passed on as their own task
+    if (grasp_candidate->isValid())
+    {
+      const geometry_msgs::msg::Pose& pose = grasp_candidate->grasp_.grasp_pose.pose;
+      const PoseKey key(grasp_object_ids[grasp_id], grasp_candidate->grasp_data_.get(),
+                        { pose.position.x, pose.position.y, pose.position.z, pose.orientation.x, pose.orientation.y,
+                          pose.orientation.z, pose.orientation.w });
+      const auto inserted = unique_poses.emplace(key, unique_grasp_ids.size());
+      if (!inserted.second)
+      {
+        pose_variant_ids[inserted.first->second].push_back(grasp_id);
+        continue;
+      }
+    }
+    unique_grasp_ids.push_back(grasp_id);
+    pose_variant_ids.emplace_back();
+  }
+}
+
+bool GraspFilter::checkGraspStateOpen(const GraspCandidatePtr& grasp_candidate,
+                                      const IkThreadStructPtr& ik_thread_struct) const
+{
+  const bool valid = grasp_candidate->getGraspStateOpen(ik_thread_struct->robot_state_) &&
+                     checkEndEffectorCollision(ik_thread_struct, grasp_candidate->grasp_data_->ee_jmg_);
+  if (!valid)
+  {
+    RCLCPP_DEBUG_STREAM(LOGGER_SUPERDEBUG, "Grasp filtered because in collision with the end effector open");
+    grasp_candidate->grasp_filtered_code_ = GraspFilterCode::GRASP_FILTERED_BY_OPEN_COLLISION;
+    return false;
+  }
+  return true;
+}
+
 void GraspFilter::printFilterStatistics(const std::vector<GraspCandidatePtr>& grasp_candidates) const
 {
   if (!statistics_verbose_)
@@ -503,20 +1020,29 @@ void GraspFilter::printFilterStatistics(const std::vector<GraspCandidatePtr>& gr
   // Count number of grasps remaining
   std::size_t not_filtered = 0;
   std::size_t grasp_filtered_by_ik = 0;
+  std::size_t grasp_filtered_by_reachability = 0;
   std::size_t grasp_filtered_by_cutting_plane = 0;
   std::size_t grasp_filtered_by_orientation = 0;
   std::size_t pregrasp_filtered_by_ik = 0;
+  std::size_t grasp_filtered_by_early_exit = 0;
+  std::size_t grasp_filtered_by_open_collision = 0;
 
   for (std::size_t i = 0; i < grasp_candidates.size(); ++i)
   {
     if (grasp_candidates[i]->grasp_filtered_code_ == GraspFilterCode::GRASP_FILTERED_BY_IK)
       ++grasp_filtered_by_ik;
+    else if (grasp_candidates[i]->grasp_filtered_code_ == GraspFilterCode::GRASP_FILTERED_BY_REACHABILITY)
+      ++grasp_filtered_by_reachability;
     else if (grasp_candidates[i]->grasp_filtered_code_ == GraspFilterCode::GRASP_FILTERED_BY_CUTTING_PLANE)
       ++grasp_filtered_by_cutting_plane;
     else if (grasp_candidates[i]->grasp_filtered_code_ == GraspFilterCode::GRASP_FILTERED_BY_ORIENTATION)
       ++grasp_filtered_by_orientation;
     else if (grasp_candidates[i]->grasp_filtered_code_ == GraspFilterCode::PREGRASP_FILTERED_BY_IK)
       ++pregrasp_filtered_by_ik;
+    else if (grasp_candidates[i]->grasp_filtered_code_ == GraspFilterCode::GRASP_FILTERED_BY_EARLY_EXIT)
+      ++grasp_filtered_by_early_exit;
+    else if (grasp_candidates[i]->grasp_filtered_code_ == GraspFilterCode::GRASP_FILTERED_BY_OPEN_COLLISION)
+      ++grasp_filtered_by_open_collision;
     else if (grasp_candidates[i]->isValid())
       ++not_filtered;
   }
@@ -528,8 +1054,14 @@ void GraspFilter::printFilterStatistics(const std::vector<GraspCandidatePtr>& gr
   RCLCPP_INFO_STREAM(LOGGER_FILTER_STATISTIC, "-------------------------------------------------------");
   RCLCPP_INFO_STREAM(LOGGER_FILTER_STATISTIC, "grasp_filtered_by_cutting_plane " << grasp_filtered_by_cutting_plane);
   RCLCPP_INFO_STREAM(LOGGER_FILTER_STATISTIC, "grasp_filtered_by_orientation   " << grasp_filtered_by_orientation);
+  RCLCPP_INFO_STREAM(LOGGER_FILTER_STATISTIC, "grasp_filtered_by_reachability  " << grasp_filtered_by_reachability);
   RCLCPP_INFO_STREAM(LOGGER_FILTER_STATISTIC, "grasp_filtered_by_ik            " << grasp_filtered_by_ik);
   RCLCPP_INFO_STREAM(LOGGER_FILTER_STATISTIC, "pregrasp_filtered_by_ik         " << pregrasp_filtered_by_ik);
+  if (staged_collision_checking_)
+    RCLCPP_INFO_STREAM(LOGGER_FILTER_STATISTIC,
+                       "grasp_filtered_by_open_collision " << grasp_filtered_by_open_collision);
+  if (max_valid_grasps_ > 0)
+    RCLCPP_INFO_STREAM(LOGGER_FILTER_STATISTIC, "grasp_filtered_by_early_exit    " << grasp_filtered_by_early_exit);
 }
 
 bool GraspFilter::processCandidateGrasp(const IkThreadStructPtr& ik_thread_struct)
@@ -539,23 +1071,33 @@ bool GraspFilter::processCandidateGrasp(const IkThreadStructPtr& ik_thread_struc
   // Helper pointer
   GraspCandidatePtr& grasp_candidate = ik_thread_struct->grasp_candidates_[ik_thread_struct->grasp_id];
 
-  // Get pose
-  ik_thread_struct->ik_pose_ = grasp_candidate->grasp_.grasp_pose;
-
-  // Filter by cutting planes
-  for (auto& cutting_plane : cutting_planes_)
   {
-    if (filterGraspByPlane(grasp_candidate, cutting_plane->pose_, cutting_plane->plane_, cutting_plane->direction_))
+    ScopedGraspStageTimer timer(&ik_thread_struct->stats_, CUTTING_PLANE_ORIENTATION);
+
+    // Filter by cutting planes and desired orientation, unless already done for all candidates
+    if (!ik_thread_struct->geometry_prefiltered_)
     {
-      return false;
+      for (auto& cutting_plane : cutting_planes_)
+      {
+        if (filterGraspByPlane(grasp_candidate, cutting_plane->pose_, cutting_plane->plane_,
+                               cutting_plane->direction_))
+        {
+          return false;
+        }
+      }
+
+      for (auto& desired_grasp_orientation : desired_grasp_orientations_)
+      {
+        if (filterGraspByOrientation(grasp_candidate, desired_grasp_orientation->pose_,
+                                     desired_grasp_orientation->max_angle_offset_))
+        {
+          return false;
+        }
+      }
     }
-  }
 
-  // Filter by desired orientation
-  for (auto& desired_grasp_orientation : desired_grasp_orientations_)
-  {
-    if (filterGraspByOrientation(grasp_candidate, desired_grasp_orientation->pose_,
-                                 desired_grasp_orientation->max_angle_offset_))
+    // Filter by reachability map
+    if (ik_thread_struct->reachability_map_ && filterGraspByReachability(grasp_candidate, ik_thread_struct))
     {
       return false;
     }
@@ -573,6 +1115,8 @@ bool GraspFilter::processCandidateGrasp(const IkThreadStructPtr& ik_thread_struc
 
   // Copy solution to seed state so that next solution is faster
   ik_thread_struct->ik_seed_state_ = grasp_ik_solution;
+  if (ik_thread_struct->ik_seed_cache_)
+    ik_thread_struct->ik_seed_cache_->insert(ik_thread_struct->ik_pose_, grasp_ik_solution);
 
   std::vector<double> pregrasp_ik_solution;
   if (filterGraspByPreGraspIK(grasp_candidate, pregrasp_ik_solution, ik_thread_struct))
@@ -590,65 +1134,200 @@ bool GraspFilter::findIKSolution(std::vector<double>& ik_solution, const IkThrea
                                  const GraspCandidatePtr& grasp_candidate,
                                  const moveit::core::GroupStateValidityCallbackFn& constraint_fn) const
 {
-  moveit::core::RobotState state = ik_thread_struct->planning_scene_->getCurrentState();
-  if (ik_thread_struct->ik_seed_state_.size() == grasp_candidate->grasp_data_->arm_jmg_->getActiveJointModels().size())
+  // The state of the thread is a copy of the scene's current state including its attached bodies, made once per
+  // filter call. Only the arm is reset to the seed, or to the current state if there is no seed
+  moveit::core::RobotState& state = *ik_thread_struct->robot_state_;
+  const moveit::core::JointModelGroup* arm_jmg = grasp_candidate->grasp_data_->arm_jmg_;
+  if (ik_thread_struct->ik_seed_state_.size() == arm_jmg->getVariableCount())
   {
-    state.setJointGroupPositions(grasp_candidate->grasp_data_->arm_jmg_, ik_thread_struct->ik_seed_state_);
-    state.update();
+    state.setJointGroupPositions(arm_jmg, ik_thread_struct->ik_seed_state_);
   }
+  else
+  {
+    const moveit::core::RobotState& current_state = ik_thread_struct->planning_scene_->getCurrentState();
+    for (const moveit::core::JointModel* joint_model : arm_jmg->getActiveJointModels())
+      state.setJointPositions(joint_model, current_state.getJointPositions(joint_model));
+  }
+  state.update();
 
-  // Copy in attached bodies which get removed by setJointGroupPositions for
-  // some reason
-  std::vector<const moveit::core::AttachedBody*> attached_bodies;
-  ik_thread_struct->planning_scene_->getCurrentState().getAttachedBodies(attached_bodies);
-
-  for (const moveit::core::AttachedBody* ab : attached_bodies)
-    state.attachBody(const_cast<moveit::core::AttachedBody*>(ab)); //TODO TODO TODO
+  if (multi_solution_ik_)
+  {
+    if (!findClosestIKSolution(ik_thread_struct, arm_jmg, constraint_fn))
+    {
+      ++ik_thread_struct->stats_.ik_failed_;
+      RCLCPP_DEBUG_STREAM(LOGGER_SUPERDEBUG, "No valid IK solution among all solutions");
+      return false;
+    }
+    ++ik_thread_struct->stats_.ik_solved_;
+    state.copyJointGroupPositions(arm_jmg, ik_solution);
+    return true;
+  }
 
-  bool ik_success = state.setFromIK(grasp_candidate->grasp_data_->arm_jmg_, ik_thread_struct->ik_pose_.pose,
-                                    ik_thread_struct->timeout_, constraint_fn);
+  const std::chrono::steady_clock::time_point ik_start_time = std::chrono::steady_clock::now();
+  bool ik_success = state.setFromIK(arm_jmg, ik_thread_struct->ik_pose_, ik_thread_struct->timeout_, constraint_fn);
 
   // Results
   if (ik_success)
   {
-    state.copyJointGroupPositions(grasp_candidate->grasp_data_->arm_jmg_, ik_solution);
+    ++ik_thread_struct->stats_.ik_solved_;
+    state.copyJointGroupPositions(arm_jmg, ik_solution);
     return true;
   }
   else
   {
+    // setFromIK does not report why it failed, a solver that used up its timeout kept finding no valid solution
+    if (std::chrono::duration<double>(std::chrono::steady_clock::now() - ik_start_time).count() >=
+        ik_thread_struct->timeout_)
+      ++ik_thread_struct->stats_.ik_timed_out_;
+    else
+      ++ik_thread_struct->stats_.ik_failed_;
+
     // The grasp was valid but the pre-grasp was not
     RCLCPP_DEBUG_STREAM(LOGGER_SUPERDEBUG, "IK solution not found");
     return false;
   }
 }
 
+bool GraspFilter::findClosestIKSolution(const IkThreadStructPtr& ik_thread_struct,
+                                        const moveit::core::JointModelGroup* arm_jmg,
+                                        const moveit::core::GroupStateValidityCallbackFn& constraint_fn) const
+{
+  moveit::core::RobotState& state = *ik_thread_struct->robot_state_;
+  const kinematics::KinematicsBaseConstPtr& solver = ik_thread_struct->kin_solver_;
+
+  // The solver orders the joints its own way
+  const std::vector<unsigned int>& bijection = arm_jmg->getKinematicsSolverJointBijection();
+  std::vector<double> seed_positions;
+  state.copyJointGroupPositions(arm_jmg, seed_positions);
+  std::vector<double> solver_seed(bijection.size());
+  for (std::size_t i = 0; i < bijection.size(); ++i)
+    solver_seed[i] = seed_positions[bijection[i]];
+
+  // The pose of the solver's tip in the solver's base frame
+  const std::vector<geometry_msgs::msg::Pose> ik_poses(
+      1, Eigen::toMsg(Eigen::Isometry3d(ik_thread_struct->link_transform_ * ik_thread_struct->ik_pose_)));
+  kinematics::KinematicsResult result;
+  kinematics::KinematicsQueryOptions options;
+  std::vector<std::vector<double> >& solutions = ik_thread_struct->ik_solutions_;
+  solutions.clear();
+  if (!solver->getPositionIK(ik_poses, solver_seed, solutions, result, options) || solutions.empty())
+    return false;
+
+  // Bring the solutions to group order and check them closest first, the first valid one is the best
+  std::vector<std::pair<double, std::size_t> > order;
+  order.reserve(solutions.size());
+  std::vector<double> group_solution(bijection.size());
+  for (std::size_t i = 0; i < solutions.size(); ++i)
+  {
+    if (solutions[i].size() != bijection.size())
+      continue;
+    for (std::size_t j = 0; j < bijection.size(); ++j)
+      group_solution[bijection[j]] = solutions[i][j];
+    solutions[i] = group_solution;
+    order.emplace_back(arm_jmg->distance(solutions[i].data(), seed_positions.data()), i);
+  }
+  std::sort(order.begin(), order.end());
+
+  // The callback sets the state to the solution it checks
+  for (const std::pair<double, std::size_t>& ordered_solution : order)
+  {
+    if (constraint_fn(&state, arm_jmg, solutions[ordered_solution.second].data()))
+      return true;
+  }
+  return false;
+}
+
+const moveit::core::GroupStateValidityCallbackFn&
+GraspFilter::getStateValidityCallback(const IkThreadStructPtr& ik_thread_struct,
+                                      const GraspCandidatePtr& grasp_candidate) const
+{
+  StateValidityChecker& checker = ik_thread_struct->state_validity_checker_;
+  checker.planning_scene_ = ik_thread_struct->planning_scene_.get();
+  checker.ee_jmg_ = staged_collision_checking_ ? grasp_candidate->grasp_data_->ee_jmg_ : nullptr;
+  if (checker.callback_)
+    return checker.callback_;
+
+  if (!isCollisionVisualDebug(ik_thread_struct))
+  {
+    checker.callback_ = makeStateValidityCallback(&checker, NoCollisionReport());
+  }
+  else if (deferred_collision_visualization_)
+  {
+    checker.callback_ = makeStateValidityCallback(&checker, BufferCollisionReport{ collision_state_buffer_.get() });
+  }
+  else
+  {
+    checker.callback_ =
+        makeStateValidityCallback(&checker, PublishCollisionReport{ collision_verbose_speed_, visual_tools_.get() });
+  }
+  return checker.callback_;
+}
+
+bool GraspFilter::checkEndEffectorCollision(const IkThreadStructPtr& ik_thread_struct,
+                                            const moveit::core::JointModelGroup* ee_jmg) const
+{
+  const planning_scene::PlanningScene* planning_scene = ik_thread_struct->planning_scene_.get();
+  moveit::core::RobotState* robot_state = ik_thread_struct->robot_state_.get();
+  if (!isCollisionVisualDebug(ik_thread_struct))
+    return checkEndEffectorState(planning_scene, NoCollisionReport(), robot_state, ee_jmg);
+  if (deferred_collision_visualization_)
+  {
+    return checkEndEffectorState(planning_scene, BufferCollisionReport{ collision_state_buffer_.get() }, robot_state,
+                                 ee_jmg);
+  }
+  return checkEndEffectorState(planning_scene, PublishCollisionReport{ collision_verbose_speed_, visual_tools_.get() },
+                               robot_state, ee_jmg);
+}
+
 void GraspFilter::addCuttingPlane(const Eigen::Isometry3d& pose, GraspParallelPlane plane, int direction)
 {
   cutting_planes_.push_back(std::make_shared<CuttingPlane>(pose, plane, direction));
 }
 
+void GraspFilter::setIkSeedStrategy(IkSeedStrategy ik_seed_strategy, double max_translation, double max_rotation)
+{
+  ik_seed_strategy_ = ik_seed_strategy;
+  if (ik_seed_strategy_ == SEED_FROM_NEAREST_SOLUTION)
+    ik_seed_cache_ = std::make_shared<IkSeedCache>(max_translation, max_rotation);
+  else
+    ik_seed_cache_.reset();
+}
+
+void GraspFilter::setReachabilityMap(const ReachabilityMapConstPtr& reachability_map)
+{
+  reachability_maps_[reachability_map->getGroupName()] = reachability_map;
+}
+
+bool GraspFilter::loadReachabilityMap(const std::string& filename)
+{
+  ReachabilityMapPtr reachability_map = std::make_shared<ReachabilityMap>();
+  if (!reachability_map->loadFromFile(filename))
+    return false;
+  setReachabilityMap(reachability_map);
+  return true;
+}
+
+void GraspFilter::clearReachabilityMap(const std::string& arm_name)
+{
+  reachability_maps_.erase(arm_name);
+}
+
 void GraspFilter::addDesiredGraspOrientation(const Eigen::Isometry3d& pose, double max_angle_offset)
 {
   desired_grasp_orientations_.push_back(std::make_shared<DesiredGraspOrientation>(pose, max_angle_offset));
 }
 
-bool GraspFilter::removeInvalidAndFilter(std::vector<GraspCandidatePtr>& grasp_candidates) const
+bool GraspFilter::removeInvalidAndFilter(std::vector<GraspCandidatePtr>& grasp_candidates,
+                                         std::size_t max_results) const
 {
   std::size_t original_num_grasps = grasp_candidates.size();
 
-  // Remove all invalid grasps
-  for (std::vector<GraspCandidatePtr>::iterator it = grasp_candidates.begin(); it != grasp_candidates.end();)
-  {
-    // Check if valid grasp
-    if (!(*it)->isValid())
-    {
-      it = grasp_candidates.erase(it);  // not valid
-    }
-    else
-    {
-      ++it;  // was valid, keep
-    }
-  }
+  // Remove all invalid grasps in one pass, keeping the order of the valid ones
+  grasp_candidates.erase(std::remove_if(grasp_candidates.begin(), grasp_candidates.end(),
+                                        [](const GraspCandidatePtr& grasp_candidate) {
+                                          return !grasp_candidate->isValid();
+                                        }),
+                         grasp_candidates.end());
   RCLCPP_INFO_STREAM(LOGGER, "Removed " << original_num_grasps - grasp_candidates.size()
                                         << " invalid grasp candidates, " << grasp_candidates.size() << " remaining");
 
@@ -659,8 +1338,17 @@ bool GraspFilter::removeInvalidAndFilter(std::vector<GraspCandidatePtr>& grasp_c
     return false;
   }
 
-  // Order remaining valid grasps by best score
-  std::sort(grasp_candidates.begin(), grasp_candidates.end(), compareGraspScores);
+  // Order remaining valid grasps by best score, only the best max_results if set
+  if (max_results > 0 && max_results < grasp_candidates.size())
+  {
+    std::partial_sort(grasp_candidates.begin(), grasp_candidates.begin() + max_results, grasp_candidates.end(),
+                      compareGraspScores);
+    grasp_candidates.resize(max_results);
+  }
+  else
+  {
+    std::sort(grasp_candidates.begin(), grasp_candidates.end(), compareGraspScores);
+  }
 
   RCLCPP_INFO_STREAM(LOGGER, "Sorted valid grasps, highest quality is "
                                  << grasp_candidates.front()->grasp_.grasp_quality << " and lowest quality is "
@@ -669,6 +1357,157 @@ bool GraspFilter::removeInvalidAndFilter(std::vector<GraspCandidatePtr>& grasp_c
   return true;
 }
 
+std::size_t GraspFilter::verifyGraspCandidates(std::vector<GraspCandidatePtr>& grasp_candidates,
+                                               const planning_scene::PlanningScenePtr& planning_scene,
+                                               const std::string& target_object_id)
+{
+  if (grasp_candidates.empty())
+    return 0;
+
+  // Allow the fingers to touch the target object, without modifying the caller's scene
+  planning_scene::PlanningScenePtr scene = planning_scene->diff();
+  const GraspDataPtr& grasp_data = grasp_candidates.front()->grasp_data_;
+  if (!target_object_id.empty() && scene->knowsFrameTransform(target_object_id))
+    setACMFingerEntry(target_object_id, true, grasp_data->ee_jmg_->getLinkModelNames(), scene);
+
+  *robot_state_ = scene->getCurrentState();
+
+  // Check the arm and the open end effector, the arm group does not necessarily contain the end effector links
+  auto in_collision = [&](const GraspCandidatePtr& grasp_candidate) {
+    if (!grasp_candidate->isValid() || !grasp_candidate->getGraspStateOpen(robot_state_))
+      return true;
+    robot_state_->update();
+    return scene->isStateColliding(*robot_state_, grasp_candidate->grasp_data_->arm_jmg_->getName()) ||
+           scene->isStateColliding(*robot_state_, grasp_candidate->grasp_data_->ee_jmg_->getName());
+  };
+
+  std::size_t original_num_grasps = grasp_candidates.size();
+  grasp_candidates.erase(std::remove_if(grasp_candidates.begin(), grasp_candidates.end(), in_collision),
+                         grasp_candidates.end());
+
+  RCLCPP_INFO_STREAM(LOGGER, "Verified grasp candidates, " << original_num_grasps - grasp_candidates.size()
+                                                           << " are now in collision, " << grasp_candidates.size()
+                                                           << " remaining");
+  return grasp_candidates.size();
+}
+
+bool GraspFilter::revalidateGrasps(std::vector<GraspCandidatePtr>& grasp_candidates,
+                                   const planning_scene_monitor::PlanningSceneMonitorPtr& planning_scene_monitor,
+                                   const moveit::core::JointModelGroup* arm_jmg,
+                                   const moveit::core::RobotStatePtr& seed_state, bool filter_pregrasp,
+                                   const std::string& target_object_id)
+{
+  planning_scene::PlanningScenePtr planning_scene;
+  {
+    planning_scene_monitor::LockedPlanningSceneRO scene(planning_scene_monitor);
+    planning_scene = planning_scene::PlanningScene::clone(scene);
+  }
+  return revalidateGrasps(grasp_candidates, planning_scene, arm_jmg, seed_state, filter_pregrasp, target_object_id);
+}
+
+bool GraspFilter::revalidateGrasps(std::vector<GraspCandidatePtr>& grasp_candidates,
+                                   const planning_scene::PlanningScenePtr& planning_scene,
+                                   const moveit::core::JointModelGroup* arm_jmg,
+                                   const moveit::core::RobotStatePtr& seed_state, bool filter_pregrasp,
+                                   const std::string& target_object_id)
+{
+  stats_.clear();
+  const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+  // Error check
+  if (grasp_candidates.empty())
+  {
+    RCLCPP_ERROR(LOGGER, "Unable to revalidate grasps because vector is empty");
+    return false;
+  }
+
+  std::vector<std::size_t> valid_grasp_ids;
+  for (std::size_t grasp_id = 0; grasp_id < grasp_candidates.size(); ++grasp_id)
+    if (grasp_candidates[grasp_id]->isValid())
+      valid_grasp_ids.push_back(grasp_id);
+
+  // Allow the fingers to touch the target object, without modifying the caller's scene
+  planning_scene::PlanningScenePtr scene = planning_scene->diff();
+  if (!target_object_id.empty() && scene->knowsFrameTransform(target_object_id))
+  {
+    setACMFingerEntry(target_object_id, true, grasp_candidates.front()->grasp_data_->ee_jmg_->getLinkModelNames(),
+                      scene);
+  }
+
+  // Collision sweep of the kept solutions, the scene is only read by the workers
+  std::vector<std::uint8_t> in_collision(valid_grasp_ids.size(), 0);
+  if (!valid_grasp_ids.empty())
+  {
+    const std::size_t num_threads = std::min(ik_worker_pool_->getNumWorkers(), valid_grasp_ids.size());
+    const IkWorkerPool::Lease ik_worker_pool_lease = ik_worker_pool_->acquire();
+    ik_worker_pool_->setRobotStates(scene->getCurrentState(), num_threads);
+    ik_worker_pool_->run(valid_grasp_ids.size(), num_threads, [&](std::size_t thread_id, std::size_t task_id) {
+      moveit::core::RobotStatePtr robot_state = ik_worker_pool_->getRobotState(thread_id);
+      in_collision[task_id] =
+          !isGraspCollisionFree(grasp_candidates[valid_grasp_ids[task_id]], *scene, robot_state, filter_pregrasp);
+    });
+  }
+
+  // Only the grasps that now collide are solved again
+  std::vector<GraspCandidatePtr> colliding_grasp_candidates;
+  for (std::size_t task_id = 0; task_id < valid_grasp_ids.size(); ++task_id)
+  {
+    if (!in_collision[task_id])
+      continue;
+    const GraspCandidatePtr& grasp_candidate = grasp_candidates[valid_grasp_ids[task_id]];
+    grasp_candidate->grasp_filtered_code_ = GraspFilterCode::NOT_FILTERED;
+    grasp_candidate->grasp_ik_solution_.clear();
+    grasp_candidate->pregrasp_ik_solution_.clear();
+    colliding_grasp_candidates.push_back(grasp_candidate);
+  }
+
+  std::size_t num_refiltered_valid = 0;
+  if (!colliding_grasp_candidates.empty())
+  {
+    if (!prepareFilter(arm_jmg, filter_pregrasp))
+      return false;
+    num_refiltered_valid = filterGraspsHelper(colliding_grasp_candidates, planning_scene, arm_jmg, seed_state,
+                                              filter_pregrasp, false, target_object_id);
+  }
+  stats_.duration_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+  const std::size_t num_valid = valid_grasp_ids.size() - colliding_grasp_candidates.size() + num_refiltered_valid;
+  RCLCPP_INFO_STREAM(LOGGER, "Revalidated " << valid_grasp_ids.size() << " grasps, "
+                                            << colliding_grasp_candidates.size() << " were in collision and "
+                                            << num_refiltered_valid << " of them were solved again, " << num_valid
+                                            << " valid grasps remaining");
+  return num_valid > 0;
+}
+
+bool GraspFilter::isGraspCollisionFree(const GraspCandidatePtr& grasp_candidate,
+                                       const planning_scene::PlanningScene& scene,
+                                       moveit::core::RobotStatePtr& robot_state, bool check_pregrasp) const
+{
+  const std::string& arm_name = grasp_candidate->grasp_data_->arm_jmg_->getName();
+  const std::string& ee_name = grasp_candidate->grasp_data_->ee_jmg_->getName();
+
+  // The arm group does not necessarily contain the end effector links
+  if (!grasp_candidate->getGraspStateOpen(robot_state))
+    return false;
+  robot_state->update();
+  if (scene.isStateColliding(*robot_state, arm_name) || scene.isStateColliding(*robot_state, ee_name))
+    return false;
+
+  // Only the end effector moves when closing
+  if (!grasp_candidate->getGraspStateClosedEEOnly(robot_state))
+    return false;
+  robot_state->update();
+  if (scene.isStateColliding(*robot_state, ee_name))
+    return false;
+
+  if (!check_pregrasp || grasp_candidate->pregrasp_ik_solution_.empty())
+    return true;
+  if (!grasp_candidate->getPreGraspState(robot_state))
+    return false;
+  robot_state->update();
+  return !scene.isStateColliding(*robot_state, arm_name) && !scene.isStateColliding(*robot_state, ee_name);
+}
+
 bool GraspFilter::visualizeGrasps(const std::vector<GraspCandidatePtr>& grasp_candidates,
                                   const moveit::core::JointModelGroup* arm_jmg)
 {
@@ -43,6 +43,9 @@
 #include <rcpputils/asserts.hpp>
 #include <rosparam_shortcuts/rosparam_shortcuts.h>
 
+#include <algorithm>
+#include <atomic>
+
 rclcpp::Logger grasp_generator = rclcpp::get_logger("grasp_generator");
 
 namespace
@@ -84,6 +87,12 @@ GraspGenerator::GraspGenerator(rclcpp::Node::SharedPtr node,
   rosparam_shortcuts::shutdownIfError(error);
 }
 
+std::size_t GraspGenerator::reserveGraspIds(std::size_t num_ids)
+{
+  static std::atomic<std::size_t> next_grasp_id(0);
+  return next_grasp_id.fetch_add(num_ids, std::memory_order_relaxed);
+}
+
 void GraspGenerator::setIdealTCPGraspPoseRPY(const std::vector<double>& ideal_grasp_orientation_rpy)
 {
   rcpputils::assert_true(ideal_grasp_orientation_rpy.size() == 3,
@@ -103,6 +112,28 @@ void GraspGenerator::setIdealTCPGraspPoseRPY(const std::vector<double>& ideal_gr
   ideal_grasp_pose_.translation() = ideal_grasp_pose_translation;
 }
 
+bool GraspGenerator::streamGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width, double height,
+                                  const GraspDataPtr& grasp_data, const GraspCandidatesCallback& callback,
+                                  std::size_t chunk_size)
+{
+  // Generic version, all grasps are generated before the first chunk is passed on
+  std::vector<GraspCandidatePtr> grasp_candidates;
+  if (!generateGrasps(cuboid_pose, depth, width, height, grasp_data, grasp_candidates))
+    return false;
+  std::stable_sort(grasp_candidates.begin(), grasp_candidates.end(), GraspFilter::compareGraspScores);
+
+  chunk_size = std::max<std::size_t>(chunk_size, 1);
+  std::vector<GraspCandidatePtr> chunk;
+  for (std::size_t begin = 0; begin < grasp_candidates.size(); begin += chunk_size)
+  {
+    const std::size_t end = std::min(begin + chunk_size, grasp_candidates.size());
+    chunk.assign(grasp_candidates.begin() + begin, grasp_candidates.begin() + end);
+    if (!callback(chunk))
+      break;
+  }
+  return true;
+}
+
 Eigen::Vector3d GraspGenerator::getPreGraspDirection(const moveit_msgs::msg::Grasp& grasp,
                                                      const std::string& ee_parent_link)
 {
@@ -154,38 +185,30 @@ geometry_msgs::msg::PoseStamped GraspGenerator::getPreGraspPose(const GraspCandi
   return pre_grasp_pose_eef_mount_msg;
 }
 
+void GraspGenerator::getPreGraspPose(const GraspCandidatePtr& grasp_candidate, Eigen::Isometry3d& pre_grasp_pose)
+{
+  Eigen::Isometry3d grasp_pose_eef_mount;
+  Eigen::fromMsg(grasp_candidate->grasp_.grasp_pose.pose, grasp_pose_eef_mount);
+  pre_grasp_pose = grasp_pose_eef_mount * grasp_candidate->grasp_data_->pre_grasp_offset_;
+}
+
 void GraspGenerator::getGraspWaypoints(const GraspCandidatePtr& grasp_candidate,
                                        EigenSTL::vector_Isometry3d& grasp_waypoints)
 {
   Eigen::Isometry3d grasp_pose;
   Eigen::fromMsg(grasp_candidate->grasp_.grasp_pose.pose, grasp_pose);
 
-  const geometry_msgs::msg::PoseStamped pregrasp_pose_msg =
-      GraspGenerator::getPreGraspPose(grasp_candidate, grasp_candidate->grasp_data_->parent_link_->getName());
-
   // Create waypoints
-  Eigen::Isometry3d pregrasp_pose;
-  Eigen::fromMsg(pregrasp_pose_msg.pose, pregrasp_pose);
-
   Eigen::Isometry3d lifted_grasp_pose = grasp_pose;
   lifted_grasp_pose.translation().z() += grasp_candidate->grasp_data_->lift_distance_desired_;
 
-  // Solve for post grasp retreat
-  Eigen::Isometry3d retreat_pose = lifted_grasp_pose;
-  Eigen::Vector3d postgrasp_vector(grasp_candidate->grasp_.post_grasp_retreat.direction.vector.x,
-                                   grasp_candidate->grasp_.post_grasp_retreat.direction.vector.y,
-                                   grasp_candidate->grasp_.post_grasp_retreat.direction.vector.z);
-  postgrasp_vector.normalize();
-
-  retreat_pose.translation() +=
-      retreat_pose.rotation() * postgrasp_vector * grasp_candidate->grasp_.post_grasp_retreat.desired_distance;
-
   grasp_waypoints.clear();
   grasp_waypoints.resize(4);
-  grasp_waypoints[0] = pregrasp_pose;
+  grasp_waypoints[0] = grasp_pose * grasp_candidate->grasp_data_->pre_grasp_offset_;
   grasp_waypoints[1] = grasp_pose;
   grasp_waypoints[2] = lifted_grasp_pose;
-  grasp_waypoints[3] = retreat_pose;
+  // Solve for post grasp retreat
+  grasp_waypoints[3] = lifted_grasp_pose * grasp_candidate->grasp_data_->post_grasp_retreat_offset_;
 }
 
 void GraspGenerator::publishGraspArrow(const geometry_msgs::msg::Pose& grasp, const GraspDataPtr& grasp_data,
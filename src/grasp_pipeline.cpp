@@ -0,0 +1,212 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+/* Desc:   Runs grasp generation, filtering and approach lift retreat planning as one cancellable pipeline
+*/
+
+#include <moveit_grasps/grasp_pipeline.h>
+
+// C++
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+namespace moveit_grasps
+{
+namespace
+{
+const rclcpp::Logger LOGGER = rclcpp::get_logger("grasp_pipeline");
+}  // namespace
+
+GraspPipeline::GraspPipeline(const GraspGeneratorPtr& grasp_generator, const GraspFilterPtr& grasp_filter,
+                             const GraspPlannerPtr& grasp_planner)
+  : grasp_generator_(grasp_generator), grasp_filter_(grasp_filter), grasp_planner_(grasp_planner)
+{
+}
+
+GraspPipelineResult GraspPipeline::plan(const GraspPipelineRequest& request)
+{
+  std::lock_guard<std::mutex> pipeline_lock(pipeline_mutex_);
+  const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+  GraspPipelineResult result;
+  if (!request.grasp_data_ || !request.planning_scene_ || !request.arm_jmg_ || !request.seed_state_)
+  {
+    RCLCPP_ERROR(LOGGER, "Grasp pipeline request is missing the grasp data, planning scene, arm or seed state");
+    result.status_ = GraspPipelineResult::INVALID_REQUEST;
+    return result;
+  }
+
+  std::atomic<std::size_t> num_planned(0);
+  auto isCancelled = [&request]() { return request.cancel_requested_ && *request.cancel_requested_; };
+  auto isMaxPlannedReached = [&request, &num_planned]() {
+    return request.max_planned_grasps_ > 0 && num_planned >= request.max_planned_grasps_;
+  };
+  auto isStopped = [&]() {
+    return isCancelled() || isMaxPlannedReached() || std::chrono::steady_clock::now() >= request.deadline_ ||
+           !rclcpp::ok();
+  };
+
+  // The planner copies its start state, but gets its own copy since it may run next to the filter
+  const moveit::core::RobotStatePtr planning_start_state =
+      std::make_shared<moveit::core::RobotState>(*request.seed_state_);
+  const std::size_t max_successful_paths = grasp_planner_->getMaxSuccessfulPaths();
+
+  // Only touched by the thread that plans, merged into the result once it is done
+  GraspStats planning_stats;
+  std::vector<GraspCandidatePtr> planned_candidates;
+  auto planCandidates = [&](std::vector<GraspCandidatePtr>& grasp_candidates) {
+    if (request.max_planned_grasps_ > 0)
+      grasp_planner_->setMaxSuccessfulPaths(request.max_planned_grasps_ - num_planned);
+    const bool path_found = grasp_planner_->planAllApproachLiftRetreat(grasp_candidates, planning_start_state,
+                                                                       request.planning_scene_,
+                                                                       request.grasp_object_id_);
+    planning_stats.merge(grasp_planner_->getStats());
+    if (path_found)
+    {
+      planned_candidates.insert(planned_candidates.end(), grasp_candidates.begin(), grasp_candidates.end());
+      num_planned += grasp_candidates.size();
+    }
+  };
+
+  // Plan on a separate thread unless the planner needs the worker pool the filter is using
+  const bool overlap_planning =
+      !grasp_planner_->getIkWorkerPool() || grasp_planner_->getIkWorkerPool() != grasp_filter_->getIkWorkerPool();
+  std::mutex queue_mutex;
+  std::condition_variable queue_condition;
+  std::deque<std::vector<GraspCandidatePtr>> planning_queue;
+  bool generation_done = false;
+
+  std::thread planning_thread;
+  if (overlap_planning)
+  {
+    planning_thread = std::thread([&]() {
+      while (true)
+      {
+        std::vector<GraspCandidatePtr> grasp_candidates;
+        {
+          std::unique_lock<std::mutex> queue_lock(queue_mutex);
+          queue_condition.wait(queue_lock, [&]() { return !planning_queue.empty() || generation_done; });
+          if (planning_queue.empty())
+            return;
+          grasp_candidates = std::move(planning_queue.front());
+          planning_queue.pop_front();
+        }
+        // Keep draining the queue after a stop so the generation never waits on this thread
+        if (!isStopped())
+          planCandidates(grasp_candidates);
+      }
+    });
+  }
+
+  grasp_generator_->streamGrasps(
+      request.cuboid_pose_, request.depth_, request.width_, request.height_, request.grasp_data_,
+      [&](std::vector<GraspCandidatePtr>& grasp_candidates) {
+        if (isStopped())
+          return false;
+        result.num_generated_ += grasp_candidates.size();
+
+        grasp_filter_->filterGrasps(grasp_candidates, request.planning_scene_, request.arm_jmg_, request.seed_state_,
+                                    request.filter_pregrasp_, request.grasp_object_id_);
+        result.stats_.merge(grasp_filter_->getStats());
+        if (!grasp_filter_->removeInvalidAndFilter(grasp_candidates))
+          return !isStopped();
+        result.num_ik_valid_ += grasp_candidates.size();
+
+        if (overlap_planning)
+        {
+          std::lock_guard<std::mutex> queue_lock(queue_mutex);
+          planning_queue.push_back(std::move(grasp_candidates));
+          queue_condition.notify_one();
+        }
+        else
+        {
+          planCandidates(grasp_candidates);
+        }
+        return !isStopped();
+      },
+      request.chunk_size_);
+
+  if (overlap_planning)
+  {
+    {
+      std::lock_guard<std::mutex> queue_lock(queue_mutex);
+      generation_done = true;
+    }
+    queue_condition.notify_one();
+    planning_thread.join();
+  }
+  grasp_planner_->setMaxSuccessfulPaths(max_successful_paths);
+  result.stats_.merge(grasp_generator_->getStats());
+  result.stats_.merge(planning_stats);
+
+  // Chunks are planned in order of their best grasp, but a later chunk can still hold better grasps
+  std::stable_sort(planned_candidates.begin(), planned_candidates.end(), GraspFilter::compareGraspScores);
+  if (request.max_planned_grasps_ > 0 && planned_candidates.size() > request.max_planned_grasps_)
+    planned_candidates.resize(request.max_planned_grasps_);
+  result.grasp_candidates_ = std::move(planned_candidates);
+
+  if (isCancelled())
+    result.status_ = GraspPipelineResult::CANCELLED;
+  else if (!isMaxPlannedReached() && std::chrono::steady_clock::now() >= request.deadline_)
+    result.status_ = GraspPipelineResult::DEADLINE_REACHED;
+  else if (result.grasp_candidates_.empty())
+    result.status_ = GraspPipelineResult::NO_VALID_GRASPS;
+  else
+    result.status_ = GraspPipelineResult::SUCCESS;
+
+  result.duration_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  result.stats_.duration_ = result.duration_;
+  if (stats_publisher_)
+    stats_publisher_->publish(result.stats_);
+  RCLCPP_INFO_STREAM(LOGGER, "Planned " << result.grasp_candidates_.size() << " of " << result.num_ik_valid_
+                                        << " IK valid and " << result.num_generated_ << " generated grasps in "
+                                        << result.duration_ << "s");
+  return result;
+}
+
+std::future<GraspPipelineResult> GraspPipeline::planAsync(const GraspPipelineRequest& request,
+                                                          const GraspPipelineCallback& callback)
+{
+  return std::async(std::launch::async, [this, request, callback]() {
+    GraspPipelineResult result = plan(request);
+    if (callback)
+      callback(result);
+    return result;
+  });
+}
+
+}  // namespace moveit_grasps
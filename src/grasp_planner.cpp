@@ -44,6 +44,11 @@
 // Parameter loading
 #include <rosparam_shortcuts/rosparam_shortcuts.h>
 
+// C++
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
 namespace moveit_grasps
 {
 constexpr char ENABLED_PARENT_NAME[] = "grasp_planner";  // for namespacing logging messages
@@ -53,6 +58,24 @@ GraspPlanner::GraspPlanner(rclcpp::Node::SharedPtr node, const moveit_visual_too
   : nh_(node), visual_tools_(visual_tools)
 {
   loadEnabledSettings();
+
+  // Keep the snapshot in sync with runtime parameter changes
+  enabled_settings_callback_handle_ =
+      nh_->add_on_set_parameters_callback([this](const std::vector<rclcpp::Parameter>& parameters) {
+        const std::string prefix = ENABLED_SETTINGS_NAMESPACE + ".";
+        for (const rclcpp::Parameter& parameter : parameters)
+        {
+          if (parameter.get_type() != rclcpp::ParameterType::PARAMETER_BOOL ||
+              parameter.get_name().compare(0, prefix.size(), prefix) != 0)
+            continue;
+          std::atomic<bool>* setting = getEnabledSetting(parameter.get_name().substr(prefix.size()));
+          if (setting)
+            setting->store(parameter.as_bool());
+        }
+        rcl_interfaces::msg::SetParametersResult result;
+        result.successful = true;
+        return result;
+      });
 }
 
 bool GraspPlanner::planAllApproachLiftRetreat(
@@ -72,47 +95,96 @@ bool GraspPlanner::planAllApproachLiftRetreat(std::vector<GraspCandidatePtr>& gr
 {
   RCLCPP_INFO_STREAM(rclcpp::get_logger("grasp_planner"),
                      "Planning all remaining grasps with approach lift retreat cartesian path");
+  stats_.clear();
+  const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
 
   // For each remaining grasp, calculate entire approach, lift, and retreat path.
   // Remove those that have no valid path
-  bool verbose_cartesian_filtering = isEnabled("verbose_cartesian_filtering");
+  const bool verbose_cartesian_filtering = verbose_cartesian_filtering_;
+  const bool show_cartesian_waypoints = show_cartesian_waypoints_;
+  const bool collision_checking_verbose = collision_checking_verbose_;
   std::size_t grasp_candidates_before_cartesian_path = grasp_candidates.size();
 
-  std::size_t count = 0;
-  for (std::vector<GraspCandidatePtr>::iterator grasp_it = grasp_candidates.begin(); grasp_it != grasp_candidates.end();)
+  // Plan the best grasps first so that the kept paths do not depend on the thread count or the debug settings
+  std::stable_sort(grasp_candidates.begin(), grasp_candidates.end(),
+                   [](const GraspCandidatePtr& grasp_a, const GraspCandidatePtr& grasp_b) {
+                     return grasp_a->grasp_.grasp_quality > grasp_b->grasp_.grasp_quality;
+                   });
+
+  // Debugging output and visualizations require a single thread
+  std::size_t num_threads = 1;
+  if (ik_worker_pool_ && !verbose_cartesian_filtering && !show_cartesian_waypoints && !collision_checking_verbose)
+    num_threads = std::min(ik_worker_pool_->getNumWorkers(), grasp_candidates.size());
+
+  // The ACM and attached object setup is the same for all candidates
+  PreparedGraspScene prepared_scene;
+  if (!grasp_candidates.empty())
+    prepareGraspScene(planning_scene, grasp_candidates.front()->grasp_data_, grasp_object_id, prepared_scene);
+  if (compact_trajectories_)
+    prepared_scene.reference_state_ = std::make_shared<const moveit::core::RobotState>(*robot_state);
+
+  if (num_threads > 1)
   {
+    planAllApproachLiftRetreatParallel(grasp_candidates, robot_state, prepared_scene, num_threads);
     if (!rclcpp::ok())
       return false;
-
-    if (isEnabled("verbose_cartesian_filtering"))
+  }
+  else
+  {
+    std::size_t count = 0;
+    std::size_t num_successful_paths = 0;
+    for (std::vector<GraspCandidatePtr>::iterator grasp_it = grasp_candidates.begin();
+         grasp_it != grasp_candidates.end();)
     {
-      RCLCPP_INFO_STREAM(rclcpp::get_logger("grasp_planner"), "");
-      RCLCPP_INFO_STREAM(rclcpp::get_logger("grasp_planner"), "Attempting to plan cartesian grasp path #"
-                                                                  << count++ << ". " << grasp_candidates.size()
-                                                                  << " remaining.");
-    }
+      if (!rclcpp::ok())
+        return false;
 
-    if (!planApproachLiftRetreat(*grasp_it, robot_state, planning_scene, verbose_cartesian_filtering, grasp_object_id))
-    {
-      RCLCPP_INFO_STREAM(rclcpp::get_logger("grasp_planner"),
-                         "Grasp candidate was unable to find valid cartesian waypoint path");
+      // Drop the remaining candidates once enough paths were found
+      if (max_successful_paths_ > 0 && num_successful_paths >= max_successful_paths_)
+      {
+        grasp_candidates.erase(grasp_it, grasp_candidates.end());
+        break;
+      }
 
-      grasp_it = grasp_candidates.erase(grasp_it);  // not valid
-    }
-    else
-    {
-      ++grasp_it;  // move to next grasp
-    }
+      if (verbose_cartesian_filtering)
+      {
+        RCLCPP_INFO_STREAM(rclcpp::get_logger("grasp_planner"), "");
+        RCLCPP_INFO_STREAM(rclcpp::get_logger("grasp_planner"), "Attempting to plan cartesian grasp path #"
+                                                                    << count++ << ". " << grasp_candidates.size()
+                                                                    << " remaining.");
+      }
 
-    if (isEnabled("show_cartesian_waypoints"))
-    {
-      visual_tools_->deleteAllMarkers();
-      visual_tools_->trigger();
+      bool path_found;
+      {
+        ScopedGraspStageTimer timer(&stats_, CARTESIAN_PLANNING);
+        path_found = planApproachLiftRetreat(*grasp_it, robot_state, prepared_scene, verbose_cartesian_filtering,
+                                             show_cartesian_waypoints, collision_checking_verbose);
+      }
+      if (!path_found)
+      {
+        RCLCPP_INFO_STREAM(rclcpp::get_logger("grasp_planner"),
+                           "Grasp candidate was unable to find valid cartesian waypoint path");
+
+        grasp_it = grasp_candidates.erase(grasp_it);  // not valid
+      }
+      else
+      {
+        ++grasp_it;  // move to next grasp
+        ++num_successful_paths;
+      }
+
+      if (show_cartesian_waypoints)
+      {
+        visual_tools_->deleteAllMarkers();
+        visual_tools_->trigger();
+      }
     }
   }
 
+  stats_.duration_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
   // Results
-  if (isEnabled("statistics_verbose"))
+  if (statistics_verbose_)
   {
     std::cout << std::endl;
     std::cout << "-------------------------------------------------------" << std::endl;
@@ -133,6 +205,81 @@ bool GraspPlanner::planAllApproachLiftRetreat(std::vector<GraspCandidatePtr>& gr
   return true;
 }
 
+void GraspPlanner::planAllApproachLiftRetreatParallel(std::vector<GraspCandidatePtr>& grasp_candidates,
+                                                      const moveit::core::RobotStatePtr& robot_state,
+                                                      const PreparedGraspScene& prepared_scene,
+                                                      std::size_t num_threads)
+{
+  RCLCPP_INFO_STREAM(rclcpp::get_logger("grasp_planner"),
+                     "Planning " << grasp_candidates.size() << " grasps with " << num_threads << " threads");
+
+  // Keep the pool until the workers are done, it may be shared with a filter used from another thread
+  const IkWorkerPool::Lease ik_worker_pool_lease = ik_worker_pool_->acquire();
+  ik_worker_pool_->setRobotStates(*robot_state, num_threads);
+
+  // Candidates at or after this index are not needed because enough earlier candidates have a valid path
+  std::vector<char> path_found(grasp_candidates.size(), false);
+  std::size_t cutoff = grasp_candidates.size();
+  std::mutex path_found_mutex;
+
+  // Every thread times into its own stats, merged below
+  std::vector<GraspStats> thread_stats(num_threads);
+  for (GraspStats& stats : thread_stats)
+    stats.thread_busy_durations_.resize(num_threads, 0);
+  const std::chrono::steady_clock::time_point parallel_start_time = std::chrono::steady_clock::now();
+
+  ik_worker_pool_->run(grasp_candidates.size(), num_threads, [&](std::size_t thread_id, std::size_t grasp_id) {
+    if (!rclcpp::ok())
+      return;
+    {
+      std::lock_guard<std::mutex> lock(path_found_mutex);
+      if (grasp_id >= cutoff)
+        return;
+    }
+
+    // Planning only runs in parallel with all debug settings disabled
+    bool valid_path;
+    {
+      ScopedGraspStageTimer timer(&thread_stats[thread_id], CARTESIAN_PLANNING);
+      valid_path = planApproachLiftRetreat(grasp_candidates[grasp_id], ik_worker_pool_->getRobotState(thread_id),
+                                           prepared_scene, false, false, false);
+      thread_stats[thread_id].thread_busy_durations_[thread_id] += timer.getElapsed();
+    }
+    if (!valid_path)
+      return;
+
+    std::lock_guard<std::mutex> lock(path_found_mutex);
+    path_found[grasp_id] = true;
+    if (max_successful_paths_ == 0)
+      return;
+
+    // The first max_successful_paths_ valid candidates are final once that many valid ones precede the cutoff
+    std::size_t num_successful_paths = 0;
+    for (std::size_t i = 0; i < cutoff; ++i)
+    {
+      if (path_found[i] && ++num_successful_paths == max_successful_paths_)
+      {
+        cutoff = i + 1;
+        break;
+      }
+    }
+  });
+
+  for (const GraspStats& stats : thread_stats)
+    stats_.merge(stats);
+  stats_.parallel_duration_ +=
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - parallel_start_time).count();
+
+  // Keep the valid candidates, in order
+  std::size_t num_kept = 0;
+  for (std::size_t grasp_id = 0; grasp_id < cutoff; ++grasp_id)
+  {
+    if (path_found[grasp_id])
+      grasp_candidates[num_kept++] = grasp_candidates[grasp_id];
+  }
+  grasp_candidates.resize(num_kept);
+}
+
 bool GraspPlanner::planApproachLiftRetreat(GraspCandidatePtr& grasp_candidate,
                                            const moveit::core::RobotStatePtr& robot_state,
                                            const planning_scene_monitor::PlanningSceneMonitorPtr& planning_scene_monitor,
@@ -149,12 +296,22 @@ bool GraspPlanner::planApproachLiftRetreat(GraspCandidatePtr& grasp_candidate,
                                            const moveit::core::RobotStatePtr& robot_state,
                                            const planning_scene::PlanningSceneConstPtr& planning_scene,
                                            bool verbose_cartesian_filtering, const std::string& grasp_object_id)
+{
+  PreparedGraspScene prepared_scene;
+  prepareGraspScene(planning_scene, grasp_candidate->grasp_data_, grasp_object_id, prepared_scene);
+  return planApproachLiftRetreat(grasp_candidate, robot_state, prepared_scene, verbose_cartesian_filtering,
+                                 show_cartesian_waypoints_, collision_checking_verbose_);
+}
+
+bool GraspPlanner::planApproachLiftRetreat(GraspCandidatePtr& grasp_candidate,
+                                           const moveit::core::RobotStatePtr& robot_state,
+                                           const PreparedGraspScene& prepared_scene, bool verbose_cartesian_filtering,
+                                           bool show_cartesian_waypoints, bool collision_checking_verbose)
 {
   EigenSTL::vector_Isometry3d waypoints;
   GraspGenerator::getGraspWaypoints(grasp_candidate, waypoints);
 
   // Visualize waypoints
-  bool show_cartesian_waypoints = isEnabled("show_cartesian_waypoints");
   if (show_cartesian_waypoints)
   {
     visual_tools_->publishAxisLabeled(waypoints[0], "pregrasp");
@@ -189,10 +346,14 @@ bool GraspPlanner::planApproachLiftRetreat(GraspCandidatePtr& grasp_candidate,
     return false;
   }
 
-  if (!computeCartesianWaypointPath(grasp_candidate, planning_scene, start_state, waypoints, grasp_object_id))
+  if (!computeCartesianWaypointPath(grasp_candidate, prepared_scene, start_state, waypoints,
+                                    collision_checking_verbose))
   {
     RCLCPP_DEBUG_STREAM(rclcpp::get_logger("grasp_planner.waypoints"), "Unable to plan approach lift retreat path");
 
+    // Free the states of the failed attempts right away
+    if (compact_trajectories_)
+      grasp_candidate->segmented_cartesian_traj_.clear();
     return false;
   }
 
@@ -224,6 +385,13 @@ bool GraspPlanner::planApproachLiftRetreat(GraspCandidatePtr& grasp_candidate,
                                          grasp_candidate->grasp_data_->arm_jmg_, wait_for_animation);
   }
 
+  if (compact_trajectories_)
+  {
+    grasp_candidate->compactCartesianTrajectories(
+        prepared_scene.reference_state_ ? prepared_scene.reference_state_ :
+                                          std::make_shared<const moveit::core::RobotState>(*robot_state));
+  }
+
   if (verbose_cartesian_filtering)
     waitForNextStep("try next candidate grasp");
 
@@ -247,6 +415,26 @@ bool GraspPlanner::computeCartesianWaypointPath(GraspCandidatePtr& grasp_candida
                                                 const moveit::core::RobotStatePtr& start_state,
                                                 const EigenSTL::vector_Isometry3d& waypoints,
                                                 const std::string& grasp_object_id)
+{
+  PreparedGraspScene prepared_scene;
+  prepareGraspScene(planning_scene, grasp_candidate->grasp_data_, grasp_object_id, prepared_scene);
+  return computeCartesianWaypointPath(grasp_candidate, prepared_scene, start_state, waypoints);
+}
+
+bool GraspPlanner::computeCartesianWaypointPath(GraspCandidatePtr& grasp_candidate,
+                                                const PreparedGraspScene& prepared_scene,
+                                                const moveit::core::RobotStatePtr& start_state,
+                                                const EigenSTL::vector_Isometry3d& waypoints)
+{
+  return computeCartesianWaypointPath(grasp_candidate, prepared_scene, start_state, waypoints,
+                                      collision_checking_verbose_);
+}
+
+bool GraspPlanner::computeCartesianWaypointPath(GraspCandidatePtr& grasp_candidate,
+                                                const PreparedGraspScene& prepared_scene,
+                                                const moveit::core::RobotStatePtr& start_state,
+                                                const EigenSTL::vector_Isometry3d& waypoints,
+                                                bool collision_checking_verbose)
 {
   // End effector parent link (arm tip for ik solving)
   const moveit::core::LinkModel* ik_tip_link = grasp_candidate->grasp_data_->parent_link_;
@@ -259,7 +447,6 @@ bool GraspPlanner::computeCartesianWaypointPath(GraspCandidatePtr& grasp_candida
   const double jump_threshold = 4;  // config_->jump_threshold_; // aka jump factor
 
   // Collision setting
-  const bool collision_checking_verbose = isEnabled("collision_checking_verbose");
   const bool only_check_self_collision = false;
 
   // Reference frame setting
@@ -274,6 +461,21 @@ bool GraspPlanner::computeCartesianWaypointPath(GraspCandidatePtr& grasp_candida
     return false;
   }
 
+  // Collision check, the scenes are shared by all attempts. Without verbose the headless checks of the scene are used
+  moveit::core::GroupStateValidityCallbackFn verbose_approach_constraint_fn;
+  moveit::core::GroupStateValidityCallbackFn verbose_lift_constraint_fn;
+  if (collision_checking_verbose)
+  {
+    verbose_approach_constraint_fn = boost::bind(&isGraspStateValid, prepared_scene.approach_scene_.get(), true,
+                                                 only_check_self_collision, visual_tools_, _1, _2, _3);
+    verbose_lift_constraint_fn = boost::bind(&isGraspStateValid, prepared_scene.lift_scene_.get(), true,
+                                             only_check_self_collision, visual_tools_, _1, _2, _3);
+  }
+  const moveit::core::GroupStateValidityCallbackFn& approach_constraint_fn =
+      collision_checking_verbose ? verbose_approach_constraint_fn : prepared_scene.approach_constraint_fn_;
+  const moveit::core::GroupStateValidityCallbackFn& lift_constraint_fn =
+      collision_checking_verbose ? verbose_lift_constraint_fn : prepared_scene.lift_constraint_fn_;
+
   std::size_t attempts = 0;
   static const std::size_t MAX_IK_ATTEMPTS = 5;
   bool valid_path_found = false;
@@ -293,27 +495,13 @@ bool GraspPlanner::computeCartesianWaypointPath(GraspCandidatePtr& grasp_candida
       return false;
     }
 
-    // Create a clone where we modify the ACM to disable collision checking between the end effector and object
-    planning_scene::PlanningScenePtr scene = planning_scene::PlanningScene::clone(planning_scene);
-    // If the grasp_object_id is set then we disable collision checking in the planning scene clone
-    if (!grasp_object_id.empty() && scene->knowsFrameTransform(grasp_object_id))
-    {
-      std::vector<std::string> ee_link_names = grasp_candidate->grasp_data_->ee_jmg_->getLinkModelNames();
-      for (const auto& ee_link : ee_link_names)
-        scene->getAllowedCollisionMatrixNonConst().setEntry(grasp_object_id, ee_link, true);
-    }
-    // Collision check
-    moveit::core::GroupStateValidityCallbackFn constraint_fn =
-        boost::bind(&isGraspStateValid, scene.get(), collision_checking_verbose, only_check_self_collision,
-                    visual_tools_, _1, _2, _3);
-
     // Compute Cartesian Path
     grasp_candidate->segmented_cartesian_traj_.clear();
     grasp_candidate->segmented_cartesian_traj_.resize(3);
     double valid_approach_percentage = moveit::core::CartesianInterpolator::computeCartesianPath(
         start_state_copy.get(), grasp_candidate->grasp_data_->arm_jmg_,
         grasp_candidate->segmented_cartesian_traj_[APPROACH], ik_tip_link, waypoints[APPROACH], global_reference_frame,
-        moveit::core::MaxEEFStep(max_step), moveit::core::JumpThreshold(jump_threshold), constraint_fn,
+        moveit::core::MaxEEFStep(max_step), moveit::core::JumpThreshold(jump_threshold), approach_constraint_fn,
         kinematics::KinematicsQueryOptions());
 
     if (!grasp_candidate->getGraspStateClosedEEOnly(start_state_copy))
@@ -322,54 +510,31 @@ bool GraspPlanner::computeCartesianWaypointPath(GraspCandidatePtr& grasp_candida
       return false;
     }
 
-    // Attach CO to end effector
-    if (!grasp_object_id.empty() && scene->knowsFrameTransform(grasp_object_id))
+    // Attach the object to the end effector at the end of the approach path
+    if (!prepared_scene.object_shapes_.empty())
     {
-      // Create an AttachedCollisionObject
-      moveit_msgs::msg::AttachedCollisionObject aco;
-
-      // Create a reference to the collision object for convenience
-      moveit_msgs::msg::CollisionObject& suction_voxel_co = aco.object;
-
-      suction_voxel_co.id = grasp_object_id;
-      suction_voxel_co.header.frame_id = ik_tip_link->getName();
-
-      // Set the aco attached link name
-      aco.link_name = ik_tip_link->getName();
-
-      // move the robot in the ps to the end of the approach path.
-      scene->setCurrentState(*start_state_copy);
-
-      // Mark object to be added
-      suction_voxel_co.operation = moveit_msgs::msg::CollisionObject::ADD;
-      if (!scene->processAttachedCollisionObjectMsg(aco))
-      {
-        RCLCPP_WARN_STREAM(rclcpp::get_logger("grasp_planner"), "Failed to attach: " << aco.object.id);
-      }
-      else
-      {
-        auto start_state_with_body = std::make_shared<moveit::core::RobotState>(scene->getCurrentState());
-        std::vector<const moveit::core::AttachedBody*> attached_bodies;
-        start_state_with_body->getAttachedBodies(attached_bodies);
-        for (const auto& ab : attached_bodies)
-          start_state_copy->attachBody(new moveit::core::AttachedBody(
-              ab->getAttachedLink(), ab->getName(), ab->getShapes(), ab->getFixedTransforms(), ab->getTouchLinks(),
-              ab->getDetachPosture()));  // TODO TODO TODO
-        constraint_fn = boost::bind(&isGraspStateValid, scene.get(), collision_checking_verbose,
-                                    only_check_self_collision, visual_tools_, _1, _2, _3);
-      }
+      start_state_copy->update();
+      const Eigen::Isometry3d tip_to_world = start_state_copy->getGlobalLinkTransform(ik_tip_link).inverse();
+      EigenSTL::vector_Isometry3d attach_transforms;
+      attach_transforms.reserve(prepared_scene.object_shape_poses_.size());
+      for (const Eigen::Isometry3d& shape_pose : prepared_scene.object_shape_poses_)
+        attach_transforms.push_back(tip_to_world * shape_pose);
+
+      const std::set<std::string> touch_links = { ik_tip_link->getName() };
+      start_state_copy->attachBody(prepared_scene.object_id_, prepared_scene.object_shapes_, attach_transforms,
+                                   touch_links, ik_tip_link->getName());
     }
 
     double valid_lift_retreat_percentage = moveit::core::CartesianInterpolator::computeCartesianPath(
         start_state_copy.get(), grasp_candidate->grasp_data_->arm_jmg_,
         grasp_candidate->segmented_cartesian_traj_[LIFT], ik_tip_link, waypoints[LIFT], global_reference_frame,
-        moveit::core::MaxEEFStep(max_step), moveit::core::JumpThreshold(jump_threshold), constraint_fn,
+        moveit::core::MaxEEFStep(max_step), moveit::core::JumpThreshold(jump_threshold), lift_constraint_fn,
         kinematics::KinematicsQueryOptions());
 
     valid_lift_retreat_percentage *= moveit::core::CartesianInterpolator::computeCartesianPath(
         start_state_copy.get(), grasp_candidate->grasp_data_->arm_jmg_,
         grasp_candidate->segmented_cartesian_traj_[RETREAT], ik_tip_link, waypoints[RETREAT], global_reference_frame,
-        moveit::core::MaxEEFStep(max_step), moveit::core::JumpThreshold(jump_threshold), constraint_fn,
+        moveit::core::MaxEEFStep(max_step), moveit::core::JumpThreshold(jump_threshold), lift_constraint_fn,
         kinematics::KinematicsQueryOptions());
 
     RCLCPP_DEBUG_STREAM(rclcpp::get_logger("grasp_planner.waypoints"),
@@ -386,7 +551,7 @@ bool GraspPlanner::computeCartesianWaypointPath(GraspCandidatePtr& grasp_candida
       valid_path_found = true;
       break;
     }
-  }  // end while AND scoped pointer of locked planning scenep
+  }  // end while
 
   if (!valid_path_found)
   {
@@ -398,6 +563,61 @@ bool GraspPlanner::computeCartesianWaypointPath(GraspCandidatePtr& grasp_candida
   return true;
 }
 
+namespace
+{
+/**
+ * \brief Point the headless collision checks at the scenes, they only hold the raw scene pointer
+ */
+void setHeadlessConstraintFns(PreparedGraspScene& prepared_scene)
+{
+  const planning_scene::PlanningScene* approach_scene = prepared_scene.approach_scene_.get();
+  const planning_scene::PlanningScene* lift_scene = prepared_scene.lift_scene_.get();
+  prepared_scene.approach_constraint_fn_ = [approach_scene](moveit::core::RobotState* robot_state,
+                                                            const moveit::core::JointModelGroup* group,
+                                                            const double* ik_solution) {
+    return checkGraspState(approach_scene, nullptr, NoCollisionReport(), robot_state, group, ik_solution);
+  };
+  prepared_scene.lift_constraint_fn_ = [lift_scene](moveit::core::RobotState* robot_state,
+                                                    const moveit::core::JointModelGroup* group,
+                                                    const double* ik_solution) {
+    return checkGraspState(lift_scene, nullptr, NoCollisionReport(), robot_state, group, ik_solution);
+  };
+}
+}  // namespace
+
+void GraspPlanner::prepareGraspScene(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                     const GraspDataPtr& grasp_data, const std::string& grasp_object_id,
+                                     PreparedGraspScene& prepared_scene) const
+{
+  // A diff is enough since only the ACM and the world objects are modified
+  prepared_scene.approach_scene_ = planning_scene->diff();
+  prepared_scene.lift_scene_ = prepared_scene.approach_scene_;
+  prepared_scene.object_id_ = grasp_object_id;
+  prepared_scene.object_shapes_.clear();
+  prepared_scene.object_shape_poses_.clear();
+  setHeadlessConstraintFns(prepared_scene);
+
+  // If the grasp_object_id is set then we disable collision checking between the end effector and the object
+  if (grasp_object_id.empty() || !prepared_scene.approach_scene_->knowsFrameTransform(grasp_object_id))
+    return;
+
+  for (const std::string& ee_link : grasp_data->ee_jmg_->getLinkModelNames())
+    prepared_scene.approach_scene_->getAllowedCollisionMatrixNonConst().setEntry(grasp_object_id, ee_link, true);
+
+  // During lift and retreat the object moves with the end effector, so it is removed from the world and attached to
+  // the robot state of each attempt instead
+  collision_detection::World::ObjectConstPtr object =
+      prepared_scene.approach_scene_->getWorld()->getObject(grasp_object_id);
+  if (!object)
+    return;
+
+  prepared_scene.object_shapes_ = object->shapes_;
+  prepared_scene.object_shape_poses_ = object->shape_poses_;
+  prepared_scene.lift_scene_ = prepared_scene.approach_scene_->diff();
+  prepared_scene.lift_scene_->getWorldNonConst()->removeObject(grasp_object_id);
+  setHeadlessConstraintFns(prepared_scene);
+}
+
 void GraspPlanner::waitForNextStep(const std::string& message)
 {
   if (wait_for_next_step_callback_)
@@ -411,34 +631,45 @@ void GraspPlanner::setWaitForNextStepCallback(WaitForNextStepCallback callback)
 
 bool GraspPlanner::loadEnabledSettings()
 {
-  // Check if the map has been loaded yet
-  if (!enabled_settings_loaded_)
+  static const std::vector<std::string> SETTING_NAMES = { "statistics_verbose", "verbose_cartesian_filtering",
+                                                          "show_cartesian_waypoints", "collision_checking_verbose" };
+
+  bool error = false;
+  for (const std::string& setting_name : SETTING_NAMES)
   {
-    // enabled_settings_loaded_ = true;
-    return true;  // rosparam_shortcuts::get(nh_, ENABLED_SETTINGS_NAMESPACE, enabled_setting_);
+    // Missing settings are reported once here and stay disabled
+    bool param = false;
+    if (!rosparam_shortcuts::get(nh_, ENABLED_SETTINGS_NAMESPACE + "." + setting_name, param))
+    {
+      param = false;
+      error = true;
+    }
+    getEnabledSetting(setting_name)->store(param);
   }
-  return true;
+  return !error;
 }
 
 bool GraspPlanner::isEnabled(const std::string& setting_name)
 {
-  // Check if the map has been loaded yet. it is preferred if this is called manually
-  // if (!enabled_settings_loaded_)
-  //   RCLCPP_ERROR_STREAM(rclcpp::get_logger("rosparam_shortcuts"), "Enabled settings are not yet loaded e.g. call
-  //   loadEnabledSettings()");
-
-  // std::map<std::string, bool>::iterator it = enabled_setting_.find(setting_name);
-  bool param;
-  if (rosparam_shortcuts::get(nh_, ENABLED_SETTINGS_NAMESPACE + "." + setting_name, param))
-  {
-    // Element found;
-    return param;
-  }
-  RCLCPP_ERROR_STREAM(rclcpp::get_logger("rosparam_shortcuts"),
-                      "isEnabled() key '" << nh_->get_namespace() << "/" << ENABLED_SETTINGS_NAMESPACE << "/"
-                                          << setting_name << "' does not exist on the parameter server");
+  const std::atomic<bool>* setting = getEnabledSetting(setting_name);
+  if (setting)
+    return *setting;
 
+  RCLCPP_ERROR_STREAM(rclcpp::get_logger("grasp_planner"), "isEnabled() unknown setting '" << setting_name << "'");
   return false;
 }
 
+std::atomic<bool>* GraspPlanner::getEnabledSetting(const std::string& setting_name)
+{
+  if (setting_name == "statistics_verbose")
+    return &statistics_verbose_;
+  if (setting_name == "verbose_cartesian_filtering")
+    return &verbose_cartesian_filtering_;
+  if (setting_name == "show_cartesian_waypoints")
+    return &show_cartesian_waypoints_;
+  if (setting_name == "collision_checking_verbose")
+    return &collision_checking_verbose_;
+  return nullptr;
+}
+
 }  // namespace moveit_grasps
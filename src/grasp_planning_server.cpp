@@ -0,0 +1,324 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Composable node that serves grasp generation, filtering and planning to several clients
+*/
+
+#include <moveit_grasps/grasp_planning_server.h>
+
+// ROS
+#include <rclcpp_components/register_node_macro.hpp>
+
+// Parameter loading
+#include <rosparam_shortcuts/rosparam_shortcuts.h>
+
+// C++
+#include <algorithm>
+#include <chrono>
+
+namespace moveit_grasps
+{
+namespace
+{
+const std::string PARAM_NAMESPACE = "grasp_planning_server";
+}  // namespace
+
+GraspPlanningServer::GraspPlanningServer(const rclcpp::NodeOptions& options)
+  : rclcpp::Node("grasp_planning_server", rclcpp::NodeOptions(options).automatically_declare_parameters_from_overrides(
+                                              true))
+  , LOGGER(rclcpp::get_logger("grasp_planning_server"))
+{
+  // The grasp classes keep a shared pointer to the node, which is only available once the constructor returned
+  initialize_timer_ = create_wall_timer(std::chrono::seconds(0), [this]() {
+    initialize_timer_->cancel();
+    initialize();
+  });
+}
+
+bool GraspPlanningServer::initialize()
+{
+  const rclcpp::Node::SharedPtr node = shared_from_this();
+
+  // Load the default arm and end effector
+  std::size_t error = 0;
+  error += !rosparam_shortcuts::get(node, "planning_group_name", planning_group_name_);
+  error += !rosparam_shortcuts::get(node, "ee_group_name", ee_group_name_);
+  if (error)
+  {
+    RCLCPP_ERROR(LOGGER, "Missing the planning_group_name or ee_group_name parameter, not serving grasps");
+    return false;
+  }
+
+  int max_planned_grasps;
+  int num_threads;
+  std::string grasp_database_file;
+  get_parameter_or(PARAM_NAMESPACE + ".max_planned_grasps", max_planned_grasps, 10);
+  get_parameter_or(PARAM_NAMESPACE + ".timeout", timeout_, 0.0);
+  get_parameter_or(PARAM_NAMESPACE + ".num_threads", num_threads, 0);
+  get_parameter_or(PARAM_NAMESPACE + ".grasp_database", grasp_database_file, std::string());
+  max_planned_grasps_ = static_cast<std::size_t>(std::max(max_planned_grasps, 0));
+
+  // ---------------------------------------------------------------------------------------------
+  // Load the planning scene to take the request snapshots from
+  planning_scene_monitor_ = std::make_shared<planning_scene_monitor::PlanningSceneMonitor>(node, "robot_description");
+  if (!planning_scene_monitor_->getPlanningScene())
+  {
+    RCLCPP_ERROR(LOGGER, "Planning scene not configured, not serving grasps");
+    return false;
+  }
+  planning_scene_monitor_->startSceneMonitor();
+  planning_scene_monitor_->startWorldGeometryMonitor();
+  planning_scene_monitor_->startStateMonitor();
+
+  const moveit::core::RobotModelConstPtr& robot_model = planning_scene_monitor_->getRobotModel();
+  const moveit::core::JointModelGroup* arm_jmg = robot_model->getJointModelGroup(planning_group_name_);
+  if (!arm_jmg)
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Unknown planning group " << planning_group_name_ << ", not serving grasps");
+    return false;
+  }
+
+  // The grasp classes only publish in their debug modes
+  visual_tools_ = std::make_shared<moveit_visual_tools::MoveItVisualTools>(
+      node, robot_model->getModelFrame(), "/rviz_visual_tools", planning_scene_monitor_);
+  visual_tools_->loadSharedRobotState();
+
+  // ---------------------------------------------------------------------------------------------
+  // Load grasp data specific to our robot
+  grasp_data_ = std::make_shared<TwoFingerGraspData>(node, ee_group_name_, robot_model);
+  if (!grasp_data_->loadGraspData(node, ee_group_name_))
+  {
+    RCLCPP_ERROR(LOGGER, "Failed to load Grasp Data parameters, not serving grasps");
+    return false;
+  }
+
+  // ---------------------------------------------------------------------------------------------
+  // Load the grasp classes, the filter and the planner share one pool of IK workers
+  grasp_generator_ = std::make_shared<TwoFingerGraspGenerator>(node, visual_tools_);
+  grasp_filter_ = std::make_shared<TwoFingerGraspFilter>(node, visual_tools_->getSharedRobotState(), visual_tools_);
+  grasp_planner_ = std::make_shared<GraspPlanner>(node, visual_tools_);
+
+  ik_worker_pool_ = num_threads > 0 ? std::make_shared<IkWorkerPool>(static_cast<std::size_t>(num_threads)) :
+                                      grasp_filter_->getIkWorkerPool();
+  grasp_filter_->setIkWorkerPool(ik_worker_pool_);
+  grasp_planner_->setIkWorkerPool(ik_worker_pool_);
+
+  // Create the solvers now instead of during the first request
+  if (!ik_worker_pool_->loadSolvers(arm_jmg))
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Failed to load the IK solvers of " << planning_group_name_ << ", not serving grasps");
+    return false;
+  }
+
+  grasp_pipeline_ = std::make_shared<GraspPipeline>(grasp_generator_, grasp_filter_, grasp_planner_);
+
+  // Precomputed grasps of known objects, the file is mapped so loading it is cheap
+  if (!grasp_database_file.empty())
+  {
+    grasp_database_ = std::make_shared<GraspDatabase>();
+    if (!grasp_database_->loadFromFile(grasp_database_file))
+    {
+      RCLCPP_ERROR_STREAM(LOGGER, "Failed to load grasp database " << grasp_database_file << ", not serving grasps");
+      return false;
+    }
+    database_grasp_generator_ = std::make_shared<DatabaseGraspGenerator>(node, visual_tools_, grasp_database_);
+    database_grasp_pipeline_ =
+        std::make_shared<GraspPipeline>(database_grasp_generator_, grasp_filter_, grasp_planner_);
+  }
+  initialized_ = true;
+
+  grasp_planning_service_ = create_service<moveit_msgs::srv::GraspPlanning>(
+      "plan_grasps", [this](const std::shared_ptr<moveit_msgs::srv::GraspPlanning::Request> request,
+                            std::shared_ptr<moveit_msgs::srv::GraspPlanning::Response> response) {
+        planGrasps(*request, *response);
+      });
+
+  RCLCPP_INFO_STREAM(LOGGER,
+                     "Serving grasps of " << ee_group_name_ << " on " << grasp_planning_service_->get_service_name());
+  return true;
+}
+
+void GraspPlanningServer::planGrasps(const moveit_msgs::srv::GraspPlanning::Request& request,
+                                     moveit_msgs::srv::GraspPlanning::Response& response)
+{
+  std::lock_guard<std::mutex> request_lock(request_mutex_);
+  response.grasps.clear();
+  if (!initialized_)
+  {
+    RCLCPP_ERROR(LOGGER, "Grasp planning server is not initialized");
+    response.error_code.val = moveit_msgs::msg::MoveItErrorCodes::FAILURE;
+    return;
+  }
+
+  const std::string& group_name = request.group_name.empty() ? planning_group_name_ : request.group_name;
+  const moveit::core::JointModelGroup* arm_jmg =
+      planning_scene_monitor_->getRobotModel()->getJointModelGroup(group_name);
+  if (!arm_jmg)
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Unknown planning group " << group_name);
+    response.error_code.val = moveit_msgs::msg::MoveItErrorCodes::INVALID_GROUP_NAME;
+    return;
+  }
+
+  // Snapshot of the scene, the filter and the planner read it while the monitor keeps updating
+  planning_scene::PlanningScenePtr planning_scene;
+  {
+    planning_scene_monitor::LockedPlanningSceneRO scene(planning_scene_monitor_);
+    planning_scene = planning_scene::PlanningScene::clone(scene);
+  }
+  if (!request.target.id.empty() && !planning_scene->getWorld()->hasObject(request.target.id))
+  {
+    moveit_msgs::msg::CollisionObject target = request.target;
+    target.operation = moveit_msgs::msg::CollisionObject::ADD;
+    planning_scene->processCollisionObjectMsg(target);
+  }
+
+  std::vector<GraspCandidatePtr> grasp_candidates;
+  response.error_code.val = planTargetGrasps(request, planning_scene, arm_jmg, grasp_candidates);
+
+  response.grasps.reserve(grasp_candidates.size());
+  for (const GraspCandidatePtr& grasp_candidate : grasp_candidates)
+    response.grasps.push_back(grasp_candidate->grasp_);
+
+  RCLCPP_INFO_STREAM(LOGGER, "Planned " << response.grasps.size() << " grasps for " << request.target.id);
+}
+
+int GraspPlanningServer::planTargetGrasps(const moveit_msgs::srv::GraspPlanning::Request& request,
+                                          const planning_scene::PlanningScenePtr& planning_scene,
+                                          const moveit::core::JointModelGroup* arm_jmg,
+                                          std::vector<GraspCandidatePtr>& grasp_candidates)
+{
+  Eigen::Isometry3d cuboid_pose;
+  double depth;
+  double width;
+  double height;
+  const bool is_cuboid = getTargetCuboid(request.target, *planning_scene, cuboid_pose, depth, width, height);
+  if (!is_cuboid && request.candidate_grasps.empty())
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Can only generate grasps for a box, target " << request.target.id << " is not one");
+    return moveit_msgs::msg::MoveItErrorCodes::INVALID_OBJECT_NAME;
+  }
+
+  const moveit::core::RobotStatePtr seed_state =
+      std::make_shared<moveit::core::RobotState>(planning_scene->getCurrentState());
+
+  // Generate the grasps chunk by chunk, best first, and stop once enough have a path
+  if (request.candidate_grasps.empty())
+  {
+    GraspPipelineRequest pipeline_request;
+    pipeline_request.cuboid_pose_ = cuboid_pose;
+    pipeline_request.depth_ = depth;
+    pipeline_request.width_ = width;
+    pipeline_request.height_ = height;
+    pipeline_request.grasp_data_ = grasp_data_;
+    pipeline_request.planning_scene_ = planning_scene;
+    pipeline_request.arm_jmg_ = arm_jmg;
+    pipeline_request.seed_state_ = seed_state;
+    pipeline_request.grasp_object_id_ = request.target.id;
+    pipeline_request.max_planned_grasps_ = max_planned_grasps_;
+    if (timeout_ > 0)
+    {
+      pipeline_request.deadline_ = std::chrono::steady_clock::now() +
+                                   std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                       std::chrono::duration<double>(timeout_));
+    }
+
+    // Known objects are looked up by their id
+    GraspPipelinePtr grasp_pipeline = grasp_pipeline_;
+    if (grasp_database_ && grasp_database_->findObject(request.target.id))
+    {
+      database_grasp_generator_->setObjectName(request.target.id);
+      grasp_pipeline = database_grasp_pipeline_;
+    }
+
+    GraspPipelineResult result = grasp_pipeline->plan(pipeline_request);
+    grasp_candidates = std::move(result.grasp_candidates_);
+    if (!grasp_candidates.empty())
+      return moveit_msgs::msg::MoveItErrorCodes::SUCCESS;
+    if (result.status_ == GraspPipelineResult::DEADLINE_REACHED)
+      return moveit_msgs::msg::MoveItErrorCodes::TIMED_OUT;
+    return moveit_msgs::msg::MoveItErrorCodes::PLANNING_FAILED;
+  }
+
+  // Filter and plan the grasps of the client
+  if (!is_cuboid)
+    cuboid_pose = Eigen::Isometry3d::Identity();
+  grasp_candidates.reserve(request.candidate_grasps.size());
+  for (const moveit_msgs::msg::Grasp& grasp : request.candidate_grasps)
+    grasp_candidates.push_back(std::make_shared<GraspCandidate>(grasp, grasp_data_, cuboid_pose));
+
+  const bool filter_pregrasp = true;
+  if (!grasp_filter_->filterGrasps(grasp_candidates, planning_scene, arm_jmg, seed_state, filter_pregrasp,
+                                   request.target.id) ||
+      !grasp_filter_->removeInvalidAndFilter(grasp_candidates))
+  {
+    grasp_candidates.clear();
+    return moveit_msgs::msg::MoveItErrorCodes::NO_IK_SOLUTION;
+  }
+  if (!grasp_planner_->planAllApproachLiftRetreat(grasp_candidates, seed_state, planning_scene, request.target.id))
+  {
+    grasp_candidates.clear();
+    return moveit_msgs::msg::MoveItErrorCodes::PLANNING_FAILED;
+  }
+  if (max_planned_grasps_ > 0 && grasp_candidates.size() > max_planned_grasps_)
+    grasp_candidates.resize(max_planned_grasps_);
+  return moveit_msgs::msg::MoveItErrorCodes::SUCCESS;
+}
+
+bool GraspPlanningServer::getTargetCuboid(const moveit_msgs::msg::CollisionObject& target,
+                                          const planning_scene::PlanningScene& planning_scene,
+                                          Eigen::Isometry3d& cuboid_pose, double& depth, double& width,
+                                          double& height) const
+{
+  if (target.primitives.empty() || target.primitive_poses.empty() ||
+      target.primitives[0].type != shape_msgs::msg::SolidPrimitive::BOX ||
+      target.primitives[0].dimensions.size() < 3)
+  {
+    return false;
+  }
+
+  // Poses of the message are relative to its frame, the grasps are generated in the planning frame
+  cuboid_pose = visual_tools_->convertPose(target.pose) * visual_tools_->convertPose(target.primitive_poses[0]);
+  if (!target.header.frame_id.empty())
+    cuboid_pose = planning_scene.getFrameTransform(target.header.frame_id) * cuboid_pose;
+
+  depth = target.primitives[0].dimensions[shape_msgs::msg::SolidPrimitive::BOX_X];
+  width = target.primitives[0].dimensions[shape_msgs::msg::SolidPrimitive::BOX_Y];
+  height = target.primitives[0].dimensions[shape_msgs::msg::SolidPrimitive::BOX_Z];
+  return true;
+}
+
+}  // namespace moveit_grasps
+
+RCLCPP_COMPONENTS_REGISTER_NODE(moveit_grasps::GraspPlanningServer)
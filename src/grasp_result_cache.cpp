@@ -0,0 +1,132 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Cache of validated grasp candidates for objects that are seen repeatedly in nearly the same pose
+*/
+
+#include <moveit_grasps/grasp_result_cache.h>
+
+// C++
+#include <algorithm>
+#include <cmath>
+
+namespace moveit_grasps
+{
+GraspResultCache::GraspResultCache(double position_resolution, double orientation_resolution,
+                                   std::size_t max_entries)
+  : LOGGER(rclcpp::get_logger("grasp_result_cache"))
+  , position_resolution_(position_resolution)
+  , orientation_resolution_(orientation_resolution)
+  , max_entries_(max_entries)
+  , hits_(0)
+  , misses_(0)
+{
+}
+
+GraspResultCacheKey GraspResultCache::getKey(const Eigen::Isometry3d& cuboid_pose, double depth, double width,
+                                             double height, const GraspDataPtr& grasp_data,
+                                             std::uint64_t scene_revision) const
+{
+  // q and -q are the same rotation, keep w positive so both produce the same key
+  Eigen::Quaterniond orientation(cuboid_pose.rotation());
+  if (orientation.w() < 0)
+    orientation.coeffs() *= -1.0;
+
+  GraspResultCacheKey key;
+  key.quantized_object_ = { quantize(depth, position_resolution_),
+                            quantize(width, position_resolution_),
+                            quantize(height, position_resolution_),
+                            quantize(cuboid_pose.translation().x(), position_resolution_),
+                            quantize(cuboid_pose.translation().y(), position_resolution_),
+                            quantize(cuboid_pose.translation().z(), position_resolution_),
+                            quantize(orientation.x(), orientation_resolution_),
+                            quantize(orientation.y(), orientation_resolution_),
+                            quantize(orientation.z(), orientation_resolution_),
+                            quantize(orientation.w(), orientation_resolution_) };
+  key.end_effector_name_ = grasp_data->ee_jmg_->getName();
+  key.scene_revision_ = scene_revision;
+  return key;
+}
+
+bool GraspResultCache::lookup(const GraspResultCacheKey& key, std::vector<GraspCandidatePtr>& grasp_candidates)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto entry_it = entries_.find(key);
+  if (entry_it == entries_.end())
+  {
+    ++misses_;
+    return false;
+  }
+
+  ++hits_;
+  grasp_candidates = entry_it->second;
+  RCLCPP_DEBUG_STREAM(LOGGER, "Cache hit with " << grasp_candidates.size() << " grasp candidates");
+  return true;
+}
+
+void GraspResultCache::insert(const GraspResultCacheKey& key, const std::vector<GraspCandidatePtr>& grasp_candidates)
+{
+  std::vector<GraspCandidatePtr> valid_candidates;
+  valid_candidates.reserve(grasp_candidates.size());
+  std::copy_if(grasp_candidates.begin(), grasp_candidates.end(), std::back_inserter(valid_candidates),
+               [](const GraspCandidatePtr& grasp_candidate) { return grasp_candidate->isValid(); });
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (entries_.find(key) == entries_.end())
+    insertion_order_.push_back(key);
+  entries_[key] = std::move(valid_candidates);
+
+  while (entries_.size() > max_entries_ && !insertion_order_.empty())
+  {
+    entries_.erase(insertion_order_.front());
+    insertion_order_.pop_front();
+  }
+}
+
+void GraspResultCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  insertion_order_.clear();
+  hits_ = 0;
+  misses_ = 0;
+}
+
+std::size_t GraspResultCache::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+}  // namespace moveit_grasps
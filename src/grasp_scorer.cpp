@@ -73,6 +73,18 @@ double GraspScoreWeights::computeScore(const Eigen::Vector3d& orientation_scores
   return total_score;
 }
 
+void GraspScoreWeights::computeScores(const Eigen::Matrix3Xd& orientation_scores,
+                                      const Eigen::Matrix3Xd& translation_scores, Eigen::VectorXd& scores) const
+{
+  const Eigen::Vector3d orientation_weights(orientation_x_score_weight_, orientation_y_score_weight_,
+                                            orientation_z_score_weight_);
+  const Eigen::Vector3d translation_weights(translation_x_score_weight_, translation_y_score_weight_,
+                                            translation_z_score_weight_);
+
+  scores = orientation_scores.transpose() * orientation_weights + translation_scores.transpose() * translation_weights;
+  scores /= getWeightTotal();
+}
+
 double GraspScoreWeights::getWeightTotal() const
 {
   return orientation_x_score_weight_ + orientation_y_score_weight_ + orientation_z_score_weight_ +
@@ -115,6 +127,34 @@ Eigen::Vector3d GraspScorer::scoreRotationsFromDesired(const Eigen::Isometry3d&
   return scores;
 }
 
+void GraspScorer::scoreRotationsFromDesired(const EigenSTL::vector_Isometry3d& grasp_poses_tcp,
+                                            const Eigen::Isometry3d& ideal_pose, Eigen::Matrix3Xd& scores)
+{
+  // The cosine of the angle between two axes is the dot product of the matching rotation matrix columns
+  const Eigen::Matrix3d ideal_rotation = ideal_pose.rotation();
+  scores.resize(3, grasp_poses_tcp.size());
+  for (std::size_t i = 0; i < grasp_poses_tcp.size(); ++i)
+    scores.col(i) = grasp_poses_tcp[i].linear().cwiseProduct(ideal_rotation).colwise().sum().transpose();
+
+  scores = (M_PI - scores.array().max(-1.0).min(1.0).acos()) / M_PI;
+}
+
+void GraspScorer::scoreGraspTranslation(const EigenSTL::vector_Isometry3d& grasp_poses_tcp,
+                                        const Eigen::Vector3d& min_translations,
+                                        const Eigen::Vector3d& max_translations, Eigen::Matrix3Xd& scores)
+{
+  // We assume that the ideal is in the middle, axes with no range score 0
+  const Eigen::Array3d ideal = (max_translations + min_translations) / 2;
+  const Eigen::Array3d range = max_translations - min_translations;
+  const Eigen::Array3d inverse_range = (range == 0).select(Eigen::Array3d::Zero(), range.inverse());
+
+  scores.resize(3, grasp_poses_tcp.size());
+  for (std::size_t i = 0; i < grasp_poses_tcp.size(); ++i)
+    scores.col(i) = (grasp_poses_tcp[i].translation().array() - ideal) * inverse_range;
+
+  scores = scores.array().square();
+}
+
 Eigen::Vector3d GraspScorer::scoreGraspTranslation(const Eigen::Isometry3d& grasp_pose_tcp,
                                                    const Eigen::Isometry3d& ideal_pose)
 {
@@ -0,0 +1,134 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Timers and counters of the grasp generation, filtering and planning stages
+*/
+
+#include <moveit_grasps/grasp_stats.h>
+
+// C++
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace moveit_grasps
+{
+void GraspStats::merge(const GraspStats& other)
+{
+  for (std::size_t stage = 0; stage < NUM_GRASP_STAGES; ++stage)
+  {
+    stage_durations_[stage] += other.stage_durations_[stage];
+    stage_counts_[stage] += other.stage_counts_[stage];
+  }
+  ik_solved_ += other.ik_solved_;
+  ik_failed_ += other.ik_failed_;
+  ik_timed_out_ += other.ik_timed_out_;
+
+  if (thread_busy_durations_.size() < other.thread_busy_durations_.size())
+    thread_busy_durations_.resize(other.thread_busy_durations_.size(), 0);
+  for (std::size_t thread_id = 0; thread_id < other.thread_busy_durations_.size(); ++thread_id)
+    thread_busy_durations_[thread_id] += other.thread_busy_durations_[thread_id];
+  parallel_duration_ += other.parallel_duration_;
+  duration_ += other.duration_;
+}
+
+void GraspStats::clear()
+{
+  *this = GraspStats();
+}
+
+double GraspStats::getThreadUtilization(std::size_t thread_id) const
+{
+  if (thread_id >= thread_busy_durations_.size() || parallel_duration_ <= 0)
+    return 0;
+  return thread_busy_durations_[thread_id] / parallel_duration_;
+}
+
+std::string GraspStats::toString() const
+{
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(4);
+  ss << "Stage                      Duration      Count\n";
+  for (std::size_t stage = 0; stage < NUM_GRASP_STAGES; ++stage)
+  {
+    ss << std::left << std::setw(25) << getStageName(static_cast<GraspStage>(stage)) << std::right << std::setw(10)
+       << stage_durations_[stage] << std::setw(11) << stage_counts_[stage] << "\n";
+  }
+  ss << "IK solved / failed / timed out: " << ik_solved_ << " / " << ik_failed_ << " / " << ik_timed_out_ << "\n";
+  for (std::size_t thread_id = 0; thread_id < thread_busy_durations_.size(); ++thread_id)
+  {
+    ss << "Thread " << thread_id << " busy " << thread_busy_durations_[thread_id] << "s, utilization "
+       << std::setprecision(1) << 100 * getThreadUtilization(thread_id) << "%" << std::setprecision(4) << "\n";
+  }
+  if (duration_ > 0)
+    ss << "Total duration: " << duration_ << "s\n";
+  return ss.str();
+}
+
+const char* GraspStats::getStageName(GraspStage stage)
+{
+  switch (stage)
+  {
+    case GENERATION:
+      return "generation";
+    case SCORING:
+      return "scoring";
+    case CUTTING_PLANE_ORIENTATION:
+      return "cutting_plane_orientation";
+    case GRASP_IK:
+      return "grasp_ik";
+    case PREGRASP_IK:
+      return "pregrasp_ik";
+    case CLOSED_FINGER_CHECK:
+      return "closed_finger_check";
+    case CARTESIAN_PLANNING:
+      return "cartesian_planning";
+    default:
+      return "unknown";
+  }
+}
+
+GraspStatsPublisher::GraspStatsPublisher(const rclcpp::Node::SharedPtr& node, const std::string& topic)
+  : publisher_(node->create_publisher<std_msgs::msg::String>(topic, 10))
+{
+}
+
+void GraspStatsPublisher::publish(const GraspStats& stats) const
+{
+  std_msgs::msg::String msg;
+  msg.data = stats.toString();
+  publisher_->publish(msg);
+}
+
+}  // namespace moveit_grasps
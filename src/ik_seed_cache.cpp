@@ -0,0 +1,140 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Thread safe cache of solved IK poses, used to seed IK for nearby grasp candidates
+*/
+
+#include <moveit_grasps/ik_seed_cache.h>
+
+// C++
+#include <cmath>
+#include <limits>
+
+namespace moveit_grasps
+{
+IkSeedCache::IkSeedCache(double max_translation, double max_rotation)
+  : max_translation_(max_translation), max_rotation_(max_rotation)
+{
+}
+
+void IkSeedCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  cells_.clear();
+  size_ = 0;
+}
+
+void IkSeedCache::insert(const Eigen::Isometry3d& pose, const std::vector<double>& solution)
+{
+  Entry entry;
+  entry.position_ = pose.translation();
+  entry.orientation_ = Eigen::Quaterniond(pose.rotation());
+  entry.solution_ = solution;
+
+  const std::int64_t key = getCellKey(getCell(entry.position_));
+  std::lock_guard<std::mutex> lock(mutex_);
+  cells_[key].push_back(entry);
+  ++size_;
+}
+
+bool IkSeedCache::findNearest(const Eigen::Isometry3d& pose, std::vector<double>& seed) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  const Entry* entry = findNearestEntry(pose);
+  if (!entry)
+    return false;
+  seed = entry->solution_;
+  return true;
+}
+
+bool IkSeedCache::contains(const Eigen::Isometry3d& pose) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return findNearestEntry(pose) != nullptr;
+}
+
+const IkSeedCache::Entry* IkSeedCache::findNearestEntry(const Eigen::Isometry3d& pose) const
+{
+  const Eigen::Vector3d position = pose.translation();
+  const Eigen::Quaterniond orientation(pose.rotation());
+  const Eigen::Vector3i cell = getCell(position);
+
+  const Entry* best_entry = nullptr;
+  double best_distance = std::numeric_limits<double>::max();
+  for (int dx = -1; dx <= 1; ++dx)
+    for (int dy = -1; dy <= 1; ++dy)
+      for (int dz = -1; dz <= 1; ++dz)
+      {
+        auto cell_it = cells_.find(getCellKey(cell + Eigen::Vector3i(dx, dy, dz)));
+        if (cell_it == cells_.end())
+          continue;
+
+        for (const Entry& entry : cell_it->second)
+        {
+          const double translation = (entry.position_ - position).norm();
+          const double rotation = entry.orientation_.angularDistance(orientation);
+          if (translation > max_translation_ || rotation > max_rotation_)
+            continue;
+
+          // Normalize by the limits so that translation and rotation contribute equally
+          const double distance = translation / max_translation_ + rotation / max_rotation_;
+          if (distance < best_distance)
+          {
+            best_distance = distance;
+            best_entry = &entry;
+          }
+        }
+      }
+  return best_entry;
+}
+
+std::size_t IkSeedCache::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+Eigen::Vector3i IkSeedCache::getCell(const Eigen::Vector3d& position) const
+{
+  return (position / max_translation_).array().floor().cast<int>();
+}
+
+std::int64_t IkSeedCache::getCellKey(const Eigen::Vector3i& cell) const
+{
+  // 21 bits per axis is plenty for workspaces of a few hundred meters at centimeter resolution
+  const std::int64_t mask = (1 << 21) - 1;
+  return ((cell.x() & mask) << 42) | ((cell.y() & mask) << 21) | (cell.z() & mask);
+}
+
+}  // namespace moveit_grasps
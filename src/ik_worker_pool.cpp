@@ -0,0 +1,108 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Long-lived pool of IK workers, each with its own kinematic solvers and robot state
+*/
+
+#include <moveit_grasps/ik_worker_pool.h>
+
+// C++
+#include <omp.h>
+
+namespace moveit_grasps
+{
+IkWorkerPool::IkWorkerPool(std::size_t num_workers)
+  : LOGGER(rclcpp::get_logger("ik_worker_pool"))
+  , num_workers_(num_workers ? num_workers : static_cast<std::size_t>(omp_get_max_threads()))
+{
+  robot_states_.resize(num_workers_);
+}
+
+bool IkWorkerPool::loadSolvers(const moveit::core::JointModelGroup* arm_jmg)
+{
+  const Lease lease = acquire();
+  std::vector<kinematics::KinematicsBaseConstPtr>& solvers = kin_solvers_[arm_jmg->getName()];
+  if (solvers.size() == num_workers_)
+    return true;
+
+  solvers.clear();
+  for (std::size_t worker_id = 0; worker_id < num_workers_; ++worker_id)
+  {
+    solvers.push_back(arm_jmg->getSolverInstance());
+
+    // Test to make sure we have a valid kinematics solver
+    if (!solvers.back())
+    {
+      RCLCPP_ERROR_STREAM(LOGGER, "No kinematic solver found for " << arm_jmg->getName());
+      solvers.clear();
+      return false;
+    }
+  }
+  RCLCPP_DEBUG_STREAM(LOGGER, "Loaded " << num_workers_ << " kinematic solvers for " << arm_jmg->getName());
+  return true;
+}
+
+const kinematics::KinematicsBaseConstPtr& IkWorkerPool::getSolver(std::size_t worker_id,
+                                                                   const moveit::core::JointModelGroup* arm_jmg) const
+{
+  return kin_solvers_.at(arm_jmg->getName())[worker_id];
+}
+
+void IkWorkerPool::setRobotStates(const moveit::core::RobotState& robot_state, std::size_t num_workers)
+{
+  const Lease lease = acquire();
+  for (std::size_t worker_id = 0; worker_id < std::min(num_workers, num_workers_); ++worker_id)
+  {
+    moveit::core::RobotStatePtr& state = robot_states_[worker_id];
+    if (state)
+      *state = robot_state;
+    else
+      state = std::make_shared<moveit::core::RobotState>(robot_state);
+  }
+}
+
+void IkWorkerPool::run(std::size_t num_tasks, std::size_t num_workers,
+                       const std::function<void(std::size_t worker_id, std::size_t task_id)>& function)
+{
+  const Lease lease = acquire();
+
+  const int num_threads = static_cast<int>(std::max<std::size_t>(1, std::min(num_workers, num_workers_)));
+
+  // Tasks are handed out one at a time so that slow tasks do not hold back a whole chunk
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads)
+  for (std::size_t task_id = 0; task_id < num_tasks; ++task_id)
+    function(static_cast<std::size_t>(omp_get_thread_num()), task_id);
+}
+
+}  // namespace moveit_grasps
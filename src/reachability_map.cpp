@@ -0,0 +1,236 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Precomputed map of the positions an arm can reach, used to reject grasps before running IK
+*/
+
+#include <moveit_grasps/reachability_map.h>
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+namespace moveit_grasps
+{
+namespace
+{
+const char MAGIC[4] = { 'M', 'G', 'R', 'M' };
+const std::uint32_t VERSION = 1;
+
+void writeString(std::ofstream& out, const std::string& value)
+{
+  const std::uint32_t length = value.size();
+  out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+  out.write(value.data(), length);
+}
+
+bool readString(std::ifstream& in, std::string& value)
+{
+  std::uint32_t length = 0;
+  if (!in.read(reinterpret_cast<char*>(&length), sizeof(length)) || length > 4096)
+    return false;
+  value.resize(length);
+  return static_cast<bool>(in.read(&value[0], length));
+}
+}  // namespace
+
+ReachabilityMap::ReachabilityMap()
+  : LOGGER(rclcpp::get_logger("reachability_map"))
+  , resolution_(0.0)
+  , origin_(Eigen::Vector3d::Zero())
+  , size_(Eigen::Vector3i::Zero())
+{
+}
+
+bool ReachabilityMap::buildFromSamples(moveit::core::RobotState& robot_state,
+                                       const moveit::core::JointModelGroup* arm_jmg, const std::string& tip_link,
+                                       const std::string& ik_frame, double resolution, std::size_t num_samples)
+{
+  if (resolution <= 0.0 || num_samples == 0)
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Invalid resolution " << resolution << " or number of samples " << num_samples);
+    return false;
+  }
+
+  const moveit::core::LinkModel* tip_lm = robot_state.getRobotModel()->getLinkModel(tip_link);
+  const moveit::core::LinkModel* ik_frame_lm = robot_state.getRobotModel()->getLinkModel(
+      (!ik_frame.empty() && ik_frame[0] == '/') ? ik_frame.substr(1) : ik_frame);
+  if (!tip_lm || !ik_frame_lm)
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Unable to find tip link " << tip_link << " or ik frame " << ik_frame);
+    return false;
+  }
+
+  // Sample the positions of the tip link in the ik frame
+  EigenSTL::vector_Vector3d positions;
+  positions.reserve(num_samples);
+  Eigen::Vector3d min_position = Eigen::Vector3d::Constant(std::numeric_limits<double>::max());
+  Eigen::Vector3d max_position = Eigen::Vector3d::Constant(std::numeric_limits<double>::lowest());
+  for (std::size_t i = 0; i < num_samples; ++i)
+  {
+    robot_state.setToRandomPositions(arm_jmg);
+    robot_state.update();
+    positions.push_back(robot_state.getGlobalLinkTransform(ik_frame_lm).inverse() *
+                        robot_state.getGlobalLinkTransform(tip_lm).translation());
+    min_position = min_position.cwiseMin(positions.back());
+    max_position = max_position.cwiseMax(positions.back());
+  }
+
+  // Leave one voxel of padding on each side for the dilation below
+  group_name_ = arm_jmg->getName();
+  ik_frame_ = ik_frame;
+  resolution_ = resolution;
+  origin_ = min_position - Eigen::Vector3d::Constant(resolution_);
+  for (std::size_t axis = 0; axis < 3; ++axis)
+    size_[axis] = static_cast<int>(std::ceil((max_position[axis] - origin_[axis]) / resolution_)) + 2;
+
+  std::vector<std::uint8_t> sampled(static_cast<std::size_t>(size_.prod()), 0);
+  for (const Eigen::Vector3d& position : positions)
+  {
+    const Eigen::Vector3i voxel = ((position - origin_) / resolution_).array().floor().cast<int>();
+    sampled[getIndex(voxel.x(), voxel.y(), voxel.z())] = 1;
+  }
+
+  // Dilate by one voxel so that gaps between samples are not reported as unreachable
+  voxels_.assign(sampled.size(), 0);
+  for (int z = 1; z < size_.z() - 1; ++z)
+    for (int y = 1; y < size_.y() - 1; ++y)
+      for (int x = 1; x < size_.x() - 1; ++x)
+      {
+        if (!sampled[getIndex(x, y, z)])
+          continue;
+        for (int dz = -1; dz <= 1; ++dz)
+          for (int dy = -1; dy <= 1; ++dy)
+            for (int dx = -1; dx <= 1; ++dx)
+              voxels_[getIndex(x + dx, y + dy, z + dz)] = 1;
+      }
+
+  RCLCPP_INFO_STREAM(LOGGER, "Built reachability map for " << group_name_ << " with " << size_.x() << "x"
+                                                           << size_.y() << "x" << size_.z() << " voxels from "
+                                                           << num_samples << " samples");
+  return true;
+}
+
+bool ReachabilityMap::saveToFile(const std::string& filename) const
+{
+  std::ofstream out(filename, std::ios::binary);
+  if (!out)
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Unable to open " << filename << " for writing");
+    return false;
+  }
+
+  out.write(MAGIC, sizeof(MAGIC));
+  out.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+  writeString(out, group_name_);
+  writeString(out, ik_frame_);
+  out.write(reinterpret_cast<const char*>(&resolution_), sizeof(resolution_));
+  out.write(reinterpret_cast<const char*>(origin_.data()), 3 * sizeof(double));
+  out.write(reinterpret_cast<const char*>(size_.data()), 3 * sizeof(int));
+  out.write(reinterpret_cast<const char*>(voxels_.data()), voxels_.size());
+
+  if (!out)
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Failed writing reachability map to " << filename);
+    return false;
+  }
+  return true;
+}
+
+bool ReachabilityMap::loadFromFile(const std::string& filename)
+{
+  std::ifstream in(filename, std::ios::binary);
+  if (!in)
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Unable to open reachability map " << filename);
+    return false;
+  }
+
+  char magic[4];
+  std::uint32_t version = 0;
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char*>(&version), sizeof(version));
+  if (!in || !std::equal(magic, magic + sizeof(magic), MAGIC) || version != VERSION)
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, filename << " is not a reachability map of version " << VERSION);
+    return false;
+  }
+
+  std::string group_name;
+  std::string ik_frame;
+  double resolution;
+  Eigen::Vector3d origin;
+  Eigen::Vector3i size;
+  if (!readString(in, group_name) || !readString(in, ik_frame) ||
+      !in.read(reinterpret_cast<char*>(&resolution), sizeof(resolution)) ||
+      !in.read(reinterpret_cast<char*>(origin.data()), 3 * sizeof(double)) ||
+      !in.read(reinterpret_cast<char*>(size.data()), 3 * sizeof(int)) || resolution <= 0.0 || (size.array() <= 0).any())
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Corrupt header in reachability map " << filename);
+    return false;
+  }
+
+  std::vector<std::uint8_t> voxels(static_cast<std::size_t>(size.prod()));
+  if (!in.read(reinterpret_cast<char*>(voxels.data()), voxels.size()))
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Reachability map " << filename << " is truncated");
+    return false;
+  }
+
+  group_name_ = group_name;
+  ik_frame_ = ik_frame;
+  resolution_ = resolution;
+  origin_ = origin;
+  size_ = size;
+  voxels_.swap(voxels);
+
+  RCLCPP_INFO_STREAM(LOGGER, "Loaded reachability map for " << group_name_ << " in frame " << ik_frame_);
+  return true;
+}
+
+bool ReachabilityMap::isReachable(const Eigen::Vector3d& position) const
+{
+  // An empty map does not reject anything
+  if (voxels_.empty())
+    return true;
+
+  const Eigen::Vector3d voxel = ((position - origin_) / resolution_).array().floor();
+  if ((voxel.array() < 0.0).any() || (voxel.array() >= size_.cast<double>().array()).any())
+    return false;
+  return voxels_[getIndex(static_cast<int>(voxel.x()), static_cast<int>(voxel.y()), static_cast<int>(voxel.z()))];
+}
+
+}  // namespace moveit_grasps
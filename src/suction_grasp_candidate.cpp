@@ -40,9 +40,10 @@
 
 namespace moveit_grasps
 {
-SuctionGraspCandidate::SuctionGraspCandidate(const moveit_msgs::Grasp& grasp, const SuctionGraspDataPtr& grasp_data,
+SuctionGraspCandidate::SuctionGraspCandidate(const moveit_msgs::msg::Grasp& grasp,
+                                             const SuctionGraspDataPtr& grasp_data,
                                              const Eigen::Isometry3d& cuboid_pose)
-  : GraspCandidate::GraspCandidate(grasp, std::dynamic_pointer_cast<GraspData>(grasp_data), cuboid_pose)
+  : GraspCandidate(grasp, std::dynamic_pointer_cast<GraspData>(grasp_data), cuboid_pose)
   , suction_voxel_overlap_(grasp_data->suction_voxel_matrix_->getNumVoxels())
 {
 }
@@ -42,7 +42,7 @@
 // Eigen
 #include <Eigen/Core>
 #include <Eigen/Geometry>
-#include <eigen_conversions/eigen_msg.h>
+#include <tf2_eigen/tf2_eigen.h>
 
 // C++
 #include <cmath>
@@ -55,19 +55,22 @@
 
 namespace moveit_grasps
 {
-const std::string LOGNAME = "grasp_data.suction_gripper";
+namespace
+{
+const rclcpp::Logger LOGGER = rclcpp::get_logger("grasp_data.suction_gripper");
+}  // namespace
 
-SuctionGraspData::SuctionGraspData(const ros::NodeHandle& nh, const std::string& end_effector,
+SuctionGraspData::SuctionGraspData(const rclcpp::Node::SharedPtr nh, const std::string& end_effector,
                                    const moveit::core::RobotModelConstPtr& robot_model)
   : GraspData(nh, end_effector, robot_model)
 {
 }
 
-bool SuctionGraspData::loadGraspData(const ros::NodeHandle& nh, const std::string& end_effector)
+bool SuctionGraspData::loadGraspData(const rclcpp::Node::SharedPtr nh, const std::string& end_effector)
 {
   if (!GraspData::loadGraspData(nh, end_effector))
   {
-    ROS_ERROR_STREAM_NAMED(LOGNAME, "GraspData::loadGraspData failed");
+    RCLCPP_ERROR_STREAM(LOGGER, "GraspData::loadGraspData failed");
     return false;
   }
   // Overwrite postures since they are not used with suction grippers
@@ -80,21 +83,18 @@ bool SuctionGraspData::loadGraspData(const ros::NodeHandle& nh, const std::strin
   grasp_posture_.points[0].positions = {};
 
   // Load all other parameters
-  const std::string parent_name = "grasp_data";  // for namespacing logging messages
   std::size_t error = 0;
 
-  // Search within the sub-namespace of this end effector name
-  ros::NodeHandle child_nh(nh, end_effector);
-
   int suction_rows_count, suction_cols_count;
   double active_suction_range_x, active_suction_range_y;
-  error += !rosparam_shortcuts::get(parent_name, child_nh, "active_suction_range_x", active_suction_range_x);
-  error += !rosparam_shortcuts::get(parent_name, child_nh, "active_suction_range_y", active_suction_range_y);
-  child_nh.param<int>("suction_rows_count", suction_rows_count, 1);
-  child_nh.param<int>("suction_cols_count", suction_cols_count, 1);
+  error += !rosparam_shortcuts::get(nh, end_effector + ".active_suction_range_x", active_suction_range_x);
+  error += !rosparam_shortcuts::get(nh, end_effector + ".active_suction_range_y", active_suction_range_y);
+  nh->get_parameter_or<int>(end_effector + ".suction_rows_count", suction_rows_count, 1);
+  nh->get_parameter_or<int>(end_effector + ".suction_cols_count", suction_cols_count, 1);
+  rosparam_shortcuts::shutdownIfError(error);
+
   suction_voxel_matrix_ = std::make_shared<SuctionVoxelMatrix>(suction_rows_count, suction_cols_count,
                                                                active_suction_range_y, active_suction_range_x);
-  rosparam_shortcuts::shutdownIfError(parent_name, error);
 
   return true;
 }
@@ -104,8 +104,10 @@ void SuctionGraspData::print()
   GraspData::print();
 
   std::cout << "Suction Gripper Parameters: " << std::endl;
-  std::cout << "\tactive_suction_range_x_: " << suction_voxel_matrix_->getActiveSuctionWidthY() << std::endl;
-  std::cout << "\tactive_suction_range_y_: " << suction_voxel_matrix_->getActiveSuctionWidthX() << std::endl;
+  std::cout << "\tactive_suction_range_x_: " << suction_voxel_matrix_->getActiveSuctionWidthX() << std::endl;
+  std::cout << "\tactive_suction_range_y_: " << suction_voxel_matrix_->getActiveSuctionWidthY() << std::endl;
+  std::cout << "\tsuction_rows_count: " << suction_voxel_matrix_->getNumRows() << std::endl;
+  std::cout << "\tsuction_cols_count: " << suction_voxel_matrix_->getNumCols() << std::endl;
 }
 
 }  // namespace moveit_grasps
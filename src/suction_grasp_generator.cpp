@@ -40,43 +40,54 @@
 #include <moveit_grasps/suction_grasp_candidate.h>
 #include <moveit_grasps/grasp_filter.h>
 
+#include <chrono>
+
 #include <rosparam_shortcuts/rosparam_shortcuts.h>
+#include <tf2_eigen/tf2_eigen.h>
+
+namespace
+{
+const rclcpp::Logger LOGGER = rclcpp::get_logger("grasp_generator");
+const rclcpp::Logger LOGGER_RANGE = rclcpp::get_logger("grasp_generator.suction.range");
+const rclcpp::Logger LOGGER_GENERATE = rclcpp::get_logger("grasp_generator.generate_suction_grasps");
+}  // namespace
 
 namespace moveit_grasps
 {
 // Constructor
-SuctionGraspGenerator::SuctionGraspGenerator(const moveit_visual_tools::MoveItVisualToolsPtr& visual_tools, bool verbose)
-  : GraspGenerator(visual_tools, verbose)
+SuctionGraspGenerator::SuctionGraspGenerator(rclcpp::Node::SharedPtr node,
+                                             const moveit_visual_tools::MoveItVisualToolsPtr& visual_tools,
+                                             bool verbose)
+  : GraspGenerator(node, visual_tools, verbose)
 {
+  node_ = node;
   auto suction_grasp_score_weights = std::make_shared<SuctionGraspScoreWeights>();
   grasp_score_weights_ = std::dynamic_pointer_cast<GraspScoreWeights>(suction_grasp_score_weights);
 
   // Load visulization settings
-  const std::string parent_name = "grasps";  // for namespacing logging messages
   std::size_t error = 0;
 
-  error += !rosparam_shortcuts::get(parent_name, nh_, "debug_top_grasps", debug_top_grasps_);
-  error += !rosparam_shortcuts::get(parent_name, nh_, "show_grasp_overhang", show_grasp_overhang_);
+  error += !rosparam_shortcuts::get(nh_, "moveit_grasps.generator.debug_top_grasps", debug_top_grasps_);
+  error += !rosparam_shortcuts::get(nh_, "moveit_grasps.generator.show_grasp_overhang", show_grasp_overhang_);
 
-  // Load scoring weights
-  rosparam_shortcuts::shutdownIfError(parent_name, error);
+  rosparam_shortcuts::shutdownIfError(error);
 }
 
 bool SuctionGraspGenerator::addGrasp(const Eigen::Isometry3d& grasp_pose_eef_mount,
                                      const SuctionGraspDataPtr& grasp_data, const Eigen::Isometry3d& object_pose,
                                      const Eigen::Vector3d& object_size,
-                                     std::vector<GraspCandidatePtr>& grasp_candidates)
+                                     std::vector<GraspCandidatePtr>& grasp_candidates, const rclcpp::Time& stamp,
+                                     std::size_t grasp_id)
 {
   // Transform the grasp pose eef mount to the tcp grasp pose
   Eigen::Isometry3d grasp_pose_tcp = grasp_pose_eef_mount * grasp_data->tcp_to_eef_mount_.inverse();
 
   // The new grasp
-  moveit_msgs::Grasp new_grasp;
+  moveit_msgs::msg::Grasp new_grasp;
 
   // Approach and retreat - aligned with eef to grasp transform
   // set pregrasp
-  moveit_msgs::GripperTranslation pre_grasp_approach;
-  new_grasp.pre_grasp_approach.direction.header.stamp = ros::Time::now();
+  new_grasp.pre_grasp_approach.direction.header.stamp = stamp;
   new_grasp.pre_grasp_approach.desired_distance = grasp_data->grasp_max_depth_ + grasp_data->approach_distance_desired_;
   new_grasp.pre_grasp_approach.min_distance = 0;  // NOT IMPLEMENTED
   new_grasp.pre_grasp_approach.direction.header.frame_id = grasp_data->parent_link_->getName();
@@ -89,8 +100,7 @@ bool SuctionGraspGenerator::addGrasp(const Eigen::Isometry3d& grasp_pose_eef_mou
   new_grasp.pre_grasp_approach.direction.vector.z = grasp_approach_vector.z();
 
   // set postgrasp
-  moveit_msgs::GripperTranslation post_grasp_retreat;
-  new_grasp.post_grasp_retreat.direction.header.stamp = ros::Time::now();
+  new_grasp.post_grasp_retreat.direction.header.stamp = stamp;
   new_grasp.post_grasp_retreat.desired_distance = grasp_data->grasp_max_depth_ + grasp_data->retreat_distance_desired_;
   new_grasp.post_grasp_retreat.min_distance = 0;  // NOT IMPLEMENTED
   new_grasp.post_grasp_retreat.direction.header.frame_id = grasp_data->parent_link_->getName();
@@ -99,24 +109,25 @@ bool SuctionGraspGenerator::addGrasp(const Eigen::Isometry3d& grasp_pose_eef_mou
   new_grasp.post_grasp_retreat.direction.vector.z = -1 * grasp_approach_vector.z();
 
   // set grasp pose
-  geometry_msgs::PoseStamped grasp_pose_msg;
-  grasp_pose_msg.header.stamp = ros::Time::now();
+  geometry_msgs::msg::PoseStamped grasp_pose_msg;
+  grasp_pose_msg.header.stamp = stamp;
   grasp_pose_msg.header.frame_id = grasp_data->base_link_;
 
   // name the grasp
-  static std::size_t grasp_id = 0;
-  new_grasp.id = "Grasp" + boost::lexical_cast<std::string>(grasp_id);
-  grasp_id++;
+  new_grasp.id = "Grasp" + std::to_string(grasp_id);
 
-  tf::poseEigenToMsg(grasp_pose_eef_mount, grasp_pose_msg.pose);
+  grasp_pose_msg.pose = Eigen::toMsg(grasp_pose_eef_mount);
   new_grasp.grasp_pose = grasp_pose_msg;
 
   // set grasp postures e.g. hand closed
   new_grasp.grasp_posture = grasp_data->grasp_posture_;
 
   std::vector<double> suction_voxel_overlap;
-  new_grasp.grasp_quality =
-      scoreSuctionGrasp(grasp_pose_tcp, grasp_data, object_pose, object_size, suction_voxel_overlap);
+  {
+    ScopedGraspStageTimer timer(&stats_, SCORING);
+    new_grasp.grasp_quality =
+        scoreSuctionGrasp(grasp_pose_tcp, grasp_data, object_pose, object_size, suction_voxel_overlap);
+  }
 
   auto suction_grasp_candidate = std::make_shared<SuctionGraspCandidate>(new_grasp, grasp_data, object_pose);
   suction_grasp_candidate->setSuctionVoxelOverlap(suction_voxel_overlap);
@@ -131,21 +142,21 @@ double SuctionGraspGenerator::scoreSuctionGrasp(const Eigen::Isometry3d& grasp_p
                                                 const Eigen::Vector3d& object_size,
                                                 std::vector<double>& suction_voxel_overlap)
 {
-  static const std::string logger_name = "grasp_generator.scoreGrasp";
+  static const rclcpp::Logger logger = rclcpp::get_logger("grasp_generator.scoreGrasp");
   if (getVerbose())
   {
-    ROS_DEBUG_STREAM_NAMED(logger_name,
-                           "Scoring grasp at: \n\tpose:  ("
-                               << grasp_pose_tcp.translation().x() << ",\t" << grasp_pose_tcp.translation().y() << ",\t"
-                               << grasp_pose_tcp.translation().z() << ")\t("
-                               << grasp_pose_tcp.rotation().eulerAngles(0, 1, 2)(0) << ",\t"
-                               << grasp_pose_tcp.rotation().eulerAngles(0, 1, 2)(1) << ",\t"
-                               << grasp_pose_tcp.rotation().eulerAngles(0, 1, 2)(2) << ")\n\tideal: ("
-                               << ideal_grasp_pose_.translation().x() << ",\t" << ideal_grasp_pose_.translation().y()
-                               << ",\t" << ideal_grasp_pose_.translation().z() << ")\t("
-                               << ideal_grasp_pose_.rotation().eulerAngles(0, 1, 2)(0) << ",\t"
-                               << ideal_grasp_pose_.rotation().eulerAngles(0, 1, 2)(1) << ",\t"
-                               << ideal_grasp_pose_.rotation().eulerAngles(0, 1, 2)(2) << ")");
+    RCLCPP_DEBUG_STREAM(logger,
+                        "Scoring grasp at: \n\tpose:  ("
+                            << grasp_pose_tcp.translation().x() << ",\t" << grasp_pose_tcp.translation().y() << ",\t"
+                            << grasp_pose_tcp.translation().z() << ")\t("
+                            << grasp_pose_tcp.rotation().eulerAngles(0, 1, 2)(0) << ",\t"
+                            << grasp_pose_tcp.rotation().eulerAngles(0, 1, 2)(1) << ",\t"
+                            << grasp_pose_tcp.rotation().eulerAngles(0, 1, 2)(2) << ")\n\tideal: ("
+                            << ideal_grasp_pose_.translation().x() << ",\t" << ideal_grasp_pose_.translation().y()
+                            << ",\t" << ideal_grasp_pose_.translation().z() << ")\t("
+                            << ideal_grasp_pose_.rotation().eulerAngles(0, 1, 2)(0) << ",\t"
+                            << ideal_grasp_pose_.rotation().eulerAngles(0, 1, 2)(1) << ",\t"
+                            << ideal_grasp_pose_.rotation().eulerAngles(0, 1, 2)(2) << ")");
   }
 
   // get portion of score based on the orientation
@@ -172,8 +183,8 @@ double SuctionGraspGenerator::scoreSuctionGrasp(const Eigen::Isometry3d& grasp_p
   }
   else
   {
-    ROS_WARN_NAMED(logger_name, "Failed to cast grasp_score_weights_ as SuctionGraspScoreWeights. continuing without "
-                                "finger specific scores");
+    RCLCPP_WARN(logger, "Failed to cast grasp_score_weights_ as SuctionGraspScoreWeights. continuing without "
+                        "suction specific scores");
     total_score = grasp_score_weights_->computeScore(orientation_scores, translation_scores, getVerbose());
   }
 
@@ -187,8 +198,8 @@ bool SuctionGraspGenerator::generateGrasps(const Eigen::Isometry3d& cuboid_pose,
   auto suction_grasp_data = std::dynamic_pointer_cast<SuctionGraspData>(grasp_data);
   if (!suction_grasp_data)
   {
-    ROS_ERROR_STREAM_NAMED("grasp_generator", "grasp_data is not castable to SuctionGraspData. Make sure you are using "
-                                              "the child class");
+    RCLCPP_ERROR_STREAM(LOGGER, "grasp_data is not castable to SuctionGraspData. Make sure you are using "
+                                "the child class");
     return false;
   }
   return generateGrasps(cuboid_pose, depth, width, height, suction_grasp_data, grasp_candidates);
@@ -198,11 +209,17 @@ bool SuctionGraspGenerator::generateGrasps(const Eigen::Isometry3d& cuboid_pose,
                                            double height, const moveit_grasps::SuctionGraspDataPtr& grasp_data,
                                            std::vector<GraspCandidatePtr>& grasp_candidates)
 {
+  stats_.clear();
+  const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
   bool result = generateSuctionGrasps(cuboid_pose, depth, width, height, grasp_data, grasp_candidates);
 
   if (result)
     std::sort(grasp_candidates.begin(), grasp_candidates.end(), GraspFilter::compareGraspScores);
 
+  // Scoring is timed on its own, the rest is generation
+  stats_.duration_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  stats_.addStageDuration(GENERATION, stats_.duration_ - stats_.stage_durations_[SCORING]);
   return result;
 }
 
@@ -225,11 +242,11 @@ void SuctionGraspGenerator::orientCuboidTowardsIdealTCP(Eigen::Isometry3d& cuboi
 
   if (debug_top_grasps_)
   {
-    ROS_DEBUG_STREAM_NAMED("grasp_generator", "cuboid_direction:\n" << cuboid_pose_fixed.rotation() << "\n");
-    ROS_DEBUG_STREAM_NAMED("grasp_generator", "ideal_grasp_tcp:\n" << ideal_grasp_tcp.rotation() << "\n");
+    RCLCPP_DEBUG_STREAM(LOGGER, "cuboid_direction:\n" << cuboid_pose_fixed.rotation() << "\n");
+    RCLCPP_DEBUG_STREAM(LOGGER, "ideal_grasp_tcp:\n" << ideal_grasp_tcp.rotation() << "\n");
     visual_tools_->publishWireframeCuboid(cuboid_pose_fixed, depth, width, height, rviz_visual_tools::YELLOW);
     visual_tools_->trigger();
-    ros::Duration(1).sleep();
+    rclcpp::sleep_for(std::chrono::seconds(1));
     // visual_tools_->prompt("start config");
   }
 
@@ -239,16 +256,16 @@ void SuctionGraspGenerator::orientCuboidTowardsIdealTCP(Eigen::Isometry3d& cuboi
                          .dot(ideal_grasp_tcp.rotation() * Eigen::Vector3d::UnitZ());
   if (dot_prodZ < 0)
   {
-    ROS_DEBUG_NAMED("grasp_generator", "flipping Z");
+    RCLCPP_DEBUG(LOGGER, "flipping Z");
     cuboid_pose_fixed = cuboid_pose_fixed * Eigen::AngleAxisd(M_PI, Eigen::Vector3d::UnitX());
-    ROS_DEBUG_STREAM_NAMED("grasp_generator", "New cuboid_direction:\n" << cuboid_pose_fixed.rotation() << "\n");
+    RCLCPP_DEBUG_STREAM(LOGGER, "New cuboid_direction:\n" << cuboid_pose_fixed.rotation() << "\n");
     if (debug_top_grasps_)
     {
       visual_tools_->deleteAllMarkers();
       visual_tools_->publishAxis(cuboid_pose_fixed, rviz_visual_tools::SMALL, "cuboid_pose_fixed");
       visual_tools_->publishWireframeCuboid(cuboid_pose_fixed, depth, width, height, rviz_visual_tools::BLUE);
       visual_tools_->trigger();
-      ros::Duration(1).sleep();
+      rclcpp::sleep_for(std::chrono::seconds(1));
       // visual_tools_->prompt("flipped Z by rotating around X");
     }
   }
@@ -258,16 +275,16 @@ void SuctionGraspGenerator::orientCuboidTowardsIdealTCP(Eigen::Isometry3d& cuboi
                          .dot(ideal_grasp_tcp.rotation() * Eigen::Vector3d::UnitX());
   if (dot_prodX < 0)
   {
-    ROS_DEBUG_NAMED("generateSuctionGrasps", "flipping X");
+    RCLCPP_DEBUG(LOGGER, "flipping X");
     cuboid_pose_fixed = cuboid_pose_fixed * Eigen::AngleAxisd(M_PI, Eigen::Vector3d::UnitZ());
-    ROS_DEBUG_STREAM_NAMED("grasp_generator", "New cuboid_direction:\n" << cuboid_pose_fixed.rotation() << "\n");
+    RCLCPP_DEBUG_STREAM(LOGGER, "New cuboid_direction:\n" << cuboid_pose_fixed.rotation() << "\n");
     if (debug_top_grasps_)
     {
       visual_tools_->deleteAllMarkers();
       visual_tools_->publishAxis(cuboid_pose_fixed, rviz_visual_tools::SMALL, "cuboid_pose_fixed");
       visual_tools_->publishWireframeCuboid(cuboid_pose_fixed, depth, width, height, rviz_visual_tools::GREEN);
       visual_tools_->trigger();
-      ros::Duration(1).sleep();
+      rclcpp::sleep_for(std::chrono::seconds(1));
       // visual_tools_->prompt("flipped X by rotating around Z");
     }
   }
@@ -294,8 +311,7 @@ bool SuctionGraspGenerator::generateSuctionGrasps(const Eigen::Isometry3d& cuboi
 
   if (debug_top_grasps_)
   {
-    ROS_DEBUG_STREAM_NAMED("grasp_generator",
-                           "\n\tWidth:\t" << width << "\n\tDepth:\t" << depth << "\n\tHeight\t" << height);
+    RCLCPP_DEBUG_STREAM(LOGGER, "\n\tWidth:\t" << width << "\n\tDepth:\t" << depth << "\n\tHeight\t" << height);
     visual_tools_->publishAxisLabeled(cuboid_top_pose, "cuboid_top_pose", rviz_visual_tools::SMALL);
     double suction_z_range = grasp_data->grasp_max_depth_ - grasp_data->grasp_min_depth_;
     visual_tools_->publishWireframeCuboid(cuboid_top_pose * Eigen::Translation3d(0, 0, suction_z_range / 2.0), depth,
@@ -325,22 +341,22 @@ bool SuctionGraspGenerator::generateSuctionGrasps(const Eigen::Isometry3d& cuboi
   double yaw_max = 2.0 * M_PI;
 
   // clang-format off
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.suction.range", "x_min:                  " << x_min);
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.suction.range", "x_max:                  " << x_max);
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.suction.range", "depth:                  " << depth);
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.suction.range", "active_suction_range_x: " << grasp_data->suction_voxel_matrix_->getActiveSuctionWidthX());
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.suction.range", "voxel_x_width:          " << grasp_data->suction_voxel_matrix_->getVoxelWidthX());
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.suction.range", "y_min:                  " << y_min);
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.suction.range", "y_max:                  " << y_max);
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.suction.range", "width:                  " << width);
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.suction.range", "active_suction_range_y: " << grasp_data->suction_voxel_matrix_->getActiveSuctionWidthY());
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.suction.range", "voxel_y_width:          " << grasp_data->suction_voxel_matrix_->getVoxelWidthY());
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.suction.range", "z_min:                  " << z_min);
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.suction.range", "z_max:                  " << z_max);
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.suction.range", "xy_increment:           " << xy_increment);
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.suction.range", "yaw_increment:          " << yaw_increment);
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.suction.range", "yaw_min:                " << yaw_min);
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.suction.range", "yaw_max:                " << yaw_max);
+  RCLCPP_DEBUG_STREAM(LOGGER_RANGE, "x_min:                  " << x_min);
+  RCLCPP_DEBUG_STREAM(LOGGER_RANGE, "x_max:                  " << x_max);
+  RCLCPP_DEBUG_STREAM(LOGGER_RANGE, "depth:                  " << depth);
+  RCLCPP_DEBUG_STREAM(LOGGER_RANGE, "active_suction_range_x: " << grasp_data->suction_voxel_matrix_->getActiveSuctionWidthX());
+  RCLCPP_DEBUG_STREAM(LOGGER_RANGE, "voxel_x_width:          " << grasp_data->suction_voxel_matrix_->getVoxelWidthX());
+  RCLCPP_DEBUG_STREAM(LOGGER_RANGE, "y_min:                  " << y_min);
+  RCLCPP_DEBUG_STREAM(LOGGER_RANGE, "y_max:                  " << y_max);
+  RCLCPP_DEBUG_STREAM(LOGGER_RANGE, "width:                  " << width);
+  RCLCPP_DEBUG_STREAM(LOGGER_RANGE, "active_suction_range_y: " << grasp_data->suction_voxel_matrix_->getActiveSuctionWidthY());
+  RCLCPP_DEBUG_STREAM(LOGGER_RANGE, "voxel_y_width:          " << grasp_data->suction_voxel_matrix_->getVoxelWidthY());
+  RCLCPP_DEBUG_STREAM(LOGGER_RANGE, "z_min:                  " << z_min);
+  RCLCPP_DEBUG_STREAM(LOGGER_RANGE, "z_max:                  " << z_max);
+  RCLCPP_DEBUG_STREAM(LOGGER_RANGE, "xy_increment:           " << xy_increment);
+  RCLCPP_DEBUG_STREAM(LOGGER_RANGE, "yaw_increment:          " << yaw_increment);
+  RCLCPP_DEBUG_STREAM(LOGGER_RANGE, "yaw_min:                " << yaw_min);
+  RCLCPP_DEBUG_STREAM(LOGGER_RANGE, "yaw_max:                " << yaw_max);
 
   // clang-format on
 
@@ -349,7 +365,7 @@ bool SuctionGraspGenerator::generateSuctionGrasps(const Eigen::Isometry3d& cuboi
 
   // Add Depth grasps (Z-axis)
   num_grasps = grasp_poses_tcp.size();
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.generate_suction_grasps", "num grasps before Z:\t " << num_grasps);
+  RCLCPP_DEBUG_STREAM(LOGGER_GENERATE, "num grasps before Z:\t " << num_grasps);
   for (std::size_t i = 0; i < num_grasps; ++i)
   {
     for (double z = z_min; z <= z_max; z += z_increment)
@@ -358,7 +374,7 @@ bool SuctionGraspGenerator::generateSuctionGrasps(const Eigen::Isometry3d& cuboi
     }
   }
   num_grasps = grasp_poses_tcp.size();
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.generate_suction_grasps", "num grasps after Z:\t " << num_grasps);
+  RCLCPP_DEBUG_STREAM(LOGGER_GENERATE, "num grasps after Z:\t " << num_grasps);
 
   // Add Y translation grasps
   for (std::size_t i = 0; i < num_grasps; ++i)
@@ -370,7 +386,7 @@ bool SuctionGraspGenerator::generateSuctionGrasps(const Eigen::Isometry3d& cuboi
     }
   }
   num_grasps = grasp_poses_tcp.size();
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.generate_suction_grasps", "num grasps after Y:\t " << num_grasps);
+  RCLCPP_DEBUG_STREAM(LOGGER_GENERATE, "num grasps after Y:\t " << num_grasps);
 
   // Add X translation grasps
   for (std::size_t i = 0; i < num_grasps; ++i)
@@ -382,7 +398,7 @@ bool SuctionGraspGenerator::generateSuctionGrasps(const Eigen::Isometry3d& cuboi
     }
   }
   num_grasps = grasp_poses_tcp.size();
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.generate_suction_grasps", "num grasps after X:\t " << num_grasps);
+  RCLCPP_DEBUG_STREAM(LOGGER_GENERATE, "num grasps after X:\t " << num_grasps);
 
   // Add rotated suction grasps (Yaw)
   for (std::size_t i = 0; i < num_grasps; ++i)
@@ -393,13 +409,17 @@ bool SuctionGraspGenerator::generateSuctionGrasps(const Eigen::Isometry3d& cuboi
     }
   }
   num_grasps = grasp_poses_tcp.size();
-  ROS_DEBUG_STREAM_NAMED("grasp_generator.generate_suction_grasps", "num grasps after Yaw:\t " << num_grasps);
+  RCLCPP_DEBUG_STREAM(LOGGER_GENERATE, "num grasps after Yaw:\t " << num_grasps);
 
   Eigen::Vector3d object_size(depth, width, height);
+  grasp_candidates.reserve(num_grasps);
+  const rclcpp::Time stamp = node_->get_clock()->now();
+  const std::size_t first_grasp_id = reserveGraspIds(num_grasps);
   for (std::size_t i = 0; i < num_grasps; ++i)
   {
     Eigen::Isometry3d grasp_pose_eef_mount = grasp_poses_tcp[i] * grasp_data->tcp_to_eef_mount_;
-    addGrasp(grasp_pose_eef_mount, grasp_data, cuboid_top_pose, object_size, grasp_candidates);
+    addGrasp(grasp_pose_eef_mount, grasp_data, cuboid_top_pose, object_size, grasp_candidates, stamp,
+             first_grasp_id + i);
     if (debug_top_grasps_)
     {
       visual_tools_->publishAxis(grasp_poses_tcp[i], rviz_visual_tools::MEDIUM, "tcp pose");
@@ -416,17 +436,14 @@ bool SuctionGraspGenerator::generateSuctionGrasps(const Eigen::Isometry3d& cuboi
   }
 
   if (!grasp_candidates.size())
-    ROS_WARN_STREAM_NAMED("grasp_generator.generate_suction_grasps", "Generated 0 grasps");
+    RCLCPP_WARN_STREAM(LOGGER_GENERATE, "Generated 0 grasps");
   else
-    ROS_INFO_STREAM_NAMED("grasp_generator.generate_suction_grasps", "Generated " << grasp_candidates.size()
-                                                                                  << " grasp"
-                                                                                     "s");
+    RCLCPP_INFO_STREAM(LOGGER_GENERATE, "Generated " << grasp_candidates.size() << " grasps");
 
   // Visualize animated grasps that have been generated
   if (show_prefiltered_grasps_)
   {
-    ROS_DEBUG_STREAM_NAMED("grasp_generator.generate_suction_grasps", "Animating all generated (candidate) grasps "
-                                                                      "before filtering");
+    RCLCPP_DEBUG_STREAM(LOGGER_GENERATE, "Animating all generated (candidate) grasps before filtering");
     visualizeAnimatedGrasps(grasp_candidates, grasp_data->ee_jmg_, show_prefiltered_grasps_speed_);
   }
 
@@ -65,12 +65,11 @@ bool TwoFingerGraspFilter::processCandidateGrasp(const IkThreadStructPtr& ik_thr
   // Helper pointer
   GraspCandidatePtr& grasp_candidate = ik_thread_struct->grasp_candidates_[ik_thread_struct->grasp_id];
 
-  moveit::core::GroupStateValidityCallbackFn constraint_fn =
-      boost::bind(&isGraspStateValid, ik_thread_struct->planning_scene_.get(),
-                  collision_verbose_ || ik_thread_struct->visual_debug_, collision_verbose_speed_, visual_tools_, _1,
-                  _2, _3);
+  const moveit::core::GroupStateValidityCallbackFn& constraint_fn =
+      getStateValidityCallback(ik_thread_struct, grasp_candidate);
 
   // Check if IK solution for grasp pose is valid for fingers closed as well
+  ScopedGraspStageTimer timer(&ik_thread_struct->stats_, CLOSED_FINGER_CHECK);
   return checkFingersClosedIK(grasp_candidate->grasp_ik_solution_, ik_thread_struct, grasp_candidate, constraint_fn);
 }
 
@@ -82,8 +81,20 @@ bool TwoFingerGraspFilter::checkFingersClosedIK(std::vector<double>& ik_solution
   // Set gripper position (how open the fingers are) to CLOSED
   grasp_candidate->getGraspStateClosedEEOnly(ik_thread_struct->robot_state_);
 
-  // Check constraint function
-  if (!constraint_fn(ik_thread_struct->robot_state_.get(), grasp_candidate->grasp_data_->arm_jmg_, &ik_solution[0]))
+  bool valid;
+  if (staged_collision_checking_)
+  {
+    // The arm was already checked at this solution, only the collisions of the closed fingers can be new
+    ik_thread_struct->robot_state_->setJointGroupPositions(grasp_candidate->grasp_data_->arm_jmg_, ik_solution);
+    valid = checkEndEffectorCollision(ik_thread_struct, grasp_candidate->grasp_data_->ee_jmg_);
+  }
+  else
+  {
+    // Check constraint function
+    valid = constraint_fn(ik_thread_struct->robot_state_.get(), grasp_candidate->grasp_data_->arm_jmg_,
+                          &ik_solution[0]);
+  }
+  if (!valid)
   {
     RCLCPP_WARN_STREAM(LOGGER_SUPERDEBUG, "Grasp filtered because in collision with fingers CLOSED");
     grasp_candidate->grasp_filtered_code_ = GraspFilterCode::GRASP_FILTERED_BY_IK_CLOSED;
@@ -38,8 +38,15 @@
 
 #include <moveit_grasps/two_finger_grasp_generator.h>
 #include <moveit_grasps/grasp_filter.h>
+#include <moveit_grasps/ik_seed_cache.h>
 
-#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
 
 #include <rosparam_shortcuts/rosparam_shortcuts.h>
 
@@ -56,6 +63,17 @@ void debugFailedOpenGripper(double percent_open, double min_finger_open_on_appro
                                                       << grasp_padding_on_approach);
 }
 
+// Copy of the grasp data with all sampling resolutions multiplied by factor
+moveit_grasps::TwoFingerGraspDataPtr getCoarseGraspData(const moveit_grasps::TwoFingerGraspDataPtr& grasp_data,
+                                                        double factor)
+{
+  auto coarse_grasp_data = std::make_shared<moveit_grasps::TwoFingerGraspData>(*grasp_data);
+  coarse_grasp_data->angle_resolution_ = std::lround(grasp_data->angle_resolution_ * factor);
+  coarse_grasp_data->grasp_resolution_ = grasp_data->grasp_resolution_ * factor;
+  coarse_grasp_data->grasp_depth_resolution_ = grasp_data->grasp_depth_resolution_ * factor;
+  return coarse_grasp_data;
+}
+
 }  // namespace
 
 namespace moveit_grasps
@@ -144,108 +162,322 @@ bool TwoFingerGraspGenerator::generateGrasps(const Eigen::Isometry3d& cuboid_pos
                                              double height, const TwoFingerGraspDataPtr& grasp_data,
                                              std::vector<GraspCandidatePtr>& grasp_candidates)
 {
-  bool result =
-      generateFingerGrasps(cuboid_pose, depth, width, height, grasp_data, grasp_candidates, grasp_candidate_config_);
+  GraspCandidateBatch grasp_candidate_batch(grasp_data, cuboid_pose);
+  if (!generateGrasps(cuboid_pose, depth, width, height, grasp_data, grasp_candidate_batch))
+    return false;
+
+  grasp_candidate_batch.getGraspCandidates(grasp_candidates, node_->get_clock()->now());
+  return true;
+}
+
+bool TwoFingerGraspGenerator::generateGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width,
+                                             double height, const TwoFingerGraspDataPtr& grasp_data,
+                                             GraspCandidateBatch& grasp_candidate_batch)
+{
+  stats_.clear();
+  const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+  bool result = generateFingerGrasps(cuboid_pose, depth, width, height, grasp_data, grasp_candidate_batch,
+                                     grasp_candidate_config_);
 
   if (result)
-    std::sort(grasp_candidates.begin(), grasp_candidates.end(), GraspFilter::compareGraspScores);
+    grasp_candidate_batch.sortByScore();
 
+  // Scoring is timed on its own, the rest is generation
+  stats_.duration_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  stats_.addStageDuration(GENERATION, stats_.duration_ - stats_.stage_durations_[SCORING]);
   return result;
 }
 
+bool TwoFingerGraspGenerator::streamGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width,
+                                           double height, const GraspDataPtr& grasp_data,
+                                           const GraspCandidatesCallback& callback, std::size_t chunk_size)
+{
+  auto two_finger_grasp_data = std::dynamic_pointer_cast<TwoFingerGraspData>(grasp_data);
+  if (!two_finger_grasp_data)
+  {
+    RCLCPP_ERROR_STREAM(rclcpp::get_logger("grasp_generator"),
+                        "grasp_data is not castable to TwoFingerGraspData. Make sure you are using "
+                        "the child class");
+    return false;
+  }
+
+  // Only the generation is timed, not the callback
+  stats_.clear();
+  double generation_duration = 0;
+  std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+  const auto finish_stats = [&]() {
+    stats_.duration_ = generation_duration;
+    stats_.addStageDuration(GENERATION, stats_.duration_ - stats_.stage_durations_[SCORING]);
+  };
+
+  // Scoring depends on the statistics of all poses of an axis, so an axis is the smallest unit that can be scored
+  // on its own. One config per enabled axis
+  std::vector<TwoFingerGraspCandidateConfig> axis_configs;
+  const std::array<bool, 3> generate_axis = { grasp_candidate_config_.generate_x_axis_grasps_,
+                                              grasp_candidate_config_.generate_y_axis_grasps_,
+                                              grasp_candidate_config_.generate_z_axis_grasps_ };
+  for (std::size_t i = 0; i < generate_axis.size(); ++i)
+  {
+    if (!generate_axis[i])
+      continue;
+    TwoFingerGraspCandidateConfig axis_config = grasp_candidate_config_;
+    axis_config.disableAllGraspAxes();
+    axis_config.generate_x_axis_grasps_ = i == 0;
+    axis_config.generate_y_axis_grasps_ = i == 1;
+    axis_config.generate_z_axis_grasps_ = i == 2;
+    axis_configs.push_back(axis_config);
+  }
+
+  // Order the axes by the best score of the coarsest level of generateGraspsAdaptive(), so the axis with the best
+  // grasps is generated and passed to the callback first. Axes without coarse grasps go last
+  static const double COARSE_FACTOR = 4.0;
+  const TwoFingerGraspDataPtr coarse_grasp_data = getCoarseGraspData(two_finger_grasp_data, COARSE_FACTOR);
+  std::vector<std::pair<double, std::size_t>> axis_order;
+  for (std::size_t i = 0; i < axis_configs.size(); ++i)
+  {
+    GraspCandidateBatch coarse_batch(grasp_data, cuboid_pose);
+    if (!generateFingerGrasps(cuboid_pose, depth, width, height, coarse_grasp_data, coarse_batch, axis_configs[i]))
+      return false;
+    const std::vector<double>& scores = coarse_batch.getScores();
+    const double best_score = scores.empty() ? -std::numeric_limits<double>::infinity() :
+                                               *std::max_element(scores.begin(), scores.end());
+    axis_order.emplace_back(best_score, i);
+  }
+  std::stable_sort(axis_order.begin(), axis_order.end(),
+                   [](const std::pair<double, std::size_t>& a, const std::pair<double, std::size_t>& b) {
+                     return a.first > b.first;
+                   });
+
+  chunk_size = std::max<std::size_t>(chunk_size, 1);
+  const rclcpp::Time stamp = node_->get_clock()->now();
+  std::vector<GraspCandidatePtr> chunk;
+  for (const std::pair<double, std::size_t>& axis : axis_order)
+  {
+    // Sorted by descending score
+    GraspCandidateBatch grasp_candidate_batch(grasp_data, cuboid_pose);
+    if (!generateFingerGrasps(cuboid_pose, depth, width, height, two_finger_grasp_data, grasp_candidate_batch,
+                              axis_configs[axis.second]))
+    {
+      return false;
+    }
+    grasp_candidate_batch.sortByScore();
+
+    for (std::size_t begin = 0; begin < grasp_candidate_batch.size(); begin += chunk_size)
+    {
+      const std::size_t end = std::min(begin + chunk_size, grasp_candidate_batch.size());
+      chunk.clear();
+      for (std::size_t i = begin; i < end; ++i)
+        chunk.push_back(grasp_candidate_batch.getGraspCandidate(i, stamp));
+      generation_duration +=
+          std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+      const bool resume = callback(chunk);
+      start_time = std::chrono::steady_clock::now();
+      if (!resume)
+      {
+        finish_stats();
+        return true;
+      }
+    }
+  }
+  generation_duration += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  finish_stats();
+  return true;
+}
+
+bool TwoFingerGraspGenerator::generateGraspsAdaptive(const Eigen::Isometry3d& cuboid_pose, double depth,
+                                                     double width, double height,
+                                                     const TwoFingerGraspDataPtr& grasp_data,
+                                                     const GraspCandidatesFilterFn& filter,
+                                                     std::vector<GraspCandidatePtr>& grasp_candidates,
+                                                     std::size_t num_levels, std::size_t max_filtered_grasps)
+{
+  static const rclcpp::Logger logger = rclcpp::get_logger("grasp_generator.adaptive");
+  if (!grasp_data || !filter)
+  {
+    RCLCPP_ERROR(logger, "Adaptive grasp generation needs grasp data and a filter");
+    return false;
+  }
+  num_levels = std::max<std::size_t>(num_levels, 1);
+
+  // Only the generation of the levels is timed, not the filter
+  GraspStats stats;
+  const rclcpp::Time stamp = node_->get_clock()->now();
+
+  // Valid poses of the previous level, only the grasps close to them are filtered on the next level
+  std::shared_ptr<IkSeedCache> valid_poses;
+
+  // Every finer level samples a superset of the coarser ones, so the poses filtered on a previous level are skipped
+  // instead of being filtered and returned again
+  static const double SAME_POSE_ROTATION = 0.001;  // rad
+  IkSeedCache filtered_poses(MIN_GRASP_DISTANCE, SAME_POSE_ROTATION);
+
+  std::size_t num_filtered = 0;
+  for (std::size_t level = num_levels; level-- > 0;)
+  {
+    // Coarser copy of the grasp data, the candidates still reference the original one
+    const double factor = std::pow(2.0, static_cast<double>(level));
+    TwoFingerGraspDataPtr level_grasp_data = level > 0 ? getCoarseGraspData(grasp_data, factor) : grasp_data;
+
+    // Sorted by descending score
+    GraspCandidateBatch grasp_candidate_batch(grasp_data, cuboid_pose);
+    if (!generateGrasps(cuboid_pose, depth, width, height, level_grasp_data, grasp_candidate_batch))
+      return false;
+    stats.merge(stats_);
+
+    std::vector<GraspCandidatePtr> level_candidates;
+    EigenSTL::vector_Isometry3d level_poses;
+    std::size_t num_skipped = 0;
+    for (std::size_t i = 0; i < grasp_candidate_batch.size(); ++i)
+    {
+      if (max_filtered_grasps > 0 && num_filtered + level_candidates.size() >= max_filtered_grasps)
+        break;
+      const Eigen::Isometry3d& grasp_pose = grasp_candidate_batch.getGraspPoses()[i];
+      if (filtered_poses.contains(grasp_pose))
+      {
+        ++num_skipped;
+        continue;
+      }
+      if (!valid_poses || valid_poses->contains(grasp_pose))
+      {
+        level_candidates.push_back(grasp_candidate_batch.getGraspCandidate(i, stamp));
+        level_poses.push_back(grasp_pose);
+      }
+    }
+    RCLCPP_DEBUG_STREAM(logger, "Level " << level << ": filtering " << level_candidates.size() << " of "
+                                         << grasp_candidate_batch.size() << " grasps, " << num_skipped
+                                         << " were filtered on a previous level");
+    if (level_candidates.empty())
+      break;
+    num_filtered += level_candidates.size();
+    filter(level_candidates);
+
+    // The neighborhood of a valid grasp is one step of this level's resolution
+    valid_poses = std::make_shared<IkSeedCache>(
+        std::max(level_grasp_data->grasp_resolution_, level_grasp_data->grasp_depth_resolution_),
+        level_grasp_data->angle_resolution_ * M_PI / 180.0);
+    for (std::size_t i = 0; i < level_candidates.size(); ++i)
+    {
+      filtered_poses.insert(level_poses[i]);
+      if (!level_candidates[i]->isValid())
+        continue;
+      grasp_candidates.push_back(level_candidates[i]);
+      valid_poses->insert(level_poses[i]);
+    }
+
+    // Nothing to refine around, the coarse sampling may have missed small feasible regions
+    if (!valid_poses->size())
+    {
+      RCLCPP_DEBUG_STREAM(logger, "No valid grasps at level " << level << ", filtering all grasps of the next level");
+      valid_poses.reset();
+    }
+    if (max_filtered_grasps > 0 && num_filtered >= max_filtered_grasps)
+      break;
+  }
+
+  std::stable_sort(grasp_candidates.begin(), grasp_candidates.end(), GraspFilter::compareGraspScores);
+
+  stats_ = stats;
+  RCLCPP_INFO_STREAM(logger, "Found " << grasp_candidates.size() << " valid grasps after filtering " << num_filtered
+                                      << " grasps in " << num_levels << " levels");
+  return !grasp_candidates.empty();
+}
+
 bool TwoFingerGraspGenerator::addGrasp(const Eigen::Isometry3d& grasp_pose_eef_mount,
                                        const TwoFingerGraspDataPtr& grasp_data, const Eigen::Isometry3d& object_pose,
-                                       const Eigen::Vector3d& object_size, double object_width,
+                                       const Eigen::Vector3d& /*object_size*/, double object_width,
                                        std::vector<GraspCandidatePtr>& grasp_candidates)
 {
   // Transform the grasp pose eef mount to the tcp grasp pose
-  Eigen::Isometry3d grasp_pose_tcp = grasp_pose_eef_mount * grasp_data->tcp_to_eef_mount_.inverse();
-
-  // The new grasp
-  moveit_msgs::msg::Grasp new_grasp;
-
-  // Approach and retreat - aligned with eef to grasp transform
-  // set pregrasp
-  moveit_msgs::msg::GripperTranslation pre_grasp_approach;
-  new_grasp.pre_grasp_approach.direction.header.stamp = node_->get_clock()->now();
-  new_grasp.pre_grasp_approach.desired_distance = grasp_data->grasp_max_depth_ + grasp_data->approach_distance_desired_;
-  new_grasp.pre_grasp_approach.min_distance = 0;  // NOT IMPLEMENTED
-  new_grasp.pre_grasp_approach.direction.header.frame_id = grasp_data->parent_link_->getName();
-
-  Eigen::Vector3d grasp_approach_vector = -1 * grasp_data->tcp_to_eef_mount_.translation();
-  grasp_approach_vector = grasp_approach_vector / grasp_approach_vector.norm();
-
-  new_grasp.pre_grasp_approach.direction.vector.x = grasp_approach_vector.x();
-  new_grasp.pre_grasp_approach.direction.vector.y = grasp_approach_vector.y();
-  new_grasp.pre_grasp_approach.direction.vector.z = grasp_approach_vector.z();
-
-  // set postgrasp
-  moveit_msgs::msg::GripperTranslation post_grasp_retreat;
-  new_grasp.post_grasp_retreat.direction.header.stamp = node_->get_clock()->now();
-  new_grasp.post_grasp_retreat.desired_distance = grasp_data->grasp_max_depth_ + grasp_data->retreat_distance_desired_;
-  new_grasp.post_grasp_retreat.min_distance = 0;  // NOT IMPLEMENTED
-  new_grasp.post_grasp_retreat.direction.header.frame_id = grasp_data->parent_link_->getName();
-  new_grasp.post_grasp_retreat.direction.vector.x = -1 * grasp_approach_vector.x();
-  new_grasp.post_grasp_retreat.direction.vector.y = -1 * grasp_approach_vector.y();
-  new_grasp.post_grasp_retreat.direction.vector.z = -1 * grasp_approach_vector.z();
-
-  // set grasp pose
-  geometry_msgs::msg::PoseStamped grasp_pose_msg;
-  grasp_pose_msg.header.stamp = node_->get_clock()->now();
-  grasp_pose_msg.header.frame_id = grasp_data->base_link_;
-
-  // name the grasp
-  static std::size_t grasp_id = 0;
-  new_grasp.id = "Grasp" + boost::lexical_cast<std::string>(grasp_id);
-  grasp_id++;
-
-  grasp_pose_msg.pose = Eigen::toMsg(grasp_pose_eef_mount);
-  new_grasp.grasp_pose = grasp_pose_msg;
-
-  // set grasp postures e.g. hand closed
-  new_grasp.grasp_posture = grasp_data->grasp_posture_;
+  const EigenSTL::vector_Isometry3d grasp_poses_tcp(1, grasp_pose_eef_mount * grasp_data->tcp_to_eef_mount_.inverse());
+
+  GraspCandidateBatch grasp_candidate_batch(grasp_data, object_pose);
+  bool result = addGrasps(grasp_poses_tcp, grasp_data, object_pose, object_width, grasp_candidate_batch) == 1;
+  grasp_candidate_batch.getGraspCandidates(grasp_candidates, node_->get_clock()->now());
+  return result;
+}
+
+std::size_t TwoFingerGraspGenerator::addGrasps(const EigenSTL::vector_Isometry3d& grasp_poses_tcp,
+                                               const TwoFingerGraspDataPtr& grasp_data,
+                                               const Eigen::Isometry3d& object_pose, double object_width,
+                                               GraspCandidateBatch& grasp_candidate_batch,
+                                               const Eigen::VectorXd* distance_scores)
+{
+  // Each pose is added with the widest, middle and minimum finger opening
+  static const std::array<double, 3> PERCENT_OPEN_LEVELS = { 1.0, 0.5, 0.0 };
 
   // set minimum opening of fingers for pre grasp approach
   double min_finger_open_on_approach = object_width + 2 * grasp_data->grasp_padding_on_approach_;
-  double percent_open;
 
-  // Create grasp with widest fingers possible ----------------------------------------------
-  percent_open = 1.0;
-  if (!grasp_data->setGraspWidth(percent_open, min_finger_open_on_approach, new_grasp.pre_grasp_posture))
+  // The pre grasp postures only depend on the object width, so they are computed once and shared by all poses
+  std::vector<double> percent_opens;
+  std::vector<std::size_t> pre_grasp_posture_ids;
+  trajectory_msgs::msg::JointTrajectory pre_grasp_posture;
+  for (double percent_open : PERCENT_OPEN_LEVELS)
   {
-    debugFailedOpenGripper(percent_open, min_finger_open_on_approach, object_width,
-                           grasp_data->grasp_padding_on_approach_);
-    return false;
+    if (!grasp_data->setGraspWidth(percent_open, min_finger_open_on_approach, pre_grasp_posture))
+    {
+      debugFailedOpenGripper(percent_open, min_finger_open_on_approach, object_width,
+                             grasp_data->grasp_padding_on_approach_);
+      break;
+    }
+    percent_opens.push_back(percent_open);
+    pre_grasp_posture_ids.push_back(grasp_candidate_batch.addPreGraspPosture(pre_grasp_posture, percent_open));
   }
 
-  new_grasp.grasp_quality = scoreFingerGrasp(grasp_pose_tcp, grasp_data, object_pose, percent_open);
+  // name the grasps, all openings of a pose share its id
+  const std::size_t first_grasp_id = reserveGraspIds(grasp_poses_tcp.size());
 
-  // Show visualization for widest grasp
+  const std::size_t num_openings = percent_opens.size();
+  std::vector<Eigen::VectorXd> scores(num_openings);
+  {
+    ScopedGraspStageTimer timer(&stats_, SCORING);
+    if (getVerbose())
+    {
+      // The scalar scoring prints the individual scores of every grasp
+      for (std::size_t j = 0; j < num_openings; ++j)
+      {
+        scores[j].resize(grasp_poses_tcp.size());
+        for (std::size_t i = 0; i < grasp_poses_tcp.size(); ++i)
+          scores[j][i] = scoreFingerGrasp(grasp_poses_tcp[i], grasp_data, object_pose, percent_opens[j]);
+      }
+    }
+    else
+      scoreFingerGrasps(grasp_poses_tcp, grasp_data, object_pose, percent_opens, scores, distance_scores);
+  }
 
-  grasp_candidates.push_back(std::make_shared<GraspCandidate>(new_grasp, grasp_data, object_pose));
+  // Every grasp has a fixed slot, so they can be written in parallel without changing the order
+  const std::size_t first_index = grasp_candidate_batch.size();
+  grasp_candidate_batch.resize(first_index + grasp_poses_tcp.size() * num_openings);
 
-  // Create grasp with middle width fingers -------------------------------------------------
-  percent_open = 0.5;
-  if (!grasp_data->setGraspWidth(percent_open, min_finger_open_on_approach, new_grasp.pre_grasp_posture))
+#pragma omp parallel for schedule(static) if (parallel_generation_)
+  for (std::size_t i = 0; i < grasp_poses_tcp.size(); ++i)
   {
-    debugFailedOpenGripper(percent_open, min_finger_open_on_approach, object_width,
-                           grasp_data->grasp_padding_on_approach_);
-    return false;
+    Eigen::Isometry3d grasp_pose_eef_mount = grasp_poses_tcp[i] * grasp_data->tcp_to_eef_mount_;
+    for (std::size_t j = 0; j < num_openings; ++j)
+    {
+      grasp_candidate_batch.setGrasp(first_index + i * num_openings + j, grasp_pose_eef_mount, scores[j][i],
+                                     pre_grasp_posture_ids[j], first_grasp_id + i);
+    }
   }
-  new_grasp.grasp_quality = scoreFingerGrasp(grasp_pose_tcp, grasp_data, object_pose, percent_open);
-  grasp_candidates.push_back(std::make_shared<GraspCandidate>(new_grasp, grasp_data, object_pose));
 
-  // Create grasp with fingers at minimum width ---------------------------------------------
-  percent_open = 0.0;
-  if (!grasp_data->setGraspWidth(percent_open, min_finger_open_on_approach, new_grasp.pre_grasp_posture))
-  {
-    debugFailedOpenGripper(percent_open, min_finger_open_on_approach, object_width,
-                           grasp_data->grasp_padding_on_approach_);
+  // A pose only counts as added if all of its openings could be created
+  return percent_opens.size() == PERCENT_OPEN_LEVELS.size() ? grasp_poses_tcp.size() : 0;
+}
+
+bool TwoFingerGraspGenerator::generateCuboidAxisGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width,
+                                                       double height, grasp_axis_t axis,
+                                                       const TwoFingerGraspDataPtr& grasp_data,
+                                                       const TwoFingerGraspCandidateConfig& grasp_candidate_config,
+                                                       std::vector<GraspCandidatePtr>& grasp_candidates)
+{
+  GraspCandidateBatch grasp_candidate_batch(grasp_data, cuboid_pose);
+  if (!generateCuboidAxisGrasps(cuboid_pose, depth, width, height, axis, grasp_data, grasp_candidate_config,
+                                grasp_candidate_batch))
     return false;
-  }
-  new_grasp.grasp_quality = scoreFingerGrasp(grasp_pose_tcp, grasp_data, object_pose, percent_open);
-  grasp_candidates.push_back(std::make_shared<GraspCandidate>(new_grasp, grasp_data, object_pose));
 
+  grasp_candidate_batch.getGraspCandidates(grasp_candidates, node_->get_clock()->now());
   return true;
 }
 
@@ -253,16 +485,48 @@ bool TwoFingerGraspGenerator::generateCuboidAxisGrasps(const Eigen::Isometry3d&
                                                        double height, grasp_axis_t axis,
                                                        const TwoFingerGraspDataPtr& grasp_data,
                                                        const TwoFingerGraspCandidateConfig& grasp_candidate_config,
-                                                       std::vector<GraspCandidatePtr>& grasp_candidates)
+                                                       GraspCandidateBatch& grasp_candidate_batch)
+{
+  EigenSTL::vector_Isometry3d grasp_poses_tcp;
+  double object_width;
+  if (!generateCuboidAxisGraspPoses(cuboid_pose, depth, width, height, axis, grasp_data, grasp_candidate_config,
+                                    grasp_poses_tcp, object_width))
+    return false;
+
+  addCuboidAxisGrasps(cuboid_pose, grasp_poses_tcp, grasp_data, object_width, grasp_candidate_batch);
+  return true;
+}
+
+void TwoFingerGraspGenerator::addCuboidAxisGrasps(const Eigen::Isometry3d& cuboid_pose,
+                                                  const EigenSTL::vector_Isometry3d& grasp_poses_tcp,
+                                                  const TwoFingerGraspDataPtr& grasp_data, double object_width,
+                                                  GraspCandidateBatch& grasp_candidate_batch,
+                                                  const Eigen::VectorXd* distance_scores)
+{
+  computeGraspPoseStatistics(cuboid_pose, grasp_poses_tcp);
+
+  // add all poses as possible grasps
+  std::size_t num_grasps_added =
+      addGrasps(grasp_poses_tcp, grasp_data, cuboid_pose, object_width, grasp_candidate_batch, distance_scores);
+  if (num_grasps_added < grasp_poses_tcp.size())
+    RCLCPP_DEBUG_STREAM(rclcpp::get_logger("grasp_generator.add"), "Unable to add grasp - function returned false");
+
+  RCLCPP_INFO_STREAM(rclcpp::get_logger("grasp_generator.add"), "\033[1;36madded " << num_grasps_added << " of "
+                                                                                   << grasp_poses_tcp.size()
+                                                                                   << " grasp poses created\033[0m");
+}
+
+bool TwoFingerGraspGenerator::generateCuboidAxisGraspPoses(const Eigen::Isometry3d& cuboid_pose, double depth,
+                                                           double width, double height, grasp_axis_t axis,
+                                                           const TwoFingerGraspDataPtr& grasp_data,
+                                                           const TwoFingerGraspCandidateConfig& grasp_candidate_config,
+                                                           EigenSTL::vector_Isometry3d& grasp_poses_tcp,
+                                                           double& object_width)
 {
   double finger_depth = grasp_data->grasp_max_depth_ - grasp_data->grasp_min_depth_;
   double length_along_a, length_along_b, length_along_c;
   double delta_a, delta_b, delta_f;
   double alpha_x, alpha_y, alpha_z;
-  Eigen::Vector3d object_size(depth, width, height);
-
-  double object_width;
-  EigenSTL::vector_Isometry3d grasp_poses_tcp;
 
   Eigen::Isometry3d grasp_pose_tcp = cuboid_pose;
   Eigen::Vector3d a_dir, b_dir, c_dir;
@@ -324,14 +588,15 @@ bool TwoFingerGraspGenerator::generateCuboidAxisGrasps(const Eigen::Isometry3d&
   std::size_t num_radial_grasps = ceil((M_PI / 2.0) / angle_res);
   Eigen::Vector3d translation;
 
+  if (num_radial_grasps <= 0)
+    num_radial_grasps = 1;
+
   if (grasp_candidate_config.enable_corner_grasps_)
   {
     RCLCPP_DEBUG_STREAM(rclcpp::get_logger("cuboid_axis_grasps"), "adding corner grasps...");
     corner_translation_a = 0.5 * (length_along_a + offset) * a_dir;
     corner_translation_b = 0.5 * (length_along_b + offset) * b_dir;
-
-    if (num_radial_grasps <= 0)
-      num_radial_grasps = 1;
+    grasp_poses_tcp.reserve(grasp_poses_tcp.size() + 4 * num_radial_grasps);
 
     // move to corner 0.5 * ( -a, -b)
     translation = -corner_translation_a - corner_translation_b;
@@ -398,6 +663,7 @@ bool TwoFingerGraspGenerator::generateCuboidAxisGrasps(const Eigen::Isometry3d&
   if (grasp_candidate_config.enable_face_grasps_)
   {
     RCLCPP_DEBUG_STREAM(rclcpp::get_logger("cuboid_axis_grasps"), "adding face grasps...");
+    grasp_poses_tcp.reserve(grasp_poses_tcp.size() + 4 * num_grasps_along_b);
 
     a_translation = -(0.5 * (length_along_a + offset) * a_dir) -
                     0.5 * (length_along_b - grasp_data->gripper_finger_width_) * b_dir - delta_b * b_dir;
@@ -431,47 +697,33 @@ bool TwoFingerGraspGenerator::generateCuboidAxisGrasps(const Eigen::Isometry3d&
 
   // add grasps at variable angles
   RCLCPP_DEBUG_STREAM(rclcpp::get_logger("cuboid_axis_grasps"), "adding variable angle grasps...");
-  Eigen::Isometry3d base_pose;
   std::size_t num_grasps = grasp_poses_tcp.size();
-  if (grasp_candidate_config.enable_variable_angle_grasps_)
+  if (grasp_candidate_config.enable_variable_angle_grasps_ && num_grasps > num_corner_grasps)
   {
     // corner grasps at zero depth don't need variable angles
-    for (std::size_t i = num_corner_grasps; i < num_grasps; ++i)
+    // The number of angles per pose depends on the intersection test, so they are counted first and then written
+    // into their final slots. This keeps the serial order while each pose is handled independently
+    const std::size_t num_base_grasps = num_grasps - num_corner_grasps;
+    std::vector<std::size_t> variable_angle_offsets(num_base_grasps + 1, 0);
+    const std::size_t max_iterations = M_PI / angle_res + 1;
+
+#pragma omp parallel for schedule(static) if (parallel_generation_)
+    for (std::size_t i = 0; i < num_base_grasps; ++i)
     {
-      base_pose = grasp_poses_tcp[i];
+      variable_angle_offsets[i + 1] =
+          addVariableAngleGraspsHelper(cuboid_pose, depth, width, height, grasp_poses_tcp[num_corner_grasps + i],
+                                       grasp_data, angle_res, max_iterations, nullptr);
+    }
+    std::partial_sum(variable_angle_offsets.begin(), variable_angle_offsets.end(), variable_angle_offsets.begin());
 
-      grasp_pose_tcp = base_pose * Eigen::AngleAxisd(angle_res, Eigen::Vector3d::UnitY());
-      std::size_t max_iterations = M_PI / angle_res + 1;
-      std::size_t iterations = 0;
-      while (graspIntersectionHelper(cuboid_pose, depth, width, height, grasp_pose_tcp, grasp_data))
-      {
-        grasp_poses_tcp.push_back(grasp_pose_tcp);
-        grasp_pose_tcp *= Eigen::AngleAxisd(angle_res, Eigen::Vector3d::UnitY());
-        iterations++;
-        if (iterations > max_iterations)
-        {
-          RCLCPP_WARN_STREAM(rclcpp::get_logger("cuboid_axis_grasps"),
-                             "exceeded max iterations while creating variable angle grasps");
-          break;
-        }
-      }
+    grasp_poses_tcp.resize(num_grasps + variable_angle_offsets.back());
 
-      iterations = 0;
-      grasp_pose_tcp = base_pose * Eigen::AngleAxisd(-angle_res, Eigen::Vector3d::UnitY());
-      while (graspIntersectionHelper(cuboid_pose, depth, width, height, grasp_pose_tcp, grasp_data))
-      {
-        grasp_poses_tcp.push_back(grasp_pose_tcp);
-        // visual_tools_->publishZArrow(grasp_pose_tcp, rviz_visual_tools::CYAN, rviz_visual_tools::XSMALL, 0.02);
-        grasp_pose_tcp *= Eigen::AngleAxisd(-angle_res, Eigen::Vector3d::UnitY());
-        // ros::Duration(0.2).sleep();
-        iterations++;
-        if (iterations > max_iterations)
-        {
-          RCLCPP_WARN_STREAM(rclcpp::get_logger("cuboid_axis_grasps"),
-                             "exceeded max iterations while creating variable angle grasps");
-          break;
-        }
-      }
+#pragma omp parallel for schedule(static) if (parallel_generation_)
+    for (std::size_t i = 0; i < num_base_grasps; ++i)
+    {
+      addVariableAngleGraspsHelper(cuboid_pose, depth, width, height, grasp_poses_tcp[num_corner_grasps + i],
+                                   grasp_data, angle_res, max_iterations,
+                                   &grasp_poses_tcp[num_grasps + variable_angle_offsets[i]]);
     }
   }
 
@@ -504,6 +756,8 @@ bool TwoFingerGraspGenerator::generateCuboidAxisGrasps(const Eigen::Isometry3d&
     b_translation = -0.5 * (length_along_a - grasp_data->gripper_finger_width_) * a_dir - delta_a * a_dir -
                     (0.5 * (length_along_b + offset) * b_dir) - 0.5 * (length_along_c + offset) * c_dir * b_sign;
 
+    grasp_poses_tcp.reserve(grasp_poses_tcp.size() + 4 * num_grasps_along_b);
+
     // grasps along -a_dir face
     delta = delta_b * b_dir;
     rotation = 0.0;
@@ -535,34 +789,119 @@ bool TwoFingerGraspGenerator::generateCuboidAxisGrasps(const Eigen::Isometry3d&
     num_depth_grasps = 1;
   delta_f = finger_depth / static_cast<double>(num_depth_grasps);
 
+  // The depth and bi-directional passes have an exact size, so all poses are written straight into their slots
   num_grasps = grasp_poses_tcp.size();
-  Eigen::Vector3d grasp_dir;
-  Eigen::Isometry3d depth_pose;
+  grasp_poses_tcp.resize(2 * num_grasps * (1 + num_depth_grasps));
 
+#pragma omp parallel for schedule(static) if (parallel_generation_)
   for (std::size_t i = 0; i < num_grasps; ++i)
   {
-    grasp_dir = grasp_poses_tcp[i].rotation() * Eigen::Vector3d::UnitZ();
-    depth_pose = grasp_poses_tcp[i];
+    Eigen::Vector3d grasp_dir = grasp_poses_tcp[i].rotation() * Eigen::Vector3d::UnitZ();
+    Eigen::Isometry3d depth_pose = grasp_poses_tcp[i];
     for (std::size_t j = 0; j < num_depth_grasps; ++j)
     {
       depth_pose.translation() += delta_f * grasp_dir;
-      grasp_poses_tcp.push_back(depth_pose);
+      grasp_poses_tcp[num_grasps + i * num_depth_grasps + j] = depth_pose;
     }
   }
 
   // add grasps in both directions
   RCLCPP_DEBUG_STREAM(rclcpp::get_logger("cuboid_axis_grasps"), "adding bi-directional grasps...");
-  num_grasps = grasp_poses_tcp.size();
+  num_grasps = grasp_poses_tcp.size() / 2;
+
+#pragma omp parallel for schedule(static) if (parallel_generation_)
   for (std::size_t i = 0; i < num_grasps; ++i)
+    grasp_poses_tcp[num_grasps + i] = grasp_poses_tcp[i] * Eigen::AngleAxisd(M_PI, Eigen::Vector3d::UnitZ());
+
+  return true;
+}
+
+void TwoFingerGraspGenerator::generateAxesGraspPoses(const Eigen::Isometry3d& cuboid_pose, double depth, double width,
+                                                     double height, const TwoFingerGraspDataPtr& grasp_data,
+                                                     const std::array<bool, 3>& generate_axis,
+                                                     const std::array<TwoFingerGraspCandidateConfig, 3>& axis_configs,
+                                                     std::array<EigenSTL::vector_Isometry3d, 3>& axis_grasp_poses_tcp,
+                                                     std::array<double, 3>& object_widths)
+{
+  static const std::array<grasp_axis_t, 3> AXES = { X_AXIS, Y_AXIS, Z_AXIS };
+
+  // The poses of the axes are independent of each other
+#pragma omp parallel for schedule(static) if (parallel_generation_)
+  for (std::size_t i = 0; i < AXES.size(); ++i)
   {
-    grasp_pose_tcp = grasp_poses_tcp[i];
-    grasp_pose_tcp *= Eigen::AngleAxisd(M_PI, Eigen::Vector3d::UnitZ());
-    grasp_poses_tcp.push_back(grasp_pose_tcp);
+    if (!generate_axis[i])
+      continue;
+    RCLCPP_DEBUG_STREAM(rclcpp::get_logger("grasp_generator"), "Generating grasps around axis " << i << " of cuboid");
+    generateCuboidAxisGraspPoses(cuboid_pose, depth, width, height, AXES[i], grasp_data, axis_configs[i],
+                                 axis_grasp_poses_tcp[i], object_widths[i]);
+  }
+}
+
+TwoFingerGraspTemplatePtr
+TwoFingerGraspGenerator::getGraspTemplate(double depth, double width, double height,
+                                          const TwoFingerGraspDataPtr& grasp_data,
+                                          const TwoFingerGraspCandidateConfig& grasp_candidate_config,
+                                          const std::array<bool, 3>& generate_axis,
+                                          const std::array<TwoFingerGraspCandidateConfig, 3>& axis_configs)
+{
+  if (grasp_template_size_resolution_ <= 0)
+  {
+    RCLCPP_ERROR_STREAM(rclcpp::get_logger("grasp_generator.template"),
+                        "Invalid grasp template size resolution " << grasp_template_size_resolution_);
+    return TwoFingerGraspTemplatePtr();
   }
 
+  const unsigned int config_bits = grasp_candidate_config.enable_corner_grasps_ |
+                                   grasp_candidate_config.enable_face_grasps_ << 1 |
+                                   grasp_candidate_config.enable_variable_angle_grasps_ << 2 |
+                                   grasp_candidate_config.enable_edge_grasps_ << 3 | generate_axis[0] << 4 |
+                                   generate_axis[1] << 5 | generate_axis[2] << 6;
+  const GraspTemplateKey key(grasp_data.get(), std::lround(depth / grasp_template_size_resolution_),
+                             std::lround(width / grasp_template_size_resolution_),
+                             std::lround(height / grasp_template_size_resolution_), config_bits);
+
+  auto it = grasp_templates_.find(key);
+  if (it != grasp_templates_.end() && it->second->grasp_data_.lock() == grasp_data)
+    return it->second;
+
+  // The template is generated around the origin, so the poses are in the object frame
+  TwoFingerGraspTemplatePtr grasp_template = std::make_shared<TwoFingerGraspTemplate>();
+  grasp_template->grasp_data_ = grasp_data;
+  const Eigen::Isometry3d object_origin = Eigen::Isometry3d::Identity();
+  generateAxesGraspPoses(object_origin, depth, width, height, grasp_data, generate_axis, axis_configs,
+                         grasp_template->axis_grasp_poses_tcp_, grasp_template->object_widths_);
+
+  for (std::size_t i = 0; i < generate_axis.size(); ++i)
+  {
+    if (!generate_axis[i])
+      continue;
+    computeGraspPoseStatistics(object_origin, grasp_template->axis_grasp_poses_tcp_[i]);
+    TwoFingerGraspScorer::scoreDistanceToPalm(grasp_template->axis_grasp_poses_tcp_[i], grasp_data, object_origin,
+                                              min_grasp_distance_, max_grasp_distance_,
+                                              grasp_template->distance_scores_[i]);
+  }
+
+  RCLCPP_DEBUG_STREAM(rclcpp::get_logger("grasp_generator.template"),
+                      "Created grasp template for object size " << depth << " x " << width << " x " << height);
+
+  // Drop the templates of grasp data that no longer exists, e.g. the per level copies of the adaptive generation,
+  // so that the cache does not grow in long running processes
+  for (auto template_it = grasp_templates_.begin(); template_it != grasp_templates_.end();)
+  {
+    if (template_it->second->grasp_data_.expired())
+      template_it = grasp_templates_.erase(template_it);
+    else
+      ++template_it;
+  }
+  grasp_templates_[key] = grasp_template;
+  return grasp_template;
+}
+
+void TwoFingerGraspGenerator::computeGraspPoseStatistics(const Eigen::Isometry3d& cuboid_pose,
+                                                         const EigenSTL::vector_Isometry3d& grasp_poses_tcp)
+{
   // compute min/max distances to object
   RCLCPP_DEBUG_STREAM(rclcpp::get_logger("cuboid_axis_grasps"), "computing min/max grasp distance...");
-  num_grasps = grasp_poses_tcp.size();
   min_grasp_distance_ = std::numeric_limits<double>::max();
   max_grasp_distance_ = std::numeric_limits<double>::min();
   min_translations_ = Eigen::Vector3d(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
@@ -571,9 +910,8 @@ bool TwoFingerGraspGenerator::generateCuboidAxisGrasps(const Eigen::Isometry3d&
                                       std::numeric_limits<double>::min());
   double grasp_distance;
 
-  for (std::size_t i = 0; i < num_grasps; ++i)
+  for (const Eigen::Isometry3d& grasp_pose_tcp : grasp_poses_tcp)
   {
-    grasp_pose_tcp = grasp_poses_tcp[i];
     grasp_distance = (grasp_pose_tcp.translation() - cuboid_pose.translation()).norm();
     if (grasp_distance > max_grasp_distance_)
       max_grasp_distance_ = grasp_distance;
@@ -593,24 +931,6 @@ bool TwoFingerGraspGenerator::generateCuboidAxisGrasps(const Eigen::Isometry3d&
 
   RCLCPP_DEBUG_STREAM(rclcpp::get_logger("grasp_generator.add"),
                       "min/max distance = " << min_grasp_distance_ << ", " << max_grasp_distance_);
-
-  // add all poses as possible grasps
-  std::size_t num_grasps_added = 0;
-
-  for (std::size_t i = 0; i < grasp_poses_tcp.size(); ++i)
-  {
-    Eigen::Isometry3d grasp_pose_eef_mount = grasp_poses_tcp[i] * grasp_data->tcp_to_eef_mount_;
-    if (!addGrasp(grasp_pose_eef_mount, grasp_data, cuboid_pose, object_size, object_width, grasp_candidates))
-    {
-      RCLCPP_DEBUG_STREAM(rclcpp::get_logger("grasp_generator.add"), "Unable to add grasp - function returned false");
-    }
-    else
-      num_grasps_added++;
-  }
-  RCLCPP_INFO_STREAM(rclcpp::get_logger("grasp_generator.add"), "\033[1;36madded " << num_grasps_added << " of "
-                                                                                   << grasp_poses_tcp.size()
-                                                                                   << " grasp poses created\033[0m");
-  return true;
 }
 
 std::size_t TwoFingerGraspGenerator::addCornerGraspsHelper(const Eigen::Isometry3d& pose, double rotation_angles[3],
@@ -707,6 +1027,38 @@ std::size_t TwoFingerGraspGenerator::addEdgeGraspsHelper(const Eigen::Isometry3d
   return true;
 }
 
+std::size_t TwoFingerGraspGenerator::addVariableAngleGraspsHelper(const Eigen::Isometry3d& cuboid_pose, double depth,
+                                                                  double width, double height,
+                                                                  const Eigen::Isometry3d& base_pose,
+                                                                  const TwoFingerGraspDataPtr& grasp_data,
+                                                                  double angle_res, std::size_t max_iterations,
+                                                                  Eigen::Isometry3d* grasp_poses_tcp)
+{
+  std::size_t num_grasps_added = 0;
+  for (double direction : { 1.0, -1.0 })
+  {
+    Eigen::Isometry3d grasp_pose_tcp = base_pose * Eigen::AngleAxisd(direction * angle_res, Eigen::Vector3d::UnitY());
+    std::size_t iterations = 0;
+    while (graspIntersectionHelper(cuboid_pose, depth, width, height, grasp_pose_tcp, grasp_data))
+    {
+      if (grasp_poses_tcp)
+        grasp_poses_tcp[num_grasps_added] = grasp_pose_tcp;
+      num_grasps_added++;
+      grasp_pose_tcp *= Eigen::AngleAxisd(direction * angle_res, Eigen::Vector3d::UnitY());
+      iterations++;
+      if (iterations > max_iterations)
+      {
+        // Only warn once, on the pass that writes the poses
+        if (grasp_poses_tcp)
+          RCLCPP_WARN_STREAM(rclcpp::get_logger("cuboid_axis_grasps"),
+                             "exceeded max iterations while creating variable angle grasps");
+        break;
+      }
+    }
+  }
+  return num_grasps_added;
+}
+
 bool TwoFingerGraspGenerator::graspIntersectionHelper(const Eigen::Isometry3d& cuboid_pose, double depth, double width,
                                                       double height, const Eigen::Isometry3d& grasp_pose_tcp,
                                                       const TwoFingerGraspDataPtr& grasp_data)
@@ -832,65 +1184,141 @@ double TwoFingerGraspGenerator::scoreFingerGrasp(const Eigen::Isometry3d& grasp_
   return total_score;
 }
 
+void TwoFingerGraspGenerator::scoreFingerGrasps(const EigenSTL::vector_Isometry3d& grasp_poses_tcp,
+                                                const TwoFingerGraspDataPtr& grasp_data,
+                                                const Eigen::Isometry3d& object_pose,
+                                                const std::vector<double>& percent_opens,
+                                                std::vector<Eigen::VectorXd>& scores,
+                                                const Eigen::VectorXd* distance_scores)
+{
+  // Everything but the width score is independent of the finger opening, so it is computed once for all poses
+  Eigen::Matrix3Xd orientation_scores;
+  TwoFingerGraspScorer::scoreRotationsFromDesired(grasp_poses_tcp, ideal_grasp_pose_, orientation_scores);
+
+  Eigen::Matrix3Xd translation_scores;
+  TwoFingerGraspScorer::scoreGraspTranslation(grasp_poses_tcp, min_translations_, max_translations_,
+                                              translation_scores);
+  // want minimum translation
+  translation_scores = 1.0 - translation_scores.array();
+
+  Eigen::VectorXd computed_distance_scores;
+  if (!distance_scores)
+  {
+    TwoFingerGraspScorer::scoreDistanceToPalm(grasp_poses_tcp, grasp_data, object_pose, min_grasp_distance_,
+                                              max_grasp_distance_, computed_distance_scores);
+    distance_scores = &computed_distance_scores;
+  }
+
+  auto two_finger_grasp_score_weights = std::dynamic_pointer_cast<TwoFingerGraspScoreWeights>(grasp_score_weights_);
+  if (!two_finger_grasp_score_weights)
+  {
+    RCLCPP_WARN(rclcpp::get_logger("grasp_generator.scoreGrasp"),
+                "Failed to cast grasp_score_weights_ as TwoFingerGraspScoreWeights. continuing without "
+                "finger specific scores");
+  }
+
+  scores.resize(percent_opens.size());
+  for (std::size_t j = 0; j < percent_opens.size(); ++j)
+  {
+    if (two_finger_grasp_score_weights)
+    {
+      const Eigen::VectorXd width_scores = Eigen::VectorXd::Constant(
+          grasp_poses_tcp.size(), TwoFingerGraspScorer::scoreGraspWidth(grasp_data, percent_opens[j]));
+      two_finger_grasp_score_weights->computeScores(orientation_scores, translation_scores, *distance_scores,
+                                                    width_scores, scores[j]);
+    }
+    else
+      grasp_score_weights_->computeScores(orientation_scores, translation_scores, scores[j]);
+  }
+}
+
 bool TwoFingerGraspGenerator::generateFingerGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width,
                                                    double height, const TwoFingerGraspDataPtr& grasp_data,
                                                    std::vector<GraspCandidatePtr>& grasp_candidates,
                                                    const TwoFingerGraspCandidateConfig& grasp_candidate_config)
+{
+  GraspCandidateBatch grasp_candidate_batch(grasp_data, cuboid_pose);
+  if (!generateFingerGrasps(cuboid_pose, depth, width, height, grasp_data, grasp_candidate_batch,
+                            grasp_candidate_config))
+    return false;
+
+  grasp_candidate_batch.getGraspCandidates(grasp_candidates, node_->get_clock()->now());
+  return true;
+}
+
+bool TwoFingerGraspGenerator::generateFingerGrasps(const Eigen::Isometry3d& cuboid_pose, double depth, double width,
+                                                   double height, const TwoFingerGraspDataPtr& grasp_data,
+                                                   GraspCandidateBatch& grasp_candidate_batch,
+                                                   const TwoFingerGraspCandidateConfig& grasp_candidate_config)
 {
   // Generate grasps over axes that aren't too wide to grip
   // Most default type of grasp is X axis
-  TwoFingerGraspCandidateConfig grasp_candidate_config_copy(grasp_candidate_config);
-  if (grasp_candidate_config_copy.generate_x_axis_grasps_)
+  static const std::array<grasp_axis_t, 3> AXES = { X_AXIS, Y_AXIS, Z_AXIS };
+  const std::array<bool, 3> generate_axis = { grasp_candidate_config.generate_x_axis_grasps_,
+                                              grasp_candidate_config.generate_y_axis_grasps_,
+                                              grasp_candidate_config.generate_z_axis_grasps_ };
+  const Eigen::Vector3d object_size(depth, width, height);  // size along x, y and z axis
+
+  std::array<TwoFingerGraspCandidateConfig, 3> axis_configs;
+  for (std::size_t i = 0; i < AXES.size(); ++i)
   {
-    RCLCPP_DEBUG_STREAM(rclcpp::get_logger("grasp_generator"), "Generating grasps around x-axis of cuboid");
-    if (depth > grasp_data->max_grasp_width_)  // depth = size along x-axis
+    axis_configs[i] = grasp_candidate_config;
+    if (object_size[i] > grasp_data->max_grasp_width_)
     {
-      grasp_candidate_config_copy.disableAllGraspTypes();
-      grasp_candidate_config_copy.enable_edge_grasps_ = grasp_candidate_config.enable_edge_grasps_;
-      grasp_candidate_config_copy.enable_corner_grasps_ = grasp_candidate_config.enable_corner_grasps_;
+      axis_configs[i].disableAllGraspTypes();
+      axis_configs[i].enable_edge_grasps_ = grasp_candidate_config.enable_edge_grasps_;
+      axis_configs[i].enable_corner_grasps_ = grasp_candidate_config.enable_corner_grasps_;
     }
-    generateCuboidAxisGrasps(cuboid_pose, depth, width, height, X_AXIS, grasp_data, grasp_candidate_config_copy,
-                             grasp_candidates);
   }
 
-  grasp_candidate_config_copy = grasp_candidate_config;
-  if (grasp_candidate_config_copy.generate_y_axis_grasps_)
+  std::array<EigenSTL::vector_Isometry3d, 3> axis_grasp_poses_tcp;
+  std::array<double, 3> object_widths;
+  TwoFingerGraspTemplatePtr grasp_template;
+  if (use_grasp_templates_)
+    grasp_template =
+        getGraspTemplate(depth, width, height, grasp_data, grasp_candidate_config, generate_axis, axis_configs);
+
+  if (grasp_template)
   {
-    RCLCPP_DEBUG_STREAM(rclcpp::get_logger("grasp_generator"), "Generating grasps around y-axis of cuboid");
-    if (width > grasp_data->max_grasp_width_)  // width = size along y-axis
+    // Only the rigid transform of the cuboid is applied to the cached object frame poses
+    for (std::size_t i = 0; i < AXES.size(); ++i)
     {
-      grasp_candidate_config_copy.disableAllGraspTypes();
-      grasp_candidate_config_copy.enable_edge_grasps_ = grasp_candidate_config.enable_edge_grasps_;
-      grasp_candidate_config_copy.enable_corner_grasps_ = grasp_candidate_config.enable_corner_grasps_;
+      const EigenSTL::vector_Isometry3d& template_poses = grasp_template->axis_grasp_poses_tcp_[i];
+      axis_grasp_poses_tcp[i].resize(template_poses.size());
+      object_widths[i] = grasp_template->object_widths_[i];
+
+#pragma omp parallel for schedule(static) if (parallel_generation_)
+      for (std::size_t j = 0; j < template_poses.size(); ++j)
+        axis_grasp_poses_tcp[i][j] = cuboid_pose * template_poses[j];
     }
-    generateCuboidAxisGrasps(cuboid_pose, depth, width, height, Y_AXIS, grasp_data, grasp_candidate_config_copy,
-                             grasp_candidates);
   }
+  else
+    generateAxesGraspPoses(cuboid_pose, depth, width, height, grasp_data, generate_axis, axis_configs,
+                           axis_grasp_poses_tcp, object_widths);
 
-  grasp_candidate_config_copy = grasp_candidate_config;
-  if (grasp_candidate_config_copy.generate_z_axis_grasps_)
+  // Scoring depends on the per axis statistics, so the axes are added in order
+  for (std::size_t i = 0; i < AXES.size(); ++i)
   {
-    RCLCPP_DEBUG_STREAM(rclcpp::get_logger("grasp_generator"), "Generating grasps around z-axis of cuboid");
-    if (height > grasp_data->max_grasp_width_)  // height = size along z-axis
+    if (generate_axis[i])
     {
-      grasp_candidate_config_copy.disableAllGraspTypes();
-      grasp_candidate_config_copy.enable_edge_grasps_ = grasp_candidate_config.enable_edge_grasps_;
-      grasp_candidate_config_copy.enable_corner_grasps_ = grasp_candidate_config.enable_corner_grasps_;
+      addCuboidAxisGrasps(cuboid_pose, axis_grasp_poses_tcp[i], grasp_data, object_widths[i], grasp_candidate_batch,
+                          grasp_template ? &grasp_template->distance_scores_[i] : nullptr);
     }
-    generateCuboidAxisGrasps(cuboid_pose, depth, width, height, Z_AXIS, grasp_data, grasp_candidate_config_copy,
-                             grasp_candidates);
   }
 
-  if (!grasp_candidates.size())
+  if (grasp_candidate_batch.empty())
     RCLCPP_WARN_STREAM(rclcpp::get_logger("grasp_generator"), "Generated 0 grasps");
   else
-    RCLCPP_INFO_STREAM(rclcpp::get_logger("grasp_generator"), "Generated " << grasp_candidates.size() << " grasps");
+    RCLCPP_INFO_STREAM(rclcpp::get_logger("grasp_generator"),
+                       "Generated " << grasp_candidate_batch.size() << " grasps");
 
   // Visualize animated grasps that have been generated
   if (show_prefiltered_grasps_)
   {
     RCLCPP_DEBUG_STREAM(rclcpp::get_logger("grasp_generator"),
                         "Animating all generated (candidate) grasps before filtering");
+    std::vector<GraspCandidatePtr> grasp_candidates;
+    grasp_candidate_batch.getGraspCandidates(grasp_candidates, node_->get_clock()->now());
     visualizeAnimatedGrasps(grasp_candidates, grasp_data->ee_jmg_, show_prefiltered_grasps_speed_);
   }
 
@@ -72,6 +72,17 @@ double TwoFingerGraspScoreWeights::computeScore(const Eigen::Vector3d& orientati
   return total_score;
 }
 
+void TwoFingerGraspScoreWeights::computeScores(const Eigen::Matrix3Xd& orientation_scores,
+                                               const Eigen::Matrix3Xd& translation_scores,
+                                               const Eigen::VectorXd& depth_scores,
+                                               const Eigen::VectorXd& width_scores, Eigen::VectorXd& scores) const
+{
+  GraspScoreWeights::computeScores(orientation_scores, translation_scores, scores);
+  scores = (scores * GraspScoreWeights::getWeightTotal() + depth_scores * depth_score_weight_ +
+            width_scores * width_score_weight_) /
+           getWeightTotal();
+}
+
 double TwoFingerGraspScoreWeights::getWeightTotal() const
 {
   return GraspScoreWeights::getWeightTotal() + depth_score_weight_ + width_score_weight_;
@@ -100,4 +111,20 @@ double TwoFingerGraspScorer::scoreDistanceToPalm(const Eigen::Isometry3d& grasp_
   return pow(score, 4);
 }
 
+void TwoFingerGraspScorer::scoreDistanceToPalm(const EigenSTL::vector_Isometry3d& grasp_poses_tcp,
+                                               const TwoFingerGraspDataPtr& /*grasp_data*/,
+                                               const Eigen::Isometry3d& object_pose, double min_grasp_distance,
+                                               double max_grasp_distance, Eigen::VectorXd& scores)
+{
+  scores.resize(grasp_poses_tcp.size());
+  for (std::size_t i = 0; i < grasp_poses_tcp.size(); ++i)
+    scores[i] = (grasp_poses_tcp[i].translation() - object_pose.translation()).norm();
+
+  scores = 1.0 - (scores.array() - min_grasp_distance) / (max_grasp_distance - min_grasp_distance);
+
+  if ((scores.array() < 0).any())
+    RCLCPP_WARN_STREAM(rclcpp::get_logger("grasp_scorer.distance"), "score < 0!");
+  scores = scores.array().square().square();
+}
+
 }  // namespace moveit_grasps
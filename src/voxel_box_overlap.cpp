@@ -0,0 +1,186 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Area of the overlap of rotated suction voxels with an axis aligned box
+*/
+
+#include <moveit_grasps/voxel_box_overlap.h>
+
+// C++
+#include <algorithm>
+#include <cmath>
+
+namespace moveit_grasps
+{
+namespace
+{
+// is a within epsilon of b
+bool isApprox(double a, double b, double epsilon = 1.0e-5)
+{
+  return std::abs(a - b) < epsilon;
+}
+
+// Clip a convex polygon to the half plane sign * (p[axis] - bound) <= 0, returns the number of output vertices
+std::size_t clipPolygon(const Eigen::Vector2d* input, std::size_t num_input, std::size_t axis, double bound,
+                        double sign, Eigen::Vector2d* output)
+{
+  std::size_t num_output = 0;
+  for (std::size_t i = 0; i < num_input; ++i)
+  {
+    const Eigen::Vector2d& a = input[i];
+    const Eigen::Vector2d& b = input[(i + 1) % num_input];
+    double distance_a = sign * (a[axis] - bound);
+    double distance_b = sign * (b[axis] - bound);
+    if (distance_a <= 0)
+      output[num_output++] = a;
+    if ((distance_a < 0 && distance_b > 0) || (distance_a > 0 && distance_b < 0))
+      output[num_output++] = a + (b - a) * (distance_a / (distance_a - distance_b));
+  }
+  return num_output;
+}
+
+// Area of a simple polygon using the shoelace formula
+double polygonArea(const Eigen::Vector2d* polygon, std::size_t num_vertices)
+{
+  double twice_area = 0;
+  for (std::size_t i = 0; i < num_vertices; ++i)
+  {
+    const Eigen::Vector2d& a = polygon[i];
+    const Eigen::Vector2d& b = polygon[(i + 1) % num_vertices];
+    twice_area += a.x() * b.y() - b.x() * a.y();
+  }
+  return std::abs(twice_area) / 2.0;
+}
+}  // namespace
+
+double computeVoxelBoxOverlap(const Eigen::Matrix<double, 2, 4>& corners, const Eigen::Vector2d& box_min,
+                              const Eigen::Vector2d& box_max)
+{
+  // Each clip against a box edge adds at most one vertex to the convex polygon, so 4 corners grow to at most 8
+  Eigen::Vector2d polygon_a[8];
+  Eigen::Vector2d polygon_b[8];
+  for (std::size_t i = 0; i < 4; ++i)
+    polygon_a[i] = corners.col(i);
+  std::size_t num_vertices = 4;
+
+  num_vertices = clipPolygon(polygon_a, num_vertices, 0, box_min.x(), -1.0, polygon_b);
+  num_vertices = clipPolygon(polygon_b, num_vertices, 0, box_max.x(), 1.0, polygon_a);
+  num_vertices = clipPolygon(polygon_a, num_vertices, 1, box_min.y(), -1.0, polygon_b);
+  num_vertices = clipPolygon(polygon_b, num_vertices, 1, box_max.y(), 1.0, polygon_a);
+  if (num_vertices < 3)
+    return 0;
+  return polygonArea(polygon_a, num_vertices);
+}
+
+void computeVoxelBoxOverlaps(const Eigen::Matrix2Xd& corners, const Eigen::Vector2d& box_min,
+                             const Eigen::Vector2d& box_max, double voxel_area, std::vector<double>& overlaps)
+{
+  const std::size_t num_voxels = corners.cols() / 4;
+  overlaps.resize(num_voxels);
+  for (std::size_t voxel_id = 0; voxel_id < num_voxels; ++voxel_id)
+  {
+    const Eigen::Matrix<double, 2, 4> voxel_corners = corners.middleCols<4>(4 * voxel_id);
+    const Eigen::Vector2d voxel_min = voxel_corners.rowwise().minCoeff();
+    const Eigen::Vector2d voxel_max = voxel_corners.rowwise().maxCoeff();
+    // Voxels that are entirely outside or inside the box don't need to be clipped
+    if ((voxel_max.array() <= box_min.array()).any() || (voxel_min.array() >= box_max.array()).any())
+    {
+      overlaps[voxel_id] = 0.0;
+    }
+    else if ((voxel_min.array() >= box_min.array()).all() && (voxel_max.array() <= box_max.array()).all())
+    {
+      Eigen::Vector2d polygon[4];
+      for (std::size_t i = 0; i < 4; ++i)
+        polygon[i] = voxel_corners.col(i);
+      overlaps[voxel_id] = polygonArea(polygon, 4) / voxel_area;
+    }
+    else
+    {
+      overlaps[voxel_id] = computeVoxelBoxOverlap(voxel_corners, box_min, box_max) / voxel_area;
+    }
+  }
+}
+
+double computeVoxelBoxOverlapSliced(const Eigen::Matrix<double, 2, 4>& corners, const Eigen::Vector2d& box_min,
+                                    const Eigen::Vector2d& box_max, std::size_t slices)
+{
+  std::vector<double> slope(4);
+  std::vector<double> intercept(4);
+  for (std::size_t i = 0; i < 4; ++i)
+  {
+    const Eigen::Vector2d& a = corners.col(i);
+    const Eigen::Vector2d& b = corners.col((i + 1) % 4);
+    slope[i] = (a.y() - b.y()) / (a.x() - b.x());
+    intercept[i] = a.y() - slope[i] * a.x();
+  }
+
+  double max_y = corners.row(1).maxCoeff();
+  double min_y = corners.row(1).minCoeff();
+  double y_inc = (max_y - min_y) / slices;
+  double total_overlap = 0;
+  for (std::size_t slice_ix = 0; slice_ix < slices; ++slice_ix)
+  {
+    double y = min_y + y_inc * slice_ix;
+    std::vector<double> x_intercept(4);
+    // If the voxel is axis aligned with the bounding box, the slope intercept approach won't be valid
+    if (isApprox(corners(0, 0), corners(0, 1)) || isApprox(corners(0, 1), corners(0, 2)))
+    {
+      x_intercept[1] = std::min(corners(0, 0), corners(0, 2));
+      x_intercept[2] = std::max(corners(0, 0), corners(0, 2));
+    }
+    else
+    {
+      // We compute the x intercepts for each line of the box and take the middle two.
+      for (std::size_t quadrant_ix = 0; quadrant_ix < 4; ++quadrant_ix)
+        x_intercept[quadrant_ix] = (y - intercept[quadrant_ix]) / slope[quadrant_ix];
+      std::sort(x_intercept.begin(), x_intercept.end());
+    }
+
+    Eigen::Vector2d voxel_slice_bb_min(x_intercept[1], y);
+    Eigen::Vector2d voxel_slice_bb_max(x_intercept[2], y + y_inc);
+
+    if (voxel_slice_bb_max.x() > box_min.x() && voxel_slice_bb_min.x() < box_max.x() &&
+        voxel_slice_bb_max.y() > box_min.y() && voxel_slice_bb_min.y() < box_max.y() &&
+        !isApprox(voxel_slice_bb_max.x(), voxel_slice_bb_min.x()))
+    {
+      double y_overlap = std::min(box_max.y(), y + y_inc) - std::max(box_min.y(), y);
+      double x_overlap =
+          std::min(voxel_slice_bb_max.x(), box_max.x()) - std::max(voxel_slice_bb_min.x(), box_min.x());
+      total_overlap += x_overlap * y_overlap;
+    }
+  }
+  return total_overlap;
+}
+
+}  // namespace moveit_grasps
@@ -0,0 +1,118 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Unit tests of the suction voxel overlap kernels, they only depend on Eigen so they run without ROS
+*/
+
+// C++
+#include <cmath>
+#include <vector>
+
+// Testing
+#include <gtest/gtest.h>
+
+// Eigen
+#include <Eigen/Geometry>
+
+// MoveIt Grasps
+#include <moveit_grasps/voxel_box_overlap.h>
+
+namespace
+{
+// The corners of a rectangle centered at (x, y) and rotated by yaw, in the winding order used by the voxel scorer
+Eigen::Matrix<double, 2, 4> getRectangleCorners(double x, double y, double x_width, double y_width, double yaw)
+{
+  Eigen::Rotation2Dd rotation(yaw);
+  Eigen::Vector2d center(x, y);
+  Eigen::Matrix<double, 2, 4> corners;
+  corners.col(0) = center + rotation * Eigen::Vector2d(-x_width / 2.0, -y_width / 2.0);
+  corners.col(1) = center + rotation * Eigen::Vector2d(-x_width / 2.0, y_width / 2.0);
+  corners.col(2) = center + rotation * Eigen::Vector2d(x_width / 2.0, y_width / 2.0);
+  corners.col(3) = center + rotation * Eigen::Vector2d(x_width / 2.0, -y_width / 2.0);
+  return corners;
+}
+}  // namespace
+
+namespace moveit_grasps
+{
+// Compare the exact voxel overlap against the sliced estimate for axis aligned and rotated voxels
+TEST(VoxelBoxOverlapTests, TestVoxelBoxOverlap)
+{
+  const Eigen::Vector2d box_min(-0.05, -0.03);
+  const Eigen::Vector2d box_max(0.05, 0.03);
+  const double voxel_width = 0.02;
+  const double voxel_area = voxel_width * voxel_width;
+
+  // Fully inside, fully outside and half overlapping the box
+  EXPECT_NEAR(computeVoxelBoxOverlap(getRectangleCorners(0.0, 0.0, voxel_width, voxel_width, 0.0), box_min, box_max),
+              voxel_area, 1e-12);
+  EXPECT_NEAR(computeVoxelBoxOverlap(getRectangleCorners(0.1, 0.0, voxel_width, voxel_width, 0.3), box_min, box_max),
+              0.0, 1e-12);
+  EXPECT_NEAR(computeVoxelBoxOverlap(getRectangleCorners(box_max.x(), 0.0, voxel_width, voxel_width, M_PI / 4.0),
+                                     box_min, box_max),
+              voxel_area / 2.0, 1e-12);
+
+  Eigen::Matrix2Xd batch_corners(2, 4 * 21 * 21);
+  std::size_t voxel_id = 0;
+  for (std::size_t x_ix = 0; x_ix < 21; ++x_ix)
+  {
+    for (std::size_t y_ix = 0; y_ix < 21; ++y_ix)
+    {
+      const double x = -0.07 + 0.007 * x_ix;
+      const double y = -0.05 + 0.005 * y_ix;
+      const double yaw = 10.0 * x + 20.0 * y;
+      Eigen::Matrix<double, 2, 4> corners = getRectangleCorners(x, y, voxel_width, voxel_width, yaw);
+      double exact = computeVoxelBoxOverlap(corners, box_min, box_max);
+      // The sliced estimate converges on the exact overlap as the number of slices grows
+      EXPECT_NEAR(exact, computeVoxelBoxOverlapSliced(corners, box_min, box_max, 2000), 0.01 * voxel_area)
+          << "x: " << x << " y: " << y << " yaw: " << yaw;
+      // The default ten slices are within a tenth of a voxel
+      EXPECT_NEAR(exact, computeVoxelBoxOverlapSliced(corners, box_min, box_max), 0.1 * voxel_area)
+          << "x: " << x << " y: " << y << " yaw: " << yaw;
+      batch_corners.middleCols<4>(4 * voxel_id++) = corners;
+    }
+  }
+  ASSERT_EQ(voxel_id, 21u * 21u);
+
+  std::vector<double> overlaps;
+  computeVoxelBoxOverlaps(batch_corners, box_min, box_max, voxel_area, overlaps);
+  ASSERT_EQ(overlaps.size(), voxel_id);
+  for (std::size_t i = 0; i < voxel_id; ++i)
+  {
+    Eigen::Matrix<double, 2, 4> corners = batch_corners.middleCols<4>(4 * i);
+    EXPECT_NEAR(overlaps[i], computeVoxelBoxOverlap(corners, box_min, box_max) / voxel_area, 1e-12);
+  }
+}
+
+}  // namespace moveit_grasps